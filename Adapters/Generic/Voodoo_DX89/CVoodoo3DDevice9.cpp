@@ -177,9 +177,15 @@ namespace VoodooShader
             CONST RGNDATA * pDirtyRegion
         )
         {
+            if (gpVoodooCore)
+            {
+                gpVoodooCore->Update();
+            }
+
             if (gpVoodooCore && testEffect)
             {
-                LoggerRef logger = gpVoodooCore->GetLogger();
+                // The core, effect and technique hold these for the whole frame, so no references are taken per frame
+                ILogger * logger = gpVoodooCore->GetLogger();
 
                 HRESULT hr = m_RealDevice->StretchRect(m_BackBuffer, nullptr, surface_Frame0, nullptr, D3DTEXF_NONE);
                 if (FAILED(hr))
@@ -193,13 +199,13 @@ namespace VoodooShader
                     logger->LogMessage(VSLog_PlugError, VOODOO_DX89_NAME, "Failed to unbind depth surface.");
                 }
 
-                VoodooShader::TechniqueRef tech = testEffect->Bind();
+                VoodooShader::ITechnique * tech = testEffect->Bind();
                 if (tech)
                 {
                     uint32_t passCount = tech->GetPassCount();
                     for (uint32_t i = 0; i < passCount; ++i)
                     {
-                        VoodooShader::PassRef pass = tech->GetPass(i);
+                        VoodooShader::IPass * pass = tech->GetPass(i);
                         if (pass)
                         {
                             hr = m_RealDevice->StretchRect(m_BackBuffer, nullptr, surface_Pass0, nullptr, D3DTEXF_NONE);
@@ -1000,7 +1006,7 @@ namespace VoodooShader
                 logger->LogMessage(VSLog_PlugError, VOODOO_DX89_NAME, L"Failed to retrieve backbuffer surface.");
             }
 
-            texture_Frame0 = gpVoodooCore->CreateTexture(L"frame0", bufferTextureDesc);
+            texture_Frame0 = gpVoodooCore->CreateTexture(L"frame0", bufferTextureDesc, nullptr);
             if (texture_Frame0)
             {
                 Variant texvar = CreateVariant();
@@ -1015,7 +1021,7 @@ namespace VoodooShader
                 }
             }
 
-            texture_Pass0 = gpVoodooCore->CreateTexture(L"pass0", bufferTextureDesc);
+            texture_Pass0 = gpVoodooCore->CreateTexture(L"pass0", bufferTextureDesc, nullptr);
             if (texture_Pass0)
             {
                 Variant texvar = CreateVariant();
@@ -1034,7 +1040,7 @@ namespace VoodooShader
             CopyMemory(&depthTextureDesc, &bufferTextureDesc, sizeof(TextureDesc));
             depthTextureDesc.Format = VSFmt_D24;
 
-            texture_Depth = gpVoodooCore->CreateTexture(L"depth", depthTextureDesc);
+            texture_Depth = gpVoodooCore->CreateTexture(L"depth", depthTextureDesc, nullptr);
             if (texture_Depth)
             {
                 Variant texvar = CreateVariant();
@@ -1060,8 +1066,14 @@ namespace VoodooShader
                 viewport.Width, viewport.Height, D3DFMT_X8R8G8B8, D3DMULTISAMPLE_NONE, 0, FALSE, &target_Color, NULL
             );
 
-            ParameterDesc rcpres_desc = {VSPT_Float, 1, 2, 0};
-            IParameter * lpparam_rcpres = gpVoodooCore->CreateParameter(L"rcpres", rcpres_desc);
+            // The reciprocal is derived by the core each frame, config may override it
+            ParameterDesc resolution_desc = {VSPT_Float, 1, 2, 0};
+            IParameter * lpparam_resolution = gpVoodooCore->CreateParameter(L"resolution", resolution_desc, nullptr);
+            IParameter * lpparam_rcpres = gpVoodooCore->CreateParameter(L"rcpres", resolution_desc, nullptr);
+            if (lpparam_rcpres)
+            {
+                gpVoodooCore->SetExpression(lpparam_rcpres, L"1 / resolution.x, 1 / resolution.y");
+            }
 
             try
             {
@@ -1076,10 +1088,10 @@ namespace VoodooShader
                 logger->LogMessage(VSLog_PlugError, VOODOO_DX89_NAME, StringFormat("Error loading shader: %1%") << exc.what());
             }
 
-            if (lpparam_rcpres)
+            if (lpparam_resolution)
             {
-                Float4 rcpres_val = {1.0f / viewport.Width, 1.0f / viewport.Height, 0, 0};
-                lpparam_rcpres->SetVector(rcpres_val);
+                Float4 resolution_val = {(float)viewport.Width, (float)viewport.Height, 0, 0};
+                lpparam_resolution->SetVector(resolution_val);
             }
 
             return D3D_OK;
@@ -28,6 +28,8 @@ namespace VoodooShader
 {
     namespace VoodooDX8
     {
+        VOODOO_DEFINE_POOLED(CVoodoo3DSurface8, 64);
+
         CVoodoo3DSurface8::CVoodoo3DSurface8(CVoodoo3DDevice8 * pDevice, IDirect3DSurface9 * pRealSurface) :
             m_Refs(0), m_Device(pDevice), m_RealSurface(pRealSurface)
         {
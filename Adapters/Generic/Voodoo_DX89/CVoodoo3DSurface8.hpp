@@ -54,6 +54,8 @@ namespace VoodooShader
             UINT m_Refs;
             CVoodoo3DDevice8 * m_Device;
             IDirect3DSurface9 * m_RealSurface;
+
+            VOODOO_DECLARE_POOLED();
         };
     }
 }
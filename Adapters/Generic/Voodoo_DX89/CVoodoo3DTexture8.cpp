@@ -32,6 +32,8 @@ namespace VoodooShader
 {
     namespace VoodooDX8
     {
+        VOODOO_DEFINE_POOLED(CVoodoo3DTexture8, 64);
+
         CVoodoo3DTexture8::CVoodoo3DTexture8(CVoodoo3DDevice8 * pDevice, IDirect3DTexture9 * pTexture) :
             m_Refs(0), m_Device(pDevice), m_RealTexture(pTexture)
         {
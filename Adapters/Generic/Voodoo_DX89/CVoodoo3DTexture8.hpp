@@ -64,6 +64,8 @@ namespace VoodooShader
             UINT m_Refs;
             CVoodoo3DDevice8 * m_Device;
             IDirect3DTexture9 * m_RealTexture;
+
+            VOODOO_DECLARE_POOLED();
         };
     }
 }
@@ -0,0 +1,199 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+// Only standard headers and no framework macros, so the packing logic can be exercised without D3D or a device
+#pragma warning(push,3)
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#pragma warning(pop)
+
+namespace VoodooShader
+{
+    namespace Voodoo_D3D9
+    {
+        /**
+         * Shadow copy of the float4 constant registers a shader stage reads.
+         *
+         * Every register the stage maps is added at link time with the value the effect itself will write when a pass
+         * begins (the baseline). Registers of parameters the effect still uploads are kept in step with Restore(), while
+         * packed parameters only Write() the shadow copy. Flush() then uploads the span of registers that differ from the
+         * baseline in a single call.
+         *
+         * Registers inside the span that were never added are not read by the stage's shader, so they are padded with
+         * zeros rather than splitting the upload.
+         */
+        class ConstantBlock
+        {
+        public:
+            ConstantBlock() :
+                m_Start(0), m_First(0), m_Last(0), m_Changed(false), m_SpanValid(true)
+            { }
+
+            /**
+             * Adds a run of registers to the block.
+             *
+             * @param reg The first register index.
+             * @param count The number of registers.
+             * @param pBaseline The four components of each register, as the effect writes them when a pass begins.
+             */
+            void Add(const uint32_t reg, const uint32_t count, const float * pBaseline)
+            {
+                if (count == 0) return;
+
+                if (m_Owned.empty())
+                {
+                    m_Start = reg;
+                }
+                else if (reg < m_Start)
+                {
+                    uint32_t grow = m_Start - reg;
+                    m_Owned.insert(m_Owned.begin(), grow, false);
+                    m_Shadow.insert(m_Shadow.begin(), grow * 4, 0.0f);
+                    m_Baseline.insert(m_Baseline.begin(), grow * 4, 0.0f);
+                    m_Start = reg;
+                }
+
+                uint32_t index = reg - m_Start;
+                if (index + count > m_Owned.size())
+                {
+                    m_Owned.resize(index + count, false);
+                    m_Shadow.resize((index + count) * 4, 0.0f);
+                    m_Baseline.resize((index + count) * 4, 0.0f);
+                }
+
+                for (uint32_t offset = 0; offset < count; ++offset)
+                {
+                    m_Owned[index + offset] = true;
+                }
+                memcpy(&m_Shadow[index * 4], pBaseline, sizeof(float) * 4 * count);
+                memcpy(&m_Baseline[index * 4], pBaseline, sizeof(float) * 4 * count);
+                m_SpanValid = false;
+            }
+
+            bool IsEmpty() const
+            {
+                return m_Owned.empty();
+            }
+
+            /**
+             * Writes a run of registers to the shadow copy, leaving the baseline as it was.
+             *
+             * @return False if any of the registers is not in the block.
+             */
+            bool Write(const uint32_t reg, const float * pValues, const uint32_t count)
+            {
+                if (!this->Contains(reg, count)) return false;
+
+                float * pShadow = &m_Shadow[(reg - m_Start) * 4];
+                if (memcmp(pShadow, pValues, sizeof(float) * 4 * count) != 0)
+                {
+                    memcpy(pShadow, pValues, sizeof(float) * 4 * count);
+                    m_SpanValid = false;
+                }
+
+                return true;
+            }
+
+            /**
+             * Sets the baseline and shadow copy of a run of registers, when the effect has been given a new value that
+             * beginning a pass will restore.
+             *
+             * @return False if any of the registers is not in the block.
+             */
+            bool Restore(const uint32_t reg, const float * pValues, const uint32_t count)
+            {
+                if (!this->Contains(reg, count)) return false;
+
+                uint32_t index = reg - m_Start;
+                memcpy(&m_Baseline[index * 4], pValues, sizeof(float) * 4 * count);
+                memcpy(&m_Shadow[index * 4], pValues, sizeof(float) * 4 * count);
+                m_SpanValid = false;
+                return true;
+            }
+
+            /**
+             * Uploads the registers that differ from the baseline. The sink is called as
+             * <code>sink(startRegister, pData, registerCount)</code>, once with the whole changed span, or not at all
+             * when nothing changed. Must be called after every pass begins, since beginning the pass restores the
+             * baseline.
+             *
+             * @return The number of sink calls made.
+             */
+            template<typename Sink>
+            uint32_t Flush(Sink & sink)
+            {
+                if (!m_SpanValid)
+                {
+                    this->FindSpan();
+                }
+
+                if (!m_Changed) return 0;
+
+                sink(m_Start + m_First, &m_Shadow[m_First * 4], m_Last - m_First + 1);
+                return 1;
+            }
+
+        private:
+            bool Contains(const uint32_t reg, const uint32_t count) const
+            {
+                if (reg < m_Start || count == 0 || reg - m_Start + count > m_Owned.size()) return false;
+
+                for (uint32_t index = reg - m_Start; index < reg - m_Start + count; ++index)
+                {
+                    if (!m_Owned[index]) return false;
+                }
+
+                return true;
+            }
+
+            void FindSpan()
+            {
+                m_Changed = false;
+
+                uint32_t count = static_cast<uint32_t>(m_Owned.size());
+                for (uint32_t index = 0; index < count; ++index)
+                {
+                    if (m_Owned[index] && memcmp(&m_Shadow[index * 4], &m_Baseline[index * 4], sizeof(float) * 4) != 0)
+                    {
+                        if (!m_Changed)
+                        {
+                            m_First = index;
+                            m_Changed = true;
+                        }
+                        m_Last = index;
+                    }
+                }
+
+                m_SpanValid = true;
+            }
+
+            uint32_t m_Start;
+            uint32_t m_First;
+            uint32_t m_Last;
+            bool m_Changed;
+            bool m_SpanValid;
+            std::vector<bool> m_Owned;
+            std::vector<float> m_Shadow;
+            std::vector<float> m_Baseline;
+        };
+    }
+}
@@ -0,0 +1,204 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+/**
+ * Standalone tests for the constant block packing and diffing, against a sink recording each upload in place of the
+ * device. Needs only a C++ compiler, for example:
+ *
+ *     g++ -std=c++11 -o ConstantBlockTest ConstantBlockTest.cpp && ./ConstantBlockTest
+ *
+ * Returns zero when every check passes.
+ */
+#include "../ConstantBlockDX9.hpp"
+
+#pragma warning(push,3)
+#include <cstdio>
+#include <vector>
+#pragma warning(pop)
+
+using VoodooShader::Voodoo_D3D9::ConstantBlock;
+
+namespace
+{
+    int gFailures = 0;
+
+#define CHECK(expr) \
+    if (!(expr)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #expr); ++gFailures; }
+
+    /**
+     * Stands in for SetVertexShaderConstantF, recording every call.
+     */
+    struct RecordingSink
+    {
+        struct Call
+        {
+            uint32_t Start;
+            uint32_t Count;
+            std::vector<float> Data;
+        };
+
+        std::vector<Call> Calls;
+
+        void operator()(uint32_t start, const float * pData, uint32_t count)
+        {
+            Call call = {start, count, std::vector<float>(pData, pData + count * 4)};
+            Calls.push_back(call);
+        }
+    };
+
+    const float Zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const float One[4]  = {1.0f, 1.0f, 1.0f, 1.0f};
+    const float Two[4]  = {2.0f, 2.0f, 2.0f, 2.0f};
+
+    void TestUnchanged()
+    {
+        ConstantBlock block;
+        CHECK(block.IsEmpty());
+
+        block.Add(4, 1, Zero);
+        block.Add(5, 1, One);
+        CHECK(!block.IsEmpty());
+
+        // Writing the baseline back is not a change
+        CHECK(block.Write(5, One, 1));
+
+        RecordingSink sink;
+        CHECK(block.Flush(sink) == 0);
+        CHECK(sink.Calls.empty());
+    }
+
+    void TestSpan()
+    {
+        ConstantBlock block;
+        const float baseline[16] = {0.0f};
+        block.Add(4, 4, baseline);
+
+        // Only the changed register is uploaded
+        CHECK(block.Write(5, Two, 1));
+        RecordingSink first;
+        CHECK(block.Flush(first) == 1);
+        CHECK(first.Calls.size() == 1 && first.Calls[0].Start == 5 && first.Calls[0].Count == 1);
+        CHECK(first.Calls.size() == 1 && first.Calls[0].Data[0] == 2.0f);
+
+        // The span runs from the first to the last change, including unchanged registers between them
+        CHECK(block.Write(4, One, 1));
+        CHECK(block.Write(6, One, 1));
+        RecordingSink second;
+        CHECK(block.Flush(second) == 1);
+        CHECK(second.Calls.size() == 1 && second.Calls[0].Start == 4 && second.Calls[0].Count == 3);
+        CHECK(second.Calls.size() == 1 && second.Calls[0].Data[4] == 2.0f && second.Calls[0].Data[8] == 1.0f);
+    }
+
+    void TestRuns()
+    {
+        ConstantBlock block;
+        const float matrix[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+        block.Add(0, 4, matrix);
+
+        // Runs are written whole, and must lie inside the block
+        CHECK(!block.Write(2, matrix, 3));
+        CHECK(block.Write(0, matrix, 4));
+
+        const float scaled[8] = {2.0f, 0.0f, 0.0f, 0.0f, 0.0f, 2.0f, 0.0f, 0.0f};
+        CHECK(block.Write(0, scaled, 2));
+
+        RecordingSink sink;
+        CHECK(block.Flush(sink) == 1);
+        CHECK(sink.Calls.size() == 1 && sink.Calls[0].Start == 0 && sink.Calls[0].Count == 2);
+        if (sink.Calls.size() == 1)
+        {
+            const std::vector<float> & data = sink.Calls[0].Data;
+            CHECK(data[0] == 2.0f && data[5] == 2.0f && data[1] == 0.0f);
+        }
+    }
+
+    void TestGaps()
+    {
+        ConstantBlock block;
+        block.Add(5, 1, Zero);
+        block.Add(2, 1, Zero);
+        block.Add(3, 1, Zero);
+
+        // Register 4 is not read by the shader, so it can never be written directly
+        CHECK(!block.Write(4, One, 1));
+        CHECK(!block.Write(1, One, 1));
+        CHECK(!block.Write(9, One, 1));
+        CHECK(!block.Write(3, One, 2));
+
+        CHECK(block.Write(2, One, 1));
+        CHECK(block.Write(5, Two, 1));
+
+        // One call per stage, padding the register between with zeros
+        RecordingSink sink;
+        CHECK(block.Flush(sink) == 1);
+        CHECK(sink.Calls.size() == 1);
+        if (sink.Calls.size() == 1)
+        {
+            const std::vector<float> & data = sink.Calls[0].Data;
+            CHECK(sink.Calls[0].Start == 2 && sink.Calls[0].Count == 4);
+            CHECK(data[0] == 1.0f && data[4] == 0.0f && data[8] == 0.0f && data[12] == 2.0f);
+        }
+    }
+
+    void TestRestore()
+    {
+        ConstantBlock block;
+        block.Add(0, 1, Zero);
+        block.Add(1, 1, Zero);
+
+        CHECK(block.Write(0, One, 1));
+
+        // Beginning each pass restores the baseline, so the change is uploaded again every flush
+        RecordingSink first, second;
+        CHECK(block.Flush(first) == 1);
+        CHECK(block.Flush(second) == 1);
+        CHECK(second.Calls.size() == 1 && second.Calls[0].Start == 0 && second.Calls[0].Count == 1);
+
+        // Once the effect holds the value, the pass restores it and nothing is left to upload
+        CHECK(block.Restore(0, One, 1));
+        RecordingSink third;
+        CHECK(block.Flush(third) == 0);
+
+        // Restoring also moves the shadow, so a later write compares against the new baseline
+        CHECK(block.Write(0, One, 1));
+        CHECK(block.Write(1, Two, 1));
+        RecordingSink fourth;
+        CHECK(block.Flush(fourth) == 1);
+        CHECK(fourth.Calls.size() == 1 && fourth.Calls[0].Start == 1 && fourth.Calls[0].Count == 1);
+
+        CHECK(!block.Restore(2, One, 1));
+    }
+}
+
+int main()
+{
+    TestUnchanged();
+    TestSpan();
+    TestRuns();
+    TestGaps();
+    TestRestore();
+
+    if (gFailures == 0)
+    {
+        printf("All constant block checks passed.\n");
+    }
+
+    return gFailures;
+}
@@ -33,8 +33,11 @@ namespace VoodooShader
 {
     namespace Voodoo_D3D9
     {
+        #define VOODOO_DEBUG_TYPE VSBindingDX9
+        DeclareDebugCache();
+
         VSBindingDX9::VSBindingDX9(_In_ ICore * pCore)
-            : m_Refs(0), m_Core(pCore), m_Device(nullptr)
+            : m_Refs(0), m_Core(pCore), m_Device(nullptr), m_LinkGeneration(1)
         {
             // Start up DevIL for D3D loading
             ilInit();
@@ -51,10 +54,14 @@ namespace VoodooShader
             {
                 m_ILUT = true;
             }
+
+            AddThisToDebugCache();
         }
 
         VSBindingDX9::~VSBindingDX9()
         {
+            RemoveThisFromDebugCache();
+
             if (m_Device)
             {
                 m_Device->Release();
@@ -68,46 +75,26 @@ namespace VoodooShader
 
         VOODOO_METHODDEF_(uint32_t, VSBindingDX9::Release)() CONST
         {
-            if (SAFE_DECREMENT(m_Refs) == 0)
+            uint32_t count = SAFE_DECREMENT(m_Refs);
+            if (count == 0)
             {
                 delete this;
-                return 0;
-            }
-            else
-            {
-                return m_Refs;
             }
+            return count;
         }
 
         VOODOO_METHODDEF(VSBindingDX9::QueryInterface)(_In_ CONST Uuid refid, _Outptr_result_maybenull_ IObject ** ppOut)
         {
-            if (!ppOut)
-            {
-                return VSFERR_INVALIDPARAMS;
-            }
-            else
+            static CONST InterfaceMapEntry map[] =
             {
-                if (refid == IID_IObject)
-                {
-                    *ppOut = static_cast<IObject*>(this);
-                }
-                else if (refid == IID_IBinding)
-                {
-                    *ppOut = static_cast<IBinding*>(this);
-                }
-                else if (refid == CLSID_VSBindingDX9)
-                {
-                    *ppOut = static_cast<VSBindingDX9*>(this);
-                }
-                else
-                {
-                    *ppOut = nullptr;
-                    return VSFERR_INVALIDUUID;
-                }
-
-                (*ppOut)->AddRef();
-                return VSF_OK;
-            }
+                VOODOO_INTERFACE_ENTRY(VSBindingDX9, IObject),
+                VOODOO_INTERFACE_ENTRY(VSBindingDX9, IBinding),
+                VOODOO_CLASS_ENTRY(VSBindingDX9),
+                VOODOO_INTERFACE_MAP_END
+            };
+            static volatile LONG hint = 0;
+
+            return QueryInterfaceMap(this, map, &hint, refid, ppOut);
         }
 
         VOODOO_METHODDEF_(String, VSBindingDX9::ToString)() CONST
@@ -127,12 +114,13 @@ namespace VoodooShader
                 return VSFERR_INVALIDPARAMS;
             }
 
-            if (pParams[0].Type != VSUT_PVoid || !pParams[0].VPVoid)
+            void * pDevice = nullptr;
+            if (!VariantCast(pParams[0], &pDevice) || !pDevice)
             {
                 return VSFERR_INVALIDPARAMS;
             }
 
-            m_Device = reinterpret_cast<LPDIRECT3DDEVICE9>(pParams[0].VPVoid);
+            m_Device = reinterpret_cast<LPDIRECT3DDEVICE9>(pDevice);
             m_Device->AddRef();
 
             HRESULT errors = m_Device->CreateStateBlock(D3DSBT_ALL, &m_InitialState);
@@ -164,7 +152,8 @@ namespace VoodooShader
             LPD3DXEFFECT effect = NULL;
             LPD3DXBUFFER errors = NULL;
 
-            HRESULT hr = D3DXCreateEffect(m_Device, asource.c_str(), asource.length(), NULL, NULL, 0, NULL, 
+            // Without preshaders every register a shader reads is a parameter in its constant table, which packing needs
+            HRESULT hr = D3DXCreateEffect(m_Device, asource.c_str(), asource.length(), NULL, NULL, D3DXSHADER_NO_PRESHADER, NULL, 
                 &effect, &errors);
             if (FAILED(hr))
             {
@@ -174,8 +163,7 @@ namespace VoodooShader
                 return nullptr;
             }
 
-            IEffect * pEffect = new VSEffectDX9(this, effect);
-            return pEffect;
+            return this->Impl_CreateEffect(effect);
         }
 
         VOODOO_METHODDEF_(IEffect *, VSBindingDX9::CreateEffectFromFile)(_In_ CONST IFile * pFile)
@@ -189,7 +177,7 @@ namespace VoodooShader
             LPD3DXEFFECT effect = NULL;
             LPD3DXBUFFER errors = NULL;
 
-            HRESULT hr = D3DXCreateEffectFromFile(m_Device, pFile->GetPath().GetData(), NULL, NULL, 0, NULL, 
+            HRESULT hr = D3DXCreateEffectFromFile(m_Device, pFile->GetPath().GetData(), NULL, NULL, D3DXSHADER_NO_PRESHADER, NULL, 
                 &effect, &errors);
             if (FAILED(hr))
             {
@@ -200,7 +188,21 @@ namespace VoodooShader
                 return nullptr;
             }
 
+            return this->Impl_CreateEffect(effect);
+        }
+
+        IEffect * VSBindingDX9::Impl_CreateEffect(_In_ LPD3DXEFFECT effect)
+        {
+            LARGE_INTEGER start, end, freq;
+            QueryPerformanceCounter(&start);
+
             IEffect * pEffect = new VSEffectDX9(this, effect);
+
+            QueryPerformanceCounter(&end);
+            QueryPerformanceFrequency(&freq);
+            m_Core->GetLogger()->LogMessage(VSLog_PlugDebug, VOODOO_D3D9_NAME, 
+                StringFormat("Created effect objects in %1% us.") << ((end.QuadPart - start.QuadPart) * 1000000 / freq.QuadPart));
+
             return pEffect;
         }
 
@@ -89,6 +89,7 @@ namespace VoodooShader
 
         private:            
             // Internals
+            IEffect * Impl_CreateEffect(_In_ LPD3DXEFFECT effect);
             LPDIRECT3DTEXTURE9 Impl_CreateTexture(_In_ TextureDesc & desc, _In_ DWORD usage, _In_ D3DFORMAT format);
 
             mutable uint32_t m_Refs;
@@ -105,6 +106,9 @@ namespace VoodooShader
             PassRef m_BoundPass;
             TextureRef m_BoundSourceTexture[8];
             TextureRef m_BoundTargetTexture[4];
+
+            /** Bumped whenever parameters are attached or detached, so flattened link targets know to rebuild. */
+            uint32_t m_LinkGeneration;
         };
     }
 }
@@ -33,7 +33,7 @@ namespace VoodooShader
         DeclareDebugCache();
 
         VSEffectDX9::VSEffectDX9(_In_ VSBindingDX9 * pBinding, LPD3DXEFFECT pEffect) :
-            m_Refs(0), m_Binding(pBinding), m_Handle(pEffect)
+            m_Refs(0), m_Binding(pBinding), m_ParameterSets(0), m_ParameterUploads(0), m_Handle(pEffect)
         {
             if (!m_Binding)
             {
@@ -62,6 +62,13 @@ namespace VoodooShader
                 Throw(VOODOO_D3D9_NAME, VSTR("Failed to retrieve effect description."), m_Core);
             }
 
+            m_Properties.Set<VSPropSlot_D3DX9Effect>(CreateVariant(m_Handle));
+
+            // Reserve up front, the objects themselves come from the type pools
+            m_Parameters.reserve(desc.Parameters);
+            m_DirtyParameters.reserve(desc.Parameters);
+            m_Techniques.reserve(desc.Techniques);
+
             // Get parameters
             for (UINT paramIndex = 0; paramIndex < desc.Parameters; ++paramIndex)
             {
@@ -77,6 +84,9 @@ namespace VoodooShader
                 parameter->Link();
             }
 
+            // Passes take the values the effect holds as their baseline, so it must hold everything linking set
+            this->Impl_FlushParameters();
+
             // Get techniques
             for (UINT techIndex = 0; techIndex < desc.Techniques; ++techIndex)
             {
@@ -107,6 +117,13 @@ namespace VoodooShader
                 }
             } 
 
+            ParameterVector::iterator parameter = m_Parameters.begin();
+            while (parameter != m_Parameters.end())
+            {
+                static_cast<VSParameterDX9 *>(parameter->get())->Impl_Pack();
+                ++parameter;
+            }
+
             AddThisToDebugCache();
         }
 
@@ -114,8 +131,17 @@ namespace VoodooShader
         {
             RemoveThisFromDebugCache();
 
+            // Passes may be held elsewhere, so parameters must not keep pointers into their blocks
+            ParameterVector::iterator parameter = m_Parameters.begin();
+            while (parameter != m_Parameters.end())
+            {
+                static_cast<VSParameterDX9 *>(parameter->get())->Impl_Unpack(nullptr);
+                ++parameter;
+            }
+
             m_DefaultTechnique = nullptr;
             m_Techniques.clear();
+            m_DirtyParameters.clear();
             m_Parameters.clear();
         }
 
@@ -128,47 +154,28 @@ namespace VoodooShader
         uint32_t VOODOO_METHODTYPE VSEffectDX9::Release() CONST
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
-            if (SAFE_DECREMENT(m_Refs) == 0)
+            uint32_t count = SAFE_DECREMENT(m_Refs);
+            if (count == 0)
             {
                 delete this;
-                return 0;
-            }
-            else
-            {
-                return m_Refs;
             }
+            return count;
         }
 
         VOODOO_METHODDEF(VSEffectDX9::QueryInterface)(_In_ CONST Uuid refid, _Outptr_result_maybenull_ IObject ** ppOut)
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
-            if (!ppOut)
-            {
-                return VSFERR_INVALIDPARAMS;
-            }
-            else
-            {
-                if (refid == IID_IObject)
-                {
-                    *ppOut = static_cast<IObject*>(this);
-                }
-                else if (refid == IID_IEffect)
-                {
-                    *ppOut = static_cast<IEffect*>(this);
-                }
-                else if (refid == CLSID_VSEffectDX9)
-                {
-                    *ppOut = static_cast<VSEffectDX9*>(this);
-                }
-                else
-                {
-                    *ppOut = nullptr;
-                    return VSFERR_INVALIDUUID;
-                }
 
-                (*ppOut)->AddRef();
-                return VSF_OK;
-            }
+            static CONST InterfaceMapEntry map[] =
+            {
+                VOODOO_INTERFACE_ENTRY(VSEffectDX9, IObject),
+                VOODOO_INTERFACE_ENTRY(VSEffectDX9, IEffect),
+                VOODOO_CLASS_ENTRY(VSEffectDX9),
+                VOODOO_INTERFACE_MAP_END
+            };
+            static volatile LONG hint = 0;
+
+            return QueryInterfaceMap(this, map, &hint, refid, ppOut);
         }
 
         String VOODOO_METHODTYPE VSEffectDX9::ToString() CONST
@@ -192,39 +199,35 @@ namespace VoodooShader
 
         VoodooResult VOODOO_METHODTYPE VSEffectDX9::GetProperty(_In_ CONST Uuid propid, _Out_ Variant * pValue) CONST
         {
-            if (!pValue) VSFERR_INVALIDPARAMS;
+            if (!pValue) return VSFERR_INVALIDPARAMS;
 
-            if (propid == PropIds::D3DX9Effect)
+            if (IsSameUuid(propid, PropIds::ParameterStats))
             {
-                pValue->Type = VSUT_PVoid;
-                pValue->VPVoid = (PVOID)m_Handle;
+                UInt2 stats = {m_ParameterSets, m_ParameterUploads};
+                *pValue = CreateVariant(stats);
                 return VSF_OK;
             }
-            else
+
+            if (m_Properties.Get(propid, pValue))
             {
-                PropertyMap::const_iterator property = m_Properties.find(propid);
-                if (property != m_Properties.end())
-                {
-                    CopyMemory(pValue, &property->second, sizeof(Variant));
-                    return VSF_OK;
-                }
-				else
-				{
-					*pValue = CreateVariant();
-				}
+                return VSF_OK;
             }
 
+            *pValue = CreateVariant();
             return VSFERR_INVALIDCALL;
         }
 
         VoodooResult VOODOO_METHODTYPE VSEffectDX9::SetProperty(_In_ CONST Uuid propid, _In_ Variant * pValue)
         {
-            if (propid == PropIds::D3DX9Effect)
+            if (!pValue) return VSFERR_INVALIDPARAMS;
+
+            // Well-known properties are read-only, they hold the hardware handles.
+            if (PropertyStore::FindSlot(propid) != VSPropSlot_Spill || IsSameUuid(propid, PropIds::ParameterStats))
             {
                 return VSFERR_INVALIDPARAMS;
             }
 
-            m_Properties[propid] = (*pValue);
+            m_Properties.Set(propid, *pValue);
             return VSF_OK;
         }
 
@@ -232,6 +235,8 @@ namespace VoodooShader
         {
             if (m_Binding->m_BoundEffect && m_Binding->m_BoundEffect != this) return nullptr;
 
+            this->Impl_FlushParameters();
+
             UINT passes = 0;
             DWORD flags = 0;
             if (clean)
@@ -271,6 +276,27 @@ namespace VoodooShader
             }
         }
 
+        void VSEffectDX9::Impl_FlushParameters()
+        {
+            std::vector<VSParameterDX9 *>::iterator iter = m_DirtyParameters.begin();
+            while (iter != m_DirtyParameters.end())
+            {
+                VSParameterDX9 * pParam = (*iter);
+                if (pParam->Impl_Upload())
+                {
+                    ++m_ParameterUploads;
+                }
+                else
+                {
+                    m_Core->GetLogger()->LogMessage(VSLog_PlugWarning, VOODOO_D3D9_NAME, 
+                        StringFormat("Unable to upload value of parameter %1%.") << pParam->GetName());
+                }
+                ++iter;
+            }
+
+            m_DirtyParameters.clear();
+        }
+
         uint32_t VOODOO_METHODTYPE VSEffectDX9::GetTechniqueCount() CONST
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
@@ -61,16 +61,25 @@ namespace VoodooShader
             VOODOO_METHOD_(ITechnique *, GetDefaultTechnique)() CONST;
             VOODOO_METHOD(SetDefaultTechnique)(_In_ ITechnique * pTechnique);
 
+            /**
+             * Uploads the parameters changed since the last flush. Called before the effect or one of its passes is bound.
+             */
+            void Impl_FlushParameters();
+
         private:
             mutable uint32_t m_Refs;
             ICore * m_Core;
 
             VSBindingDX9 * m_Binding;
-            PropertyMap m_Properties;
+            PropertyStore m_Properties;
 
             TechniqueRef m_DefaultTechnique;
             TechniqueVector m_Techniques;
             ParameterVector m_Parameters;
+            /** Parameters with values not yet uploaded, owned through m_Parameters. */
+            std::vector<VSParameterDX9 *> m_DirtyParameters;
+            uint32_t m_ParameterSets;
+            uint32_t m_ParameterUploads;
 
             LPD3DXEFFECT m_Handle;
         };
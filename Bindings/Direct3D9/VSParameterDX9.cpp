@@ -22,6 +22,8 @@
 // Voodoo D3D9
 #include "VSBindingDX9.hpp"
 #include "VSEffectDX9.hpp"
+#include "VSPassDX9.hpp"
+#include "VSTechniqueDX9.hpp"
 #include "D3D9_Version.hpp"
 
 namespace VoodooShader
@@ -30,9 +32,10 @@ namespace VoodooShader
     {
         #define VOODOO_DEBUG_TYPE VSParameterDX9
         DeclareDebugCache();
+        VOODOO_DEFINE_POOLED(VSParameterDX9, 64);
 
         VSParameterDX9::VSParameterDX9(_In_ VSEffectDX9 * pEffect, _In_ D3DXHANDLE pParamHandle) :
-            m_Refs(0), m_Effect(pEffect), m_Handle(pParamHandle)
+            m_Refs(0), m_Effect(pEffect), m_Handle(pParamHandle), m_TextureHandle(nullptr), m_Dirty(false), m_FloatCount(1), m_Packable(false), m_Packed(false), m_Expression(false), m_TargetsGeneration(0), m_VBool(false), m_VInt(0)
         {
             if (!m_Effect)
             {
@@ -51,6 +54,8 @@ namespace VoodooShader
                 Throw(VOODOO_D3D9_NAME, VSTR("Unable to create parameter with no hardware handle."), m_Core);
             }
 
+            m_Properties.Set<VSPropSlot_D3DX9Handle>(CreateVariant(m_Handle));
+
             D3DXPARAMETER_DESC desc;
             ZeroMemory(&desc, sizeof(D3DXPARAMETER_DESC));
             if (FAILED(m_Effect->m_Handle->GetParameterDesc(m_Handle, &desc)))
@@ -64,12 +69,45 @@ namespace VoodooShader
             m_Desc.Rows = desc.Rows;
             m_Desc.Elements = desc.Elements;
 
+            // Seed the value cache, so sets can be compared against what the effect holds
+            ZeroMemory(&m_VFloat, sizeof(Float4));
+            m_FloatCount = std::max<UINT>(desc.Rows * desc.Columns, 1) * std::max<UINT>(desc.Elements, 1);
+            if (m_FloatCount > 4)
+            {
+                m_VArray.resize(m_FloatCount, 0.0f);
+            }
+
+            if (m_Desc.Type == VSPT_Bool)
+            {
+                BOOL value = FALSE;
+                m_Effect->m_Handle->GetBool(m_Handle, &value);
+                m_VBool = (value != FALSE);
+            }
+            else if (m_Desc.Type == VSPT_Int)
+            {
+                m_Effect->m_Handle->GetInt(m_Handle, &m_VInt);
+            }
+            else if (m_Desc.Type == VSPT_Float)
+            {
+                m_Effect->m_Handle->GetFloatArray(m_Handle, this->Impl_Floats(), m_FloatCount);
+            }
+
             AddThisToDebugCache();
         }
 
         VSParameterDX9::VSParameterDX9(_In_ VSBindingDX9 * pBinding, _In_ CONST String & name, _In_ ParameterDesc desc) :
-            m_Refs(0), m_Binding(pBinding), m_Effect(nullptr), m_Name(name), m_Desc(desc), m_Handle(nullptr)
+            m_Refs(0), m_Binding(pBinding), m_Effect(nullptr), m_Name(name), m_Desc(desc), m_Handle(nullptr), m_TextureHandle(nullptr), m_Dirty(false),
+            m_FloatCount(4), m_Packable(false), m_Packed(false), m_Expression(false), m_TargetsGeneration(0), m_VBool(false), m_VInt(0)
         {
+            ZeroMemory(&m_VFloat, sizeof(Float4));
+
+            // Virtual parameters always hold a full vector, so any value can be linked through them
+            m_FloatCount = std::max<UINT>(std::max<UINT>(m_Desc.Rows * m_Desc.Columns, 1) * std::max<UINT>(m_Desc.Elements, 1), 4);
+            if (m_FloatCount > 4)
+            {
+                m_VArray.resize(m_FloatCount, 0.0f);
+            }
+
             if (!m_Binding)
             {
                 Throw(VOODOO_D3D9_NAME, VSTR("Unable to create virtual parameter with no binding."), nullptr);
@@ -82,6 +120,11 @@ namespace VoodooShader
 
         VSParameterDX9::~VSParameterDX9()
         {
+            if (m_Expression)
+            {
+                m_Core->SetExpression(this, String());
+            }
+
             RemoveThisFromDebugCache();
         }
 
@@ -94,47 +137,28 @@ namespace VoodooShader
         uint32_t VOODOO_METHODTYPE VSParameterDX9::Release() CONST
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
-            if (SAFE_DECREMENT(m_Refs) == 0)
+            uint32_t count = SAFE_DECREMENT(m_Refs);
+            if (count == 0)
             {
                 delete this;
-                return 0;
-            }
-            else
-            {
-                return m_Refs;
             }
+            return count;
         }
 
         VoodooResult VOODOO_METHODTYPE VSParameterDX9::QueryInterface(_In_ CONST Uuid refid, _Outptr_result_maybenull_ IObject ** ppOut)
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
-            if (!ppOut)
-            {
-                return VSFERR_INVALIDPARAMS;
-            }
-            else
-            {
-                if (refid == IID_IObject)
-                {
-                    *ppOut = static_cast<IObject*>(this);
-                }
-                else if (refid == IID_IParameter)
-                {
-                    *ppOut = static_cast<IParameter*>(this);
-                }
-                else if (refid == CLSID_VSParameterDX9)
-                {
-                    *ppOut = static_cast<VSParameterDX9*>(this);
-                }
-                else
-                {
-                    *ppOut = nullptr;
-                    return VSFERR_INVALIDUUID;
-                }
 
-                (*ppOut)->AddRef();
-                return VSF_OK;
-            }
+            static CONST InterfaceMapEntry map[] =
+            {
+                VOODOO_INTERFACE_ENTRY(VSParameterDX9, IObject),
+                VOODOO_INTERFACE_ENTRY(VSParameterDX9, IParameter),
+                VOODOO_CLASS_ENTRY(VSParameterDX9),
+                VOODOO_INTERFACE_MAP_END
+            };
+            static volatile LONG hint = 0;
+
+            return QueryInterfaceMap(this, map, &hint, refid, ppOut);
         }
 
         String VOODOO_METHODTYPE VSParameterDX9::ToString() CONST
@@ -162,25 +186,14 @@ namespace VoodooShader
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
-            if (!pValue) VSFERR_INVALIDPARAMS;
+            if (!pValue) return VSFERR_INVALIDPARAMS;
 
-            if (propid == PropIds::D3DX9Handle)
+            if (m_Properties.Get(propid, pValue))
             {
-                pValue->Type = VSUT_PVoid;
-                pValue->VPVoid = (PVOID)m_Handle;
                 return VSF_OK;
             }
-            else
-            {
-                PropertyMap::const_iterator property = m_Properties.find(propid);
-                if (property != m_Properties.end())
-                {
-                    CopyMemory(pValue, &property->second, sizeof(Variant));
-                    return VSF_OK;
-                }
-            }
 
-			*pValue = CreateVariant();
+            *pValue = CreateVariant();
             return VSFERR_INVALIDCALL;
         }
 
@@ -188,12 +201,31 @@ namespace VoodooShader
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
-            if (propid == PropIds::D3DX9Handle)
+            if (!pValue) return VSFERR_INVALIDPARAMS;
+
+            // Packed arrays are set as values, without expanding them into a variant per element
+            if (IsSameUuid(propid, PropIds::ParameterValue))
             {
+                uint32_t count = 0;
+                if (CONST Float4 * pVectors = GetArrayData<Float4>(*pValue, &count))
+                {
+                    return this->SetVectorArray(count, pVectors);
+                }
+                else if (CONST float * pFloats = GetArrayData<float>(*pValue, &count))
+                {
+                    return this->SetFloatArray(count, pFloats);
+                }
+
                 return VSFERR_INVALIDPARAMS;
             }
 
-            m_Properties[propid] = (*pValue);
+            // Well-known properties are read-only, they hold the hardware handles.
+            if (PropertyStore::FindSlot(propid) != VSPropSlot_Spill)
+            {
+                return VSFERR_INVALIDPARAMS;
+            }
+
+            m_Properties.Set(propid, *pValue);
             return VSF_OK;
         }
 
@@ -215,7 +247,7 @@ namespace VoodooShader
 				return VSFERR_INVALIDCALL;
 			}
 
-            if (m_Effect && m_Handle)
+            if (m_Effect && m_Handle && !m_Dirty)
             {
                 BOOL rv = 0;
                 if (SUCCEEDED(m_Effect->m_Handle->GetBool(m_Handle, &rv)))
@@ -245,12 +277,12 @@ namespace VoodooShader
 				return VSFERR_INVALIDCALL;
 			}
 
-            if (m_Effect && m_Handle)
+            if (m_Effect && m_Handle && !m_Dirty && !m_Packed)
             {
                 float tVal;
                 if (SUCCEEDED(m_Effect->m_Handle->GetFloat(m_Handle, &tVal)))
                 {
-                    m_VFloat.X = tVal;
+                    this->Impl_Floats()[0] = tVal;
                 }
                 else
                 {
@@ -259,7 +291,7 @@ namespace VoodooShader
                 }
             }
         
-            (*pVal) = m_VFloat.X;
+            (*pVal) = this->Impl_Floats()[0];
 
             return VSF_OK;
         }
@@ -275,7 +307,7 @@ namespace VoodooShader
 				return VSFERR_INVALIDCALL;
 			}
 
-            if (m_Effect && m_Handle && FAILED(m_Effect->m_Handle->GetInt(m_Handle, &m_VInt)))
+            if (m_Effect && m_Handle && !m_Dirty && FAILED(m_Effect->m_Handle->GetInt(m_Handle, &m_VInt)))
             {
 				*pVal = 0;
                 return VSFERR_APIERROR;
@@ -286,6 +318,33 @@ namespace VoodooShader
             return VSF_OK;
         }
 
+        VOODOO_METHODDEF(VSParameterDX9::GetMatrix)(_Out_ Float4x4 * pVal) CONST
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            if (!pVal) return VSFERR_INVALIDPARAMS;
+
+            ZeroMemory(pVal, sizeof(Float4x4));
+            if (m_Desc.Type != VSPT_Float) return VSFERR_INVALIDCALL;
+
+            if (m_Effect && m_Handle && !m_Dirty && !m_Packed &&
+                FAILED(m_Effect->m_Handle->GetFloatArray(m_Handle, this->Impl_Floats(), m_FloatCount)))
+            {
+                return VSFERR_APIERROR;
+            }
+
+            // The cache holds the matrix compactly, one row of columns after another
+            UINT rows = std::min<UINT>(std::max<UINT>(m_Desc.Rows, 1), 4);
+            UINT cols = std::min<UINT>(std::max<UINT>(m_Desc.Columns, 1), 4);
+            CONST float * pFloats = this->Impl_Floats();
+            for (UINT row = 0; row < rows; ++row)
+            {
+                memcpy(pVal->M[row], pFloats + row * cols, sizeof(float) * cols);
+            }
+
+            return VSF_OK;
+        }
+
         VOODOO_METHODDEF(VSParameterDX9::GetString)(_Out_ String * pVal) CONST
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
@@ -297,7 +356,7 @@ namespace VoodooShader
 				return VSFERR_INVALIDCALL;
 			}
 
-            if (m_Effect && m_Handle)
+            if (m_Effect && m_Handle && !m_Dirty)
             {
                 LPCSTR rv = nullptr;
                 if (SUCCEEDED(m_Effect->m_Handle->GetString(m_Handle, &rv)) && rv)
@@ -343,15 +402,12 @@ namespace VoodooShader
 				return VSFERR_INVALIDCALL;
 			}
 
-            if (m_Effect && m_Handle)
+            if (m_Effect && m_Handle && !m_Dirty && !m_Packed)
             {
                 D3DXVECTOR4 rv;
                 if (SUCCEEDED(m_Effect->m_Handle->GetVector(m_Handle, &rv)))
                 {
-                    m_VFloat.X = rv.x;
-                    m_VFloat.Y = rv.y;
-                    m_VFloat.Z = rv.z;
-                    m_VFloat.W = rv.w;
+                    memcpy(this->Impl_Floats(), &rv.x, sizeof(Float4));
                 }
                 else
                 {
@@ -360,7 +416,7 @@ namespace VoodooShader
                 }
             }
 
-            (*pVal) = m_VFloat;
+            memcpy(pVal, this->Impl_Floats(), sizeof(Float4));
 
             return VSF_OK;
         }
@@ -371,160 +427,563 @@ namespace VoodooShader
 
             if (m_Desc.Type != VSPT_Bool) return VSFERR_INVALIDCALL;
 
-            m_VBool = val;
+            return this->Impl_Propagate
+            (
+                [val](VSParameterDX9 * pParam) { return pParam->Impl_SetBool(val); },
+                [val](IParameter * pParam) { return pParam->SetBool(val); }
+            );
+        }
 
-            ParameterList::iterator child = m_Attached.begin();
-            while (child != m_Attached.end())
-            {
-                (*child)->SetBool(val);
-            }
+        VOODOO_METHODDEF(VSParameterDX9::SetFloat)(_In_ CONST float val)
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            if (m_Desc.Type != VSPT_Float) return VSFERR_INVALIDCALL;
+
+            return this->Impl_Propagate
+            (
+                [val](VSParameterDX9 * pParam) { return pParam->Impl_SetFloat(val); },
+                [val](IParameter * pParam) { return pParam->SetFloat(val); }
+            );
+        }
+
+        VOODOO_METHODDEF(VSParameterDX9::SetFloatArray)(_In_ CONST uint32_t count, _In_reads_(count) CONST float * pVal)
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            if (!pVal || count == 0 || count > m_FloatCount) return VSFERR_INVALIDPARAMS;
+            if (m_Desc.Type != VSPT_Float) return VSFERR_INVALIDCALL;
+
+            uint32_t size = count * sizeof(float);
+            return this->Impl_Propagate
+            (
+                [size, pVal](VSParameterDX9 * pParam) { return pParam->Impl_SetRaw(0, size, pVal); },
+                [count, pVal](IParameter * pParam) { return pParam->SetFloatArray(count, pVal); }
+            );
+        }
+
+        VOODOO_METHODDEF(VSParameterDX9::SetInt)(_In_ CONST int32_t val)
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            if (m_Desc.Type != VSPT_Int) return VSFERR_INVALIDCALL;
+
+            return this->Impl_Propagate
+            (
+                [val](VSParameterDX9 * pParam) { return pParam->Impl_SetInt(val); },
+                [val](IParameter * pParam) { return pParam->SetInt(val); }
+            );
+        }
 
-            if (m_Effect && m_Handle && FAILED(m_Effect->m_Handle->SetBool(m_Handle, val)))
+        VOODOO_METHODDEF(VSParameterDX9::SetMatrix)(_In_ CONST Float4x4 & val)
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            return this->SetMatrixArray(1, &val);
+        }
+
+        VOODOO_METHODDEF(VSParameterDX9::SetMatrixArray)(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4x4 * pVal)
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            if (!pVal || count == 0 || count > std::max<uint32_t>(m_Desc.Elements, 1)) return VSFERR_INVALIDPARAMS;
+            if (m_Desc.Type != VSPT_Float) return VSFERR_INVALIDCALL;
+
+            return this->Impl_Propagate
+            (
+                [count, pVal](VSParameterDX9 * pParam) { return pParam->Impl_SetMatrixArray(count, pVal); },
+                [count, pVal](IParameter * pParam) { return pParam->SetMatrixArray(count, pVal); }
+            );
+        }
+
+        VOODOO_METHODDEF(VSParameterDX9::SetRaw)(_In_ CONST uint32_t offset, _In_ CONST uint32_t size, _In_reads_bytes_(size) CONST void * pData)
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            if (!pData || size == 0 || offset > m_FloatCount * sizeof(float) || size > m_FloatCount * sizeof(float) - offset)
             {
-                return VSFERR_APIERROR;
+                return VSFERR_INVALIDPARAMS;
             }
+            if (m_Desc.Type != VSPT_Float) return VSFERR_INVALIDCALL;
 
-            return VSF_OK;
+            return this->Impl_Propagate
+            (
+                [offset, size, pData](VSParameterDX9 * pParam) { return pParam->Impl_SetRaw(offset, size, pData); },
+                [offset, size, pData](IParameter * pParam) { return pParam->SetRaw(offset, size, pData); }
+            );
         }
 
-        VOODOO_METHODDEF(VSParameterDX9::SetFloat)(_In_ CONST float val)
+        VOODOO_METHODDEF(VSParameterDX9::SetString)(_In_ CONST String & val)
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            if (m_Desc.Type != VSPT_String) return VSFERR_INVALIDCALL;
+
+            return this->Impl_Propagate
+            (
+                [&val](VSParameterDX9 * pParam) { return pParam->Impl_SetString(val); },
+                [&val](IParameter * pParam) { return pParam->SetString(val); }
+            );
+        }
+
+        VOODOO_METHODDEF(VSParameterDX9::SetTexture)(_In_ ITexture * pVal)
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            if (m_Desc.Type < VSPT_Texture || m_Desc.Type > VSPT_TextureCube) return VSFERR_INVALIDCALL;
+
+            return this->Impl_Propagate
+            (
+                [pVal](VSParameterDX9 * pParam) { return pParam->Impl_SetTexture(pVal); },
+                [pVal](IParameter * pParam) { return pParam->SetTexture(pVal); }
+            );
+        }
+
+        VOODOO_METHODDEF(VSParameterDX9::SetVector)(_In_ CONST Float4 val)
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
             if (m_Desc.Type != VSPT_Float) return VSFERR_INVALIDCALL;
 
-            m_VFloat.X = val;
+            return this->Impl_Propagate
+            (
+                [&val](VSParameterDX9 * pParam) { return pParam->Impl_SetVector(val); },
+                [&val](IParameter * pParam) { return pParam->SetVector(val); }
+            );
+        }
+
+        VOODOO_METHODDEF(VSParameterDX9::SetVectorArray)(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4 * pVal)
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            if (!pVal || count == 0 || count > std::max<uint32_t>(m_Desc.Elements, 1)) return VSFERR_INVALIDPARAMS;
+            if (m_Desc.Type != VSPT_Float || m_Desc.Rows > 1) return VSFERR_INVALIDCALL;
 
-            ParameterList::iterator child = m_Attached.begin();
-            while (child != m_Attached.end())
+            return this->Impl_Propagate
+            (
+                [count, pVal](VSParameterDX9 * pParam) { return pParam->Impl_SetVectorArray(count, pVal); },
+                [count, pVal](IParameter * pParam) { return pParam->SetVectorArray(count, pVal); }
+            );
+        }
+
+        template<typename LocalFunc, typename ForeignFunc>
+        VoodooResult VSParameterDX9::Impl_Propagate(_In_ LocalFunc local, _In_ ForeignFunc foreign)
+        {
+            VoodooResult result = local(this);
+
+            if (m_Attached.empty()) return result;
+
+            if (m_TargetsGeneration != m_Binding->m_LinkGeneration)
             {
-                (*child)->SetFloat(val);
+                this->Impl_BuildTargets();
             }
 
-            if (m_Effect && m_Handle && FAILED(m_Effect->m_Handle->SetFloat(m_Handle, val)))
+            // Every dependent parameter is set directly, the graph has already been walked
+            ParameterTargetVector::iterator target = m_Targets.begin();
+            while (target != m_Targets.end())
             {
-                return VSFERR_APIERROR;
+                local(*target);
+                ++target;
             }
 
+            ParameterVector::iterator other = m_ForeignTargets.begin();
+            while (other != m_ForeignTargets.end())
+            {
+                foreign(other->get());
+                ++other;
+            }
+
+            return result;
+        }
+
+        void VSParameterDX9::Impl_BuildTargets()
+        {
+            m_Targets.clear();
+            m_ForeignTargets.clear();
+
+            ParameterTargetVector pending;
+            pending.push_back(this);
+
+            while (!pending.empty())
+            {
+                VSParameterDX9 * pNode = pending.back();
+                pending.pop_back();
+
+                ParameterList::iterator child = pNode->m_Attached.begin();
+                while (child != pNode->m_Attached.end())
+                {
+                    VSParameterDX9 * pChild = Impl_GetParameterDX9(child->get());
+                    if (!pChild)
+                    {
+                        // Parameters from other bindings propagate on their own
+                        if (std::find(m_ForeignTargets.begin(), m_ForeignTargets.end(), *child) == m_ForeignTargets.end())
+                        {
+                            m_ForeignTargets.push_back(*child);
+                        }
+                    }
+                    else if (pChild == this)
+                    {
+                        m_Core->GetLogger()->LogMessage(VSLog_PlugWarning, VOODOO_D3D9_NAME, 
+                            StringFormat("Parameter %1% is linked to itself through %2%, ignoring the link.") << m_Name << pNode->m_Name);
+                    }
+                    else if (std::find(m_Targets.begin(), m_Targets.end(), pChild) == m_Targets.end())
+                    {
+                        m_Targets.push_back(pChild);
+                        pending.push_back(pChild);
+                    }
+                    ++child;
+                }
+            }
+
+            m_TargetsGeneration = m_Binding->m_LinkGeneration;
+        }
+
+        bool VSParameterDX9::Impl_Reaches(_In_ VSParameterDX9 * pParam)
+        {
+            if (m_TargetsGeneration != m_Binding->m_LinkGeneration)
+            {
+                this->Impl_BuildTargets();
+            }
+
+            return std::find(m_Targets.begin(), m_Targets.end(), pParam) != m_Targets.end();
+        }
+
+        VSParameterDX9 * VSParameterDX9::Impl_GetParameterDX9(_In_ IParameter * pParam)
+        {
+            VSParameterDX9 * pOther = nullptr;
+            if (!pParam || FAILED(pParam->QueryInterface(CLSID_VSParameterDX9, (IObject**)&pOther)) || !pOther)
+            {
+                return nullptr;
+            }
+
+            // The caller holds the parameter, only the pointer is needed
+            pOther->Release();
+            return pOther;
+        }
+
+        VoodooResult VSParameterDX9::Impl_SetBool(_In_ CONST bool val)
+        {
+            if (m_Desc.Type != VSPT_Bool) return VSFERR_INVALIDCALL;
+
+            bool changed = (m_VBool != val);
+            m_VBool = val;
+            this->Impl_Update(changed);
+
             return VSF_OK;
         }
 
-        VOODOO_METHODDEF(VSParameterDX9::SetInt)(_In_ CONST int32_t val)
+        VoodooResult VSParameterDX9::Impl_SetFloat(_In_ CONST float val)
         {
-            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+            if (m_Desc.Type != VSPT_Float) return VSFERR_INVALIDCALL;
 
+            float * pFloats = this->Impl_Floats();
+            bool changed = (pFloats[0] != val);
+            pFloats[0] = val;
+            this->Impl_Update(changed);
+
+            return VSF_OK;
+        }
+
+        VoodooResult VSParameterDX9::Impl_SetInt(_In_ CONST int32_t val)
+        {
             if (m_Desc.Type != VSPT_Int) return VSFERR_INVALIDCALL;
 
+            bool changed = (m_VInt != val);
             m_VInt = val;
+            this->Impl_Update(changed);
 
-            ParameterList::iterator child = m_Attached.begin();
-            while (child != m_Attached.end())
+            return VSF_OK;
+        }
+
+        VoodooResult VSParameterDX9::Impl_SetMatrixArray(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4x4 * pVal)
+        {
+            if (m_Desc.Type != VSPT_Float) return VSFERR_INVALIDCALL;
+
+            // Linked parameters may be smaller, each takes as much as fits its own description
+            UINT rows = std::min<UINT>(std::max<UINT>(m_Desc.Rows, 1), 4);
+            UINT cols = std::min<UINT>(std::max<UINT>(m_Desc.Columns, 1), 4);
+            UINT elements = std::min<UINT>(std::min<UINT>(count, std::max<UINT>(m_Desc.Elements, 1)), m_FloatCount / (rows * cols));
+
+            float * pFloats = this->Impl_Floats();
+            bool changed = false;
+            for (UINT element = 0; element < elements; ++element)
             {
-                (*child)->SetInt(val);
+                for (UINT row = 0; row < rows; ++row)
+                {
+                    float * pRow = pFloats + (element * rows + row) * cols;
+                    if (memcmp(pRow, pVal[element].M[row], sizeof(float) * cols) != 0)
+                    {
+                        memcpy(pRow, pVal[element].M[row], sizeof(float) * cols);
+                        changed = true;
+                    }
+                }
             }
 
-            if (m_Effect && m_Handle && FAILED(m_Effect->m_Handle->SetInt(m_Handle, val)))
+            this->Impl_Update(changed);
+
+            return VSF_OK;
+        }
+
+        VoodooResult VSParameterDX9::Impl_SetRaw(_In_ CONST uint32_t offset, _In_ CONST uint32_t size, _In_reads_bytes_(size) CONST void * pData)
+        {
+            if (m_Desc.Type != VSPT_Float) return VSFERR_INVALIDCALL;
+
+            // Linked parameters may be smaller, each takes as much as fits its own components
+            uint32_t bytes = m_FloatCount * sizeof(float);
+            if (offset >= bytes) return VSF_OK;
+            uint32_t length = std::min<uint32_t>(size, bytes - offset);
+
+            uint8_t * pDest = reinterpret_cast<uint8_t *>(this->Impl_Floats()) + offset;
+            bool changed = (memcmp(pDest, pData, length) != 0);
+            if (changed)
             {
-                return VSFERR_APIERROR;
+                memcpy(pDest, pData, length);
             }
+            this->Impl_Update(changed);
 
             return VSF_OK;
         }
 
-        VOODOO_METHODDEF(VSParameterDX9::SetString)(_In_ CONST String & val)
+        VoodooResult VSParameterDX9::Impl_SetString(_In_ CONST String & val)
         {
-            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
-
             if (m_Desc.Type != VSPT_String) return VSFERR_INVALIDCALL;
 
+            bool changed = (m_VString != val);
             m_VString = val;
+            this->Impl_Update(changed);
+
+            return VSF_OK;
+        }
 
-            ParameterList::iterator child = m_Attached.begin();
-            while (child != m_Attached.end())
+        VoodooResult VSParameterDX9::Impl_SetTexture(_In_ ITexture * pVal)
+        {
+            if (m_Desc.Type < VSPT_Texture || m_Desc.Type > VSPT_TextureCube) return VSFERR_INVALIDCALL;
+
+            // The hardware texture is looked up once per texture; rebinding the same one reuses it.
+            bool changed = (pVal != m_Texture.get() || !m_TextureHandle);
+            if (changed)
             {
-                (*child)->SetString(val);
+                m_Texture = pVal;
+                m_TextureHandle = nullptr;
+
+                Variant propVar = CreateVariant();
+                if (pVal && SUCCEEDED(pVal->GetProperty(PropIds::D3D9Texture, &propVar)) && propVar.Type == VSUT_PVoid)
+                {
+                    m_TextureHandle = reinterpret_cast<LPDIRECT3DTEXTURE9>(propVar.VPVoid);
+                }
             }
 
-            if (m_Effect && m_Handle)
+            if (m_Effect && m_Handle && !m_TextureHandle)
             {
-                std::string vstr = val.ToStringA();
-                if (FAILED(m_Effect->m_Handle->SetString(m_Handle, vstr.c_str())))
+                m_Core->GetLogger()->LogMessage(VSLog_PlugError, VOODOO_D3D9_NAME, StringFormat("Unable to get hardware texture from texture %1%.") << pVal);
+                return VSFERR_INVALIDPARAMS;
+            }
+
+            this->Impl_Update(changed);
+
+            return VSF_OK;
+        }
+
+        VoodooResult VSParameterDX9::Impl_SetVector(_In_ CONST Float4 & val)
+        {
+            if (m_Desc.Type != VSPT_Float) return VSFERR_INVALIDCALL;
+
+            float * pFloats = this->Impl_Floats();
+            bool changed = (memcmp(pFloats, &val, sizeof(Float4)) != 0);
+            memcpy(pFloats, &val, sizeof(Float4));
+            this->Impl_Update(changed);
+
+            return VSF_OK;
+        }
+
+        VoodooResult VSParameterDX9::Impl_SetVectorArray(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4 * pVal)
+        {
+            if (m_Desc.Type != VSPT_Float || m_Desc.Rows > 1) return VSFERR_INVALIDCALL;
+
+            UINT width = std::min<UINT>(std::max<UINT>(m_Desc.Columns, 1), 4);
+            UINT elements = std::min<UINT>(std::min<UINT>(count, std::max<UINT>(m_Desc.Elements, 1)), m_FloatCount / width);
+
+            float * pFloats = this->Impl_Floats();
+            bool changed = false;
+            for (UINT element = 0; element < elements; ++element)
+            {
+                float * pElement = pFloats + element * width;
+                if (memcmp(pElement, &pVal[element].X, sizeof(float) * width) != 0)
                 {
-                    return VSFERR_APIERROR;
+                    memcpy(pElement, &pVal[element].X, sizeof(float) * width);
+                    changed = true;
                 }
             }
 
+            this->Impl_Update(changed);
+
             return VSF_OK;
         }
 
-        VOODOO_METHODDEF(VSParameterDX9::SetTexture)(_In_ ITexture * pVal)
+        void VSParameterDX9::Impl_Update(_In_ CONST bool changed)
         {
-            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+            if (!m_Effect || !m_Handle) return;
 
-            if (m_Desc.Type < VSPT_Texture || m_Desc.Type > VSPT_TextureCube) return VSFERR_INVALIDCALL;
+            ++m_Effect->m_ParameterSets;
+
+            // Queue the upload, once per flush however often the value changes
+            if (changed && !m_Dirty)
+            {
+                m_Dirty = true;
+                m_Effect->m_DirtyParameters.push_back(this);
+            }
+        }
+
+        float * VSParameterDX9::Impl_Floats() CONST
+        {
+            return m_VArray.empty() ? &m_VFloat.X : &m_VArray[0];
+        }
 
-            m_Texture = pVal;
+        void VSParameterDX9::Impl_FillRegisters(_In_ CONST ConstantSlot & slot, _Out_writes_(slot.Count * 4) float * pRegisters) CONST
+        {
+            ZeroMemory(pRegisters, sizeof(float) * 4 * slot.Count);
 
-            ParameterList::iterator child = m_Attached.begin();
-            while (child != m_Attached.end())
+            if (m_Desc.Type == VSPT_Bool)
+            {
+                pRegisters[0] = m_VBool ? 1.0f : 0.0f;
+                return;
+            }
+            else if (m_Desc.Type == VSPT_Int)
             {
-                (*child)->SetTexture(pVal);
+                pRegisters[0] = static_cast<float>(m_VInt);
+                return;
             }
 
-            if (m_Effect && m_Handle)
+            // The cache holds each element row after row, the shader may read it a row or a column per register
+            UINT rows = std::max<UINT>(m_Desc.Rows, 1);
+            UINT cols = std::max<UINT>(m_Desc.Columns, 1);
+            UINT lines = slot.ByColumn ? cols : rows;
+            UINT width = std::min<UINT>(slot.ByColumn ? rows : cols, 4);
+
+            CONST float * pFloats = this->Impl_Floats();
+            for (UINT reg = 0; reg < slot.Count; ++reg)
             {
-                Variant propVar = CreateVariant();
-                if (FAILED(pVal->GetProperty(PropIds::D3D9Texture, &propVar)))
+                UINT element = reg / lines;
+                UINT line = reg % lines;
+                for (UINT component = 0; component < width; ++component)
                 {
-                    m_Core->GetLogger()->LogMessage(VSLog_PlugError, VOODOO_D3D9_NAME, StringFormat("Unable to get hardware texture from texture %1%.") << pVal);
-                    return VSFERR_INVALIDPARAMS;
+                    UINT row = slot.ByColumn ? component : line;
+                    UINT col = slot.ByColumn ? line : component;
+                    UINT index = (element * rows + row) * cols + col;
+                    if (index < m_FloatCount)
+                    {
+                        pRegisters[reg * 4 + component] = pFloats[index];
+                    }
                 }
+            }
+        }
 
-                LPDIRECT3DTEXTURE9 pDXTexture = reinterpret_cast<LPDIRECT3DTEXTURE9>(propVar.VPVoid);
+        bool VSParameterDX9::Impl_Upload()
+        {
+            m_Dirty = false;
 
-                HRESULT hr = m_Effect->m_Handle->SetTexture(m_Handle, pDXTexture);
+            HRESULT hr = D3DERR_INVALIDCALL;
+            switch (m_Desc.Type)
+            {
+            case VSPT_Bool:
+                hr = m_Effect->m_Handle->SetBool(m_Handle, m_VBool);
+                break;
+            case VSPT_Int:
+                hr = m_Effect->m_Handle->SetInt(m_Handle, m_VInt);
+                break;
+            case VSPT_Float:
+                // Packed values reach the shaders only through the pass constant blocks
+                hr = m_Packed ? D3D_OK : m_Effect->m_Handle->SetFloatArray(m_Handle, this->Impl_Floats(), m_FloatCount);
+                break;
+            case VSPT_String:
+                hr = m_Effect->m_Handle->SetString(m_Handle, m_VString.ToStringA().c_str());
+                break;
+            case VSPT_Texture:
+            case VSPT_Texture1D:
+            case VSPT_Texture2D:
+            case VSPT_Texture3D:
+            case VSPT_TextureCube:
+                hr = m_Effect->m_Handle->SetTexture(m_Handle, m_TextureHandle);
+                break;
+            }
 
-                if (FAILED(hr))
+            // Blocks mirror every register of their stage, so a value the effect took is restored rather than written
+            std::vector<ConstantSlot>::iterator slot = m_Slots.begin();
+            while (slot != m_Slots.end())
+            {
+                this->Impl_FillRegisters(*slot, &m_Registers[0]);
+                if (m_Packed || FAILED(hr))
                 {
-                    m_Core->GetLogger()->LogMessage(VSLog_PlugError, VOODOO_D3D9_NAME, StringFormat("Unable to bind texture %1% to parameter %2%.") << pVal << this);
-                    return VSFERR_INVALIDCALL;
+                    slot->pBlock->Write(slot->Register, &m_Registers[0], slot->Count);
                 }
-
-                m_Core->GetLogger()->LogMessage(VSLog_PlugDebug, VOODOO_D3D9_NAME, StringFormat("Bound texture %1% to parameter %2%.") << pVal << this);
+                else
+                {
+                    slot->pBlock->Restore(slot->Register, &m_Registers[0], slot->Count);
+                }
+                ++slot;
             }
 
-            return VSF_OK;
+            return SUCCEEDED(hr);
         }
 
-        VOODOO_METHODDEF(VSParameterDX9::SetVector)(_In_ CONST Float4 val)
+        void VSParameterDX9::Impl_Pack()
         {
-            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+            if (!m_Packable || m_Slots.empty()) return;
 
-            if (m_Desc.Type != VSPT_Float) return VSFERR_INVALIDCALL;
+            // A technique reading the value anywhere but its pass shaders (such as in a state) still needs the effect to
+            // hold it
+            TechniqueVector::iterator technique = m_Effect->m_Techniques.begin();
+            while (technique != m_Effect->m_Techniques.end())
+            {
+                // Effect techniques are always created by the effect, so are always ours
+                VSTechniqueDX9 * pTechnique = static_cast<VSTechniqueDX9 *>(technique->get());
+                ++technique;
 
-            m_VFloat = val;
+                if (!m_Effect->m_Handle->IsParameterUsed(m_Handle, pTechnique->m_Handle)) continue;
 
-            ParameterList::iterator child = m_Attached.begin();
-            while (child != m_Attached.end())
-            {
-                (*child)->SetVector(val);
+                bool packed = false;
+                std::vector<ConstantSlot>::iterator slot = m_Slots.begin();
+                while (slot != m_Slots.end() && !packed)
+                {
+                    packed = (slot->pPass->GetTechnique() == pTechnique);
+                    ++slot;
+                }
+
+                if (!packed) return;
             }
 
-            if (m_Effect && m_Handle)
+            m_Packed = true;
+        }
+
+        void VSParameterDX9::Impl_Unpack(_In_opt_ CONST VSPassDX9 * pPass)
+        {
+            if (!pPass)
             {
-                D3DXVECTOR4 sv;
-                sv.x = val.X;
-                sv.y = val.Y;
-                sv.z = val.Z;
-                sv.w = val.W;
+                m_Slots.clear();
+                m_Packed = false;
+                return;
+            }
 
-                if (FAILED(m_Effect->m_Handle->SetVector(m_Handle, &sv)))
+            size_t count = m_Slots.size();
+            std::vector<ConstantSlot>::iterator slot = m_Slots.begin();
+            while (slot != m_Slots.end())
+            {
+                if (slot->pPass == pPass)
                 {
-                    return VSFERR_APIERROR;
+                    slot = m_Slots.erase(slot);
+                }
+                else
+                {
+                    ++slot;
                 }
             }
 
-            return VSF_OK;
+            // The effect has only held the link-time value, give it the current one on the next flush
+            if (m_Packed && m_Slots.size() != count)
+            {
+                m_Packed = false;
+                this->Impl_Update(true);
+            }
         }
 
         bool VOODOO_METHODTYPE VSParameterDX9::IsVirtual() CONST
@@ -538,12 +997,22 @@ namespace VoodooShader
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
-            if (!pParam)
+            if (!pParam || pParam == this)
             {
                 return VSFERR_INVALIDPARAMS;
             }
 
+            // Refuse links that would feed a parameter back into itself
+            VSParameterDX9 * pOther = Impl_GetParameterDX9(pParam);
+            if (pOther && pOther->Impl_Reaches(this))
+            {
+                m_Core->GetLogger()->LogMessage(VSLog_PlugWarning, VOODOO_D3D9_NAME, 
+                    StringFormat("Unable to attach parameter %1% to %2%, it would create a cycle.") << pOther->m_Name << m_Name);
+                return VSFERR_INVALIDPARAMS;
+            }
+
             m_Attached.push_back(pParam);
+            ++m_Binding->m_LinkGeneration;
 
             return VSF_OK;
         }
@@ -552,10 +1021,8 @@ namespace VoodooShader
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
-            std::remove_if(m_Attached.begin(), m_Attached.end(), 
-				[&pParam](ParameterRef param){
-				return param.get() == pParam;
-			});
+            m_Attached.remove_if([pParam](CONST ParameterRef & param) { return param.get() == pParam; });
+            ++m_Binding->m_LinkGeneration;
 
             return VSF_OK;
         }
@@ -578,6 +1045,7 @@ namespace VoodooShader
                     LPCSTR texName = nullptr;
                     if (SUCCEEDED(m_Effect->m_Handle->GetString(texAnnot, &texName)) && texName)
                     {
+                        // Annotations only give the name, and this runs once per effect load, so look it up by name
                         m_Texture = m_Core->GetTexture(texName);
 
                         if (!m_Texture)
@@ -598,6 +1066,23 @@ namespace VoodooShader
                 }
             }
 
+            // Handle expressions, evaluated by the core each frame
+            D3DXHANDLE exprAnnot = m_Effect->m_Handle->GetAnnotationByName(m_Handle, "vs_expression");
+            if (exprAnnot)
+            {
+                LPCSTR exprText = nullptr;
+                if (SUCCEEDED(m_Effect->m_Handle->GetString(exprAnnot, &exprText)) && exprText)
+                {
+                    m_Expression = SUCCEEDED(m_Core->SetExpression(this, exprText));
+                    m_Packable = m_Expression && (m_Desc.Type == VSPT_Float);
+                }
+                else
+                {
+                    m_Core->GetLogger()->LogMessage(VSLog_PlugWarning, VOODOO_D3D9_NAME, 
+                        StringFormat("Unable to get expression annotation for parameter %1%.") << m_Name);
+                }
+            }
+
             // Handle linkage
             D3DXHANDLE sourceAnnot = m_Effect->m_Handle->GetAnnotationByName(m_Handle, "vs_source");
             if (sourceAnnot)
@@ -605,10 +1090,11 @@ namespace VoodooShader
                 LPCSTR sourceName = NULL;
                 if (SUCCEEDED(m_Effect->m_Handle->GetString(sourceAnnot, &sourceName)) && sourceName)
                 {
+                    // Looked up by name once, the link then holds the parameter itself
                     IParameter * sourceParam = m_Core->GetParameter(sourceName, m_Desc);
-                    if (sourceParam)
+                    if (sourceParam && SUCCEEDED(sourceParam->AttachParameter(this)))
                     {
-                        sourceParam->AttachParameter(this);
+                        m_Packable = (m_Desc.Type == VSPT_Float);
                     }
                 }
                 else
@@ -662,7 +1148,7 @@ namespace VoodooShader
                     return nullptr;
                 }
 
-                ITexture * pSrcTex = m_Core->LoadTexture(nameStr, pFile);
+                ITexture * pSrcTex = m_Core->LoadTexture(nameStr, pFile, nullptr);
                 if (!pSrcTex)
                 {
                     m_Core->GetLogger()->LogMessage(VSLog_PlugWarning, VOODOO_D3D9_NAME, 
@@ -721,7 +1207,7 @@ namespace VoodooShader
                 m_Core->GetLogger()->LogMessage(VSLog_PlugInfo, VOODOO_D3D9_NAME, 
                     StringFormat("Creating texture %1% as %2% for parameter %3%.") << nameStr << desc << m_Name);
 
-                ITexture * pTex = m_Core->CreateTexture(nameStr, desc);
+                ITexture * pTex = m_Core->CreateTexture(nameStr, desc, nullptr);
                 if (!pTex)
                 {
                     m_Core->GetLogger()->LogMessage(VSLog_PlugWarning, VOODOO_D3D9_NAME, 
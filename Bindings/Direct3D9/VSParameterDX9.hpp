@@ -20,16 +20,32 @@
 #pragma once
 
 #include "Voodoo_D3D9.hpp"
+#include "ConstantBlockDX9.hpp"
 
 namespace VoodooShader
 {
     namespace Voodoo_D3D9
     {
+        /**
+         * Registers a parameter occupies in one stage of a pass.
+         */
+        struct ConstantSlot
+        {
+            ConstantBlock * pBlock;
+            VSPassDX9 * pPass;
+            uint32_t Register;
+            uint32_t Count;
+            /** Set when the shader stores the matrix by columns, one register per column. */
+            bool ByColumn;
+        };
+
         /**
          * @clsid e6f312a1-05af-11e1-9e05-005056c00008
          */
         VOODOO_CLASS(VSParameterDX9, IParameter, ({0xA1, 0x12, 0xF3, 0xE6, 0xAF, 0x05, 0xE1, 0x11, 0x9E, 0x05, 0x00, 0x50, 0x56, 0xC0, 0x00, 0x08}))
         {
+            friend class VSPassDX9;
+
         public:
             VSParameterDX9(_In_ VSEffectDX9 * pEffect, _In_ D3DXHANDLE pParamHandle);
             VSParameterDX9(_In_ VSBindingDX9 * pBinding, _In_ CONST String & name, _In_ ParameterDesc desc);
@@ -50,15 +66,21 @@ namespace VoodooShader
             VOODOO_METHOD(GetBool)(_Out_ bool * pVal) CONST;
             VOODOO_METHOD(GetFloat)(_Out_ float * pVal) CONST;
             VOODOO_METHOD(GetInt)(_Out_ int32_t * pVal) CONST;
+            VOODOO_METHOD(GetMatrix)(_Out_ Float4x4 * pVal) CONST;
             VOODOO_METHOD(GetString)(_Out_ String * pVal) CONST;
             VOODOO_METHOD(GetTexture)(_Out_ ITexture ** pVal) CONST;
             VOODOO_METHOD(GetVector)(_Out_ Float4 * pVal) CONST;
             VOODOO_METHOD(SetBool)(_In_ CONST bool val);
             VOODOO_METHOD(SetFloat)(_In_ CONST float val);
+            VOODOO_METHOD(SetFloatArray)(_In_ CONST uint32_t count, _In_reads_(count) CONST float * pVal);
             VOODOO_METHOD(SetInt)(_In_ CONST int32_t val);
+            VOODOO_METHOD(SetMatrix)(_In_ CONST Float4x4 & val);
+            VOODOO_METHOD(SetMatrixArray)(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4x4 * pVal);
+            VOODOO_METHOD(SetRaw)(_In_ CONST uint32_t offset, _In_ CONST uint32_t size, _In_reads_bytes_(size) CONST void * pData);
             VOODOO_METHOD(SetString)(_In_ CONST String & val);
             VOODOO_METHOD(SetTexture)(_In_ ITexture * pVal);
             VOODOO_METHOD(SetVector)(_In_ CONST Float4 val);
+            VOODOO_METHOD(SetVectorArray)(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4 * pVal);
         
             VOODOO_METHOD_(bool, IsVirtual)() CONST;
             VOODOO_METHOD(AttachParameter)(_In_ IParameter * pParam);
@@ -69,26 +91,102 @@ namespace VoodooShader
             VOODOO_METHOD_(void, Link)();
             VOODOO_METHOD_(ITexture *, LinkNewTexture)();
 
+            /**
+             * Uploads the cached value to the effect. Called by the effect when flushing changed parameters.
+             */
+            bool Impl_Upload();
+            /**
+             * Stops uploading through the effect when every technique reading the parameter does so from packed
+             * registers. Called by the effect once its passes have been linked.
+             */
+            void Impl_Pack();
+            /**
+             * Drops the slots held in the blocks of a pass, or of every pass if null. Called as passes and the effect are
+             * destroyed.
+             */
+            void Impl_Unpack(_In_opt_ CONST VSPassDX9 * pPass);
+
         private:
+            typedef std::vector<VSParameterDX9 *> ParameterTargetVector;
+
+            /**
+             * Sets this parameter and every parameter linked below it, through the flattened targets.
+             */
+            template<typename LocalFunc, typename ForeignFunc>
+            VoodooResult Impl_Propagate(_In_ LocalFunc local, _In_ ForeignFunc foreign);
+            /**
+             * Flattens the parameters linked below this one into m_Targets, each appearing once. Links back to this
+             * parameter are skipped, so a cycle cannot recurse.
+             */
+            void Impl_BuildTargets();
+            bool Impl_Reaches(_In_ VSParameterDX9 * pParam);
+            static VSParameterDX9 * Impl_GetParameterDX9(_In_ IParameter * pParam);
+
+            VoodooResult Impl_SetBool(_In_ CONST bool val);
+            VoodooResult Impl_SetFloat(_In_ CONST float val);
+            VoodooResult Impl_SetInt(_In_ CONST int32_t val);
+            VoodooResult Impl_SetMatrixArray(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4x4 * pVal);
+            VoodooResult Impl_SetRaw(_In_ CONST uint32_t offset, _In_ CONST uint32_t size, _In_reads_bytes_(size) CONST void * pData);
+            VoodooResult Impl_SetString(_In_ CONST String & val);
+            VoodooResult Impl_SetTexture(_In_ ITexture * pVal);
+            VoodooResult Impl_SetVector(_In_ CONST Float4 & val);
+            VoodooResult Impl_SetVectorArray(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4 * pVal);
+            void Impl_Update(_In_ CONST bool changed);
+            /**
+             * Lays the cached value out in registers as the shader reads it, four components per register.
+             */
+            void Impl_FillRegisters(_In_ CONST ConstantSlot & slot, _Out_writes_(slot.Count * 4) float * pRegisters) CONST;
+            /**
+             * Retrieves the cached float components, m_FloatCount of them and never fewer than 4.
+             */
+            float * Impl_Floats() CONST;
+
             mutable uint32_t m_Refs;
             ICore * m_Core;
             String m_Name;
 
             VSEffectDX9 * m_Effect;
             VSBindingDX9 * m_Binding;
-            PropertyMap m_Properties;
+            PropertyStore m_Properties;
 
             ParameterDesc m_Desc;
             ParameterList m_Attached;
+            /** Every parameter linked below this one, rebuilt when the binding's link generation changes. */
+            ParameterTargetVector m_Targets;
+            ParameterVector m_ForeignTargets;
+            uint32_t m_TargetsGeneration;
 
             D3DXHANDLE m_Handle;
+            /** Set when the cached value has changed and is waiting in the effect's dirty list. */
+            bool m_Dirty;
+            /** Float components uploaded, covering every element of arrays and matrices. */
+            UINT m_FloatCount;
+            /** Set for parameters driven by a framework source, which passes may upload from their constant blocks. */
+            bool m_Packable;
+            /**
+             * Set when the value only reaches the shaders through the constant blocks. The effect keeps the link-time
+             * value, so getters return the cache.
+             */
+            bool m_Packed;
+            /** Registers this parameter occupies in pass constant blocks. */
+            std::vector<ConstantSlot> m_Slots;
+            /** Scratch space for laying the value out in registers, sized for the largest slot. */
+            std::vector<float> m_Registers;
+            /** Set when driven by a <code>vs_expression</code> annotation, which is cleared when destroyed. */
+            bool m_Expression;
 
             // Value cache types
             mutable bool m_VBool;
             mutable Float4 m_VFloat;
+            /** Float cache for parameters larger than a vector, used instead of m_VFloat when not empty. */
+            mutable std::vector<float> m_VArray;
             mutable int32_t m_VInt;
             mutable String m_VString;
             TextureRef m_Texture;
+            /** Hardware texture of m_Texture, owned by it and resolved when the texture changes. */
+            LPDIRECT3DTEXTURE9 m_TextureHandle;
+
+            VOODOO_DECLARE_POOLED();
         };
     }
 }
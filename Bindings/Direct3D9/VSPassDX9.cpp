@@ -22,6 +22,7 @@
 // Voodoo D3D9
 #include "VSTechniqueDX9.hpp"
 #include "VSEffectDX9.hpp"
+#include "VSParameterDX9.hpp"
 #include "VSBindingDX9.hpp"
 #include "D3D9_Version.hpp"
 
@@ -31,6 +32,27 @@ namespace VoodooShader
     {
         #define VOODOO_DEBUG_TYPE VSPassDX9
         DeclareDebugCache();
+        VOODOO_DEFINE_POOLED(VSPassDX9, 32);
+
+        struct VertexConstantSink
+        {
+            LPDIRECT3DDEVICE9 pDevice;
+
+            void operator()(_In_ UINT start, _In_reads_(count * 4) CONST float * pData, _In_ UINT count) CONST
+            {
+                pDevice->SetVertexShaderConstantF(start, pData, count);
+            }
+        };
+
+        struct PixelConstantSink
+        {
+            LPDIRECT3DDEVICE9 pDevice;
+
+            void operator()(_In_ UINT start, _In_reads_(count * 4) CONST float * pData, _In_ UINT count) CONST
+            {
+                pDevice->SetPixelShaderConstantF(start, pData, count);
+            }
+        };
 
         VSPassDX9::VSPassDX9(_In_ VSTechniqueDX9 * pTechnique, UINT passId) :
             m_Refs(0), m_Technique(pTechnique),  m_PassId(passId)
@@ -41,68 +63,182 @@ namespace VoodooShader
             } 
 
             m_Core = m_Technique->GetCore();
+            m_Properties.Set<VSPropSlot_D3DX9PassId>(CreateVariant(uint32_t(m_PassId)));
+
+            this->Impl_LinkConstants();
 
             AddThisToDebugCache();
         }
 
         VSPassDX9::~VSPassDX9()
         {
+            std::vector<boost::intrusive_ptr<VSParameterDX9>>::iterator param = m_LinkedParameters.begin();
+            while (param != m_LinkedParameters.end())
+            {
+                (*param)->Impl_Unpack(this);
+                ++param;
+            }
+            m_LinkedParameters.clear();
+
             RemoveThisFromDebugCache();
         }
 
-        uint32_t VOODOO_METHODTYPE VSPassDX9::AddRef() CONST
+        void VSPassDX9::Impl_LinkConstants()
         {
-            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+            VSEffectDX9 * pEffect = m_Technique->m_Effect;
 
-            return SAFE_INCREMENT(m_Refs);
+            D3DXHANDLE passHandle = pEffect->m_Handle->GetPass(m_Technique->m_Handle, m_PassId);
+            D3DXPASS_DESC desc;
+            ZeroMemory(&desc, sizeof(D3DXPASS_DESC));
+            if (!passHandle || FAILED(pEffect->m_Handle->GetPassDesc(passHandle, &desc)))
+            {
+                return;
+            }
+
+            m_Name = desc.Name;
+
+            this->Impl_LinkStage(desc.pVertexShaderFunction, m_VertexConstants);
+            this->Impl_LinkStage(desc.pPixelShaderFunction, m_PixelConstants);
         }
 
-        uint32_t VOODOO_METHODTYPE VSPassDX9::Release() CONST
+        void VSPassDX9::Impl_LinkStage(_In_opt_ CONST DWORD * pFunction, _Inout_ ConstantBlock & block)
         {
-            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+            if (!pFunction) return;
 
-            if (SAFE_DECREMENT(m_Refs) == 0)
+            LPD3DXCONSTANTTABLE pTable = nullptr;
+            if (FAILED(D3DXGetShaderConstantTable(pFunction, &pTable)) || !pTable)
             {
-                delete this;
-                return 0;
+                return;
             }
-            else
+
+            D3DXCONSTANTTABLE_DESC tableDesc;
+            ZeroMemory(&tableDesc, sizeof(D3DXCONSTANTTABLE_DESC));
+            if (FAILED(pTable->GetDesc(&tableDesc)))
             {
-                return m_Refs;
+                pTable->Release();
+                return;
             }
-        }
 
-        VoodooResult VOODOO_METHODTYPE VSPassDX9::QueryInterface(_In_ CONST Uuid refid, _Outptr_result_maybenull_ IObject ** ppOut)
-        {
-            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+            VSEffectDX9 * pEffect = m_Technique->m_Effect;
+            std::vector<std::pair<VSParameterDX9 *, ConstantSlot>> slots;
+            uint32_t packed = 0;
+            bool mirrored = true;
 
-            if (!ppOut)
+            // The block is uploaded as one range, so it must mirror every float register the shader reads
+            for (UINT index = 0; index < tableDesc.Constants; ++index)
             {
-                return VSFERR_INVALIDPARAMS;
-            }
-            else
-            {
-                if (refid == IID_IObject)
+                D3DXHANDLE constant = pTable->GetConstant(NULL, index);
+                D3DXCONSTANT_DESC constDesc;
+                UINT constCount = 1;
+                if (!constant || FAILED(pTable->GetConstantDesc(constant, &constDesc, &constCount)))
+                {
+                    mirrored = false;
+                    break;
+                }
+
+                if (constDesc.RegisterSet != D3DXRS_FLOAT4) continue;
+
+                D3DXHANDLE paramHandle = pEffect->m_Handle->GetParameterByName(NULL, constDesc.Name);
+                VSParameterDX9 * pParam = nullptr;
+                ParameterVector::iterator iter = pEffect->m_Parameters.begin();
+                while (iter != pEffect->m_Parameters.end() && paramHandle)
                 {
-                    *ppOut = static_cast<IObject*>(this);
+                    // Effect parameters are always created by the effect, so are always ours
+                    VSParameterDX9 * pCandidate = static_cast<VSParameterDX9 *>(iter->get());
+                    if (pCandidate->m_Handle == paramHandle)
+                    {
+                        pParam = pCandidate;
+                        break;
+                    }
+                    ++iter;
                 }
-                else if (refid == IID_IPass)
+
+                // The cache holds a single int or bool, and nothing for structs
+                if (!pParam || constDesc.Class == D3DXPC_STRUCT || constDesc.Class == D3DXPC_OBJECT ||
+                    (pParam->m_Desc.Type != VSPT_Float && constDesc.RegisterCount > 1) ||
+                    (pParam->m_Desc.Type != VSPT_Float && pParam->m_Desc.Type != VSPT_Int && pParam->m_Desc.Type != VSPT_Bool))
                 {
-                    *ppOut = static_cast<IPass*>(this);
+                    mirrored = false;
+                    break;
                 }
-                else if (refid == CLSID_VSPassDX9)
+
+                ConstantSlot slot = {&block, this, constDesc.RegisterIndex, constDesc.RegisterCount, constDesc.Class == D3DXPC_MATRIX_COLUMNS};
+                slots.push_back(std::make_pair(pParam, slot));
+
+                if (pParam->m_Packable) ++packed;
+            }
+
+            pTable->Release();
+
+            if (!mirrored)
+            {
+                m_Core->GetLogger()->LogMessage(VSLog_PlugDebug, VOODOO_D3D9_NAME, 
+                    StringFormat("Pass %1% reads registers that cannot be mirrored, its parameters are not packed.") << m_Name);
+                return;
+            }
+            else if (packed == 0)
+            {
+                return;
+            }
+
+            std::vector<std::pair<VSParameterDX9 *, ConstantSlot>>::iterator entry = slots.begin();
+            while (entry != slots.end())
+            {
+                VSParameterDX9 * pParam = entry->first;
+                CONST ConstantSlot & slot = entry->second;
+
+                if (pParam->m_Registers.size() < slot.Count * 4)
                 {
-                    *ppOut = static_cast<VSPassDX9*>(this);
+                    pParam->m_Registers.resize(slot.Count * 4);
                 }
-                else
+                pParam->Impl_FillRegisters(slot, &pParam->m_Registers[0]);
+                block.Add(slot.Register, slot.Count, &pParam->m_Registers[0]);
+
+                pParam->m_Slots.push_back(slot);
+                if (std::find(m_LinkedParameters.begin(), m_LinkedParameters.end(), pParam) == m_LinkedParameters.end())
                 {
-                    *ppOut = nullptr;
-                    return VSFERR_INVALIDUUID;
+                    m_LinkedParameters.push_back(pParam);
                 }
+                ++entry;
+            }
 
-                (*ppOut)->AddRef();
-                return VSF_OK;
+            m_Core->GetLogger()->LogMessage(VSLog_PlugDebug, VOODOO_D3D9_NAME, 
+                StringFormat("Packed %1% parameters into constant registers for pass %2%.") << packed << m_Name);
+        }
+
+        uint32_t VOODOO_METHODTYPE VSPassDX9::AddRef() CONST
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            return SAFE_INCREMENT(m_Refs);
+        }
+
+        uint32_t VOODOO_METHODTYPE VSPassDX9::Release() CONST
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            uint32_t count = SAFE_DECREMENT(m_Refs);
+            if (count == 0)
+            {
+                delete this;
             }
+            return count;
+        }
+
+        VoodooResult VOODOO_METHODTYPE VSPassDX9::QueryInterface(_In_ CONST Uuid refid, _Outptr_result_maybenull_ IObject ** ppOut)
+        {
+            VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
+
+            static CONST InterfaceMapEntry map[] =
+            {
+                VOODOO_INTERFACE_ENTRY(VSPassDX9, IObject),
+                VOODOO_INTERFACE_ENTRY(VSPassDX9, IPass),
+                VOODOO_CLASS_ENTRY(VSPassDX9),
+                VOODOO_INTERFACE_MAP_END
+            };
+            static volatile LONG hint = 0;
+
+            return QueryInterfaceMap(this, map, &hint, refid, ppOut);
         }
 
         String VOODOO_METHODTYPE VSPassDX9::ToString() CONST
@@ -130,27 +266,14 @@ namespace VoodooShader
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
-            if (!pValue) VSFERR_INVALIDPARAMS;
+            if (!pValue) return VSFERR_INVALIDPARAMS;
 
-            if (propid == PropIds::D3DX9PassId)
+            if (m_Properties.Get(propid, pValue))
             {
-                (*pValue) = CreateVariant(uint32_t(m_PassId));
                 return VSF_OK;
             }
-            else
-            {
-                PropertyMap::const_iterator property = m_Properties.find(propid);
-                if (property != m_Properties.end())
-                {
-                    CopyMemory(pValue, &property->second, sizeof(Variant));
-                    return VSF_OK;
-                }
-				else
-				{
-					*pValue = CreateVariant();
-				}
-            }
 
+            *pValue = CreateVariant();
             return VSFERR_INVALIDCALL;
         }
 
@@ -158,12 +281,15 @@ namespace VoodooShader
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
-            if (propid == PropIds::D3DX9Handle || propid == PropIds::D3DX9Effect || propid == PropIds::D3DX9PassId)
+            if (!pValue) return VSFERR_INVALIDPARAMS;
+
+            // Well-known properties are read-only, they hold the hardware handles.
+            if (PropertyStore::FindSlot(propid) != VSPropSlot_Spill)
             {
                 return VSFERR_INVALIDPARAMS;
             }
 
-            m_Properties[propid] = (*pValue);
+            m_Properties.Set(propid, *pValue);
             return VSF_OK;
         }
 
@@ -181,8 +307,17 @@ namespace VoodooShader
                 return VSFERR_INVALIDCALL;
             }
 
+            effect->Impl_FlushParameters();
+
             if (SUCCEEDED(effect->m_Handle->BeginPass(m_PassId)))
             {
+                // Beginning the pass restores the effect's values, packed registers are then written over them in one range
+                LPDIRECT3DDEVICE9 pDevice = effect->m_Binding->m_Device;
+                VertexConstantSink vertexSink = {pDevice};
+                PixelConstantSink pixelSink = {pDevice};
+                m_VertexConstants.Flush(vertexSink);
+                m_PixelConstants.Flush(pixelSink);
+
                 effect->m_Binding->m_BoundPass = this;
                 return VSF_OK;
             }
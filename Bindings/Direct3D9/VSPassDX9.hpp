@@ -20,6 +20,7 @@
 #pragma once
 
 #include "Voodoo_D3D9.hpp"
+#include "ConstantBlockDX9.hpp"
 
 namespace VoodooShader
 {
@@ -53,16 +54,34 @@ namespace VoodooShader
             VOODOO_METHOD_(ITechnique *, GetTechnique)() CONST;
 
         private:
+            /**
+             * Reflects the register assignments of the pass shaders, packing framework-driven parameters into the
+             * constant blocks.
+             */
+            void Impl_LinkConstants();
+            /**
+             * Adds every float register the shader reads to the block, if any of them is framework-driven and all of them
+             * can be laid out from parameter caches.
+             */
+            void Impl_LinkStage(_In_opt_ CONST DWORD * pFunction, _Inout_ ConstantBlock & block);
+
             mutable uint32_t m_Refs;
             ICore * m_Core;
             String m_Name;
 
             VSTechniqueDX9 * m_Technique;
-            PropertyMap m_Properties;
+            PropertyStore m_Properties;
 
             TextureRef m_Targets[4];
 
             UINT m_PassId;
+
+            ConstantBlock m_VertexConstants;
+            ConstantBlock m_PixelConstants;
+            /** Parameters with slots in the blocks, which drop them when the pass is destroyed. */
+            std::vector<boost::intrusive_ptr<VSParameterDX9>> m_LinkedParameters;
+
+            VOODOO_DECLARE_POOLED();
         };
     }
 }
@@ -29,6 +29,7 @@ namespace VoodooShader
     {
         #define VOODOO_DEBUG_TYPE VSTechniqueDX9
         DeclareDebugCache();
+        VOODOO_DEFINE_POOLED(VSTechniqueDX9, 16);
 
         VSTechniqueDX9::VSTechniqueDX9(_In_ VSEffectDX9 * pEffect, _In_ D3DXHANDLE pTechHandle) :
             m_Refs(0), m_Effect(pEffect), m_Handle(pTechHandle)
@@ -45,6 +46,8 @@ namespace VoodooShader
                 Throw(VOODOO_D3D9_NAME, VSTR("Unable to create technique with no hardware handle."), nullptr);
             }
 
+            m_Properties.Set<VSPropSlot_D3DX9Handle>(CreateVariant(m_Handle));
+
             D3DXTECHNIQUE_DESC desc;
             ZeroMemory(&desc, sizeof(D3DXTECHNIQUE_DESC));
             if (FAILED(m_Effect->m_Handle->GetTechniqueDesc(m_Handle, &desc)))
@@ -59,6 +62,7 @@ namespace VoodooShader
                 Throw(VOODOO_D3D9_NAME, VSTR("Unable to validate technique."), m_Core);
             }
 
+            m_Passes.reserve(desc.Passes);
             for (UINT passIndex = 0; passIndex < desc.Passes; ++passIndex)
             {
                 D3DXHANDLE passHandle = m_Effect->m_Handle->GetPass(m_Handle, passIndex);
@@ -85,6 +89,7 @@ namespace VoodooShader
                         break;
                     }
 
+                    // Resolved by name when the technique is created, the pass then holds the texture
                     pass->SetTarget(targetIndex, m_Core->GetTexture(annotationValue));
 
                     ++targetIndex;
@@ -110,47 +115,28 @@ namespace VoodooShader
         uint32_t VOODOO_METHODTYPE VSTechniqueDX9::Release() CONST
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
-            if (SAFE_DECREMENT(m_Refs) == 0)
+            uint32_t count = SAFE_DECREMENT(m_Refs);
+            if (count == 0)
             {
                 delete this;
-                return 0;
-            }
-            else
-            {
-                return m_Refs;
             }
+            return count;
         }
 
         VoodooResult VOODOO_METHODTYPE VSTechniqueDX9::QueryInterface(_In_ CONST Uuid refid, _Outptr_result_maybenull_ IObject ** ppOut)
         {
             VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
-            if (!ppOut)
-            {
-                return VSFERR_INVALIDPARAMS;
-            }
-            else
-            {
-                if (refid == IID_IObject)
-                {
-                    *ppOut = static_cast<IObject*>(this);
-                }
-                else if (refid == IID_ITechnique)
-                {
-                    *ppOut = static_cast<ITechnique*>(this);
-                }
-                else if (refid == CLSID_VSTechniqueDX9)
-                {
-                    *ppOut = static_cast<VSTechniqueDX9*>(this);
-                }
-                else
-                {
-                    *ppOut = nullptr;
-                    return VSFERR_INVALIDUUID;
-                }
 
-                (*ppOut)->AddRef();
-                return VSF_OK;
-            }
+            static CONST InterfaceMapEntry map[] =
+            {
+                VOODOO_INTERFACE_ENTRY(VSTechniqueDX9, IObject),
+                VOODOO_INTERFACE_ENTRY(VSTechniqueDX9, ITechnique),
+                VOODOO_CLASS_ENTRY(VSTechniqueDX9),
+                VOODOO_INTERFACE_MAP_END
+            };
+            static volatile LONG hint = 0;
+
+            return QueryInterfaceMap(this, map, &hint, refid, ppOut);
         }
 
         String VOODOO_METHODTYPE VSTechniqueDX9::ToString() CONST
@@ -173,39 +159,28 @@ namespace VoodooShader
 
         VoodooResult VOODOO_METHODTYPE VSTechniqueDX9::GetProperty(_In_ CONST Uuid propid, _Out_ Variant * pValue) CONST
         {
-            if (!pValue) VSFERR_INVALIDPARAMS;
+            if (!pValue) return VSFERR_INVALIDPARAMS;
 
-            if (propid == PropIds::D3DX9Handle)
+            if (m_Properties.Get(propid, pValue))
             {
-                pValue->Type = VSUT_PVoid;
-                pValue->VPVoid = (PVOID)m_Handle;
                 return VSF_OK;
             }
-            else
-            {
-                PropertyMap::const_iterator property = m_Properties.find(propid);
-                if (property != m_Properties.end())
-                {
-                    CopyMemory(pValue, &property->second, sizeof(Variant));
-                    return VSF_OK;
-                }
-				else
-				{
-					*pValue = CreateVariant();
-				}
-            }
 
+            *pValue = CreateVariant();
             return VSFERR_INVALIDCALL;
         }
 
         VoodooResult VOODOO_METHODTYPE VSTechniqueDX9::SetProperty(_In_ CONST Uuid propid, _In_ Variant * pValue)
         {
-            if (propid == PropIds::D3DX9Handle || propid == PropIds::D3DX9Effect)
+            if (!pValue) return VSFERR_INVALIDPARAMS;
+
+            // Well-known properties are read-only, they hold the hardware handles.
+            if (PropertyStore::FindSlot(propid) != VSPropSlot_Spill)
             {
                 return VSFERR_INVALIDPARAMS;
             }
 
-            m_Properties[propid] = (*pValue);
+            m_Properties.Set(propid, *pValue);
             return VSF_OK;
         }
 
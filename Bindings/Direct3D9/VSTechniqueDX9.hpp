@@ -31,6 +31,7 @@ namespace VoodooShader
         VOODOO_CLASS(VSTechniqueDX9, ITechnique, ({0xA5, 0x12, 0xF3, 0xE6, 0xAF, 0x05, 0xE1, 0x11, 0x9E, 0x05, 0x00, 0x50, 0x56, 0xC0, 0x00, 0x08}))
         {
             friend class VSEffectDX9;
+            friend class VSParameterDX9;
             friend class VSPassDX9;
 
         public:
@@ -57,10 +58,12 @@ namespace VoodooShader
             String m_Name;
 
             VSEffectDX9 * m_Effect;
-            PropertyMap m_Properties;
+            PropertyStore m_Properties;
             PassVector m_Passes;
 
             D3DXHANDLE m_Handle;
+
+            VOODOO_DECLARE_POOLED();
         };
     }
 }
@@ -32,11 +32,15 @@ namespace VoodooShader
 {
     namespace Voodoo_D3D9
     {
+        #define VOODOO_DEBUG_TYPE VSTextureDX9
+        DeclareDebugCache();
+        VOODOO_DEFINE_POOLED(VSTextureDX9, 32);
+
         VSTextureDX9::VSTextureDX9(_In_ VSBindingDX9 * pBinding) :
 			m_Refs(0), m_Binding(pBinding), m_TextureHandle(nullptr), m_SurfaceHandle(nullptr),
 			m_BoundSourceSlot(VOODOO_TEXTURE_INVALID), m_BoundTargetSlot(VOODOO_TEXTURE_INVALID)
         {
-
+            AddThisToDebugCache();
         }
 
         VSTextureDX9::VSTextureDX9(_In_ VSBindingDX9 * pBinding, _In_ CONST String & name, _In_ IDirect3DTexture9 * pTexture) :
@@ -55,12 +59,24 @@ namespace VoodooShader
                 m_TextureHandle->AddRef();
                 m_TextureHandle->GetSurfaceLevel(0, &m_SurfaceHandle);
 
+                m_Properties.Set<VSPropSlot_D3D9Texture>(CreateVariant(m_TextureHandle));
+                m_Properties.Set<VSPropSlot_D3D9Surface>(CreateVariant(m_SurfaceHandle));
+
                 this->GetTexDesc();
             }
+
+            AddThisToDebugCache();
         }
 
         VSTextureDX9::~VSTextureDX9()
         {
+            RemoveThisFromDebugCache();
+
+            if (m_SurfaceHandle)
+            {
+                m_SurfaceHandle->Release();
+            }
+
             if (m_TextureHandle)
             {
                 m_TextureHandle->Release();
@@ -74,46 +90,26 @@ namespace VoodooShader
 
         uint32_t VOODOO_METHODTYPE VSTextureDX9::Release() CONST
         {
-            if (SAFE_DECREMENT(m_Refs) == 0)
+            uint32_t count = SAFE_DECREMENT(m_Refs);
+            if (count == 0)
             {
                 delete this;
-                return 0;
-            }
-            else
-            {
-                return m_Refs;
             }
+            return count;
         }
 
         VoodooResult VOODOO_METHODTYPE VSTextureDX9::QueryInterface(_In_ CONST Uuid refid, _Outptr_result_maybenull_ IObject ** ppOut)
         {
-            if (!ppOut)
+            static CONST InterfaceMapEntry map[] =
             {
-                return VSFERR_INVALIDPARAMS;
-            }
-            else
-            {
-                if (refid == IID_IObject)
-                {
-                    *ppOut = static_cast<IObject*>(this);
-                }
-                else if (refid == IID_ITexture)
-                {
-                    *ppOut = static_cast<ITexture*>(this);
-                }
-                else if (refid == CLSID_VSTextureDX9)
-                {
-                    *ppOut = static_cast<VSTextureDX9*>(this);
-                }
-                else
-                {
-                    *ppOut = nullptr;
-                    return false;
-                }
-
-                (*ppOut)->AddRef();
-                return true;
-            }
+                VOODOO_INTERFACE_ENTRY(VSTextureDX9, IObject),
+                VOODOO_INTERFACE_ENTRY(VSTextureDX9, ITexture),
+                VOODOO_CLASS_ENTRY(VSTextureDX9),
+                VOODOO_INTERFACE_MAP_END
+            };
+            static volatile LONG hint = 0;
+
+            return QueryInterfaceMap(this, map, &hint, refid, ppOut);
         }
 
         String VOODOO_METHODTYPE VSTextureDX9::ToString() CONST
@@ -135,32 +131,27 @@ namespace VoodooShader
         {
             if (!pValue) return VSFERR_INVALIDPARAMS;
 
-            if (propid == PropIds::D3D9Texture)
-            {
-                pValue->Type = VSUT_PVoid;
-                pValue->Components = 0;
-                pValue->VPVoid = m_TextureHandle;
-                return VSF_OK;
-            }
-            else if (propid == PropIds::D3D9Surface)
+            if (m_Properties.Get(propid, pValue))
             {
-                pValue->Type = VSUT_PVoid;
-                pValue->Components = 0;
-                pValue->VPVoid = m_SurfaceHandle;
                 return VSF_OK;
             }
 
-			*pValue = CreateVariant();
-            return VSFERR_INVALIDPARAMS;
+            *pValue = CreateVariant();
+            return VSFERR_INVALIDCALL;
         }
 
         VoodooResult VOODOO_METHODTYPE VSTextureDX9::SetProperty(_In_ CONST Uuid propid, _In_ Variant * pValue)
         {
-            UNREFERENCED_PARAMETER(propid);
-
             if (!pValue) return VSFERR_INVALIDPARAMS;
 
-            return VSFERR_INVALIDCALL;
+            // Well-known properties are read-only, they hold the hardware handles.
+            if (PropertyStore::FindSlot(propid) != VSPropSlot_Spill)
+            {
+                return VSFERR_INVALIDPARAMS;
+            }
+
+            m_Properties.Set(propid, *pValue);
+            return VSF_OK;
         }
 
         VOODOO_METHODDEF(VSTextureDX9::Bind)(_In_ TextureMode mode, _In_ uint32_t index)
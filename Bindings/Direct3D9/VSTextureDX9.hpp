@@ -60,7 +60,7 @@ namespace VoodooShader
             String m_Name;
 
             VSBindingDX9 * m_Binding;
-            PropertyMap m_Properties;
+            PropertyStore m_Properties;
 
             uint32_t m_BoundSourceSlot;
             uint32_t m_BoundTargetSlot;
@@ -70,6 +70,8 @@ namespace VoodooShader
             IDirect3DTexture9 * m_TextureHandle;
             IDirect3DSurface9 * m_SurfaceHandle;
             TextureDesc m_Desc;
+
+            VOODOO_DECLARE_POOLED();
         };
     }
 }
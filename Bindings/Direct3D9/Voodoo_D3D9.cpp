@@ -24,11 +24,18 @@
 
 namespace VoodooShader
 {
+    volatile LONG gModuleObjects = 0;
+
     namespace Voodoo_D3D9
     {
         static const Version moduleVersion = VOODOO_VERSION_STRUCT(D3D9);
-        static const wchar_t * name_VSBindingDX9 = L"VSBindingDX9";
-        static const Uuid clsid_VSBindingDX9 = CLSID_VSBindingDX9;
+
+        static const PluginClassDesc moduleClasses[] =
+        {
+            { CLSID_VSBindingDX9, L"VSBindingDX9" },
+        };
+
+        static const uint32_t moduleClassCount = sizeof(moduleClasses) / sizeof(moduleClasses[0]);
 
         const Version * VOODOO_CALLTYPE API_PluginInit(_In_ ICore * pCore)
         {
@@ -42,9 +49,14 @@ namespace VoodooShader
             UNREFERENCED_PARAMETER(pCore);
         }
 
+        bool VOODOO_CALLTYPE API_PluginCanUnload()
+        {
+            return (gModuleObjects == 0);
+        }
+
         const uint32_t VOODOO_CALLTYPE API_ClassCount()
         {
-            return 1;
+            return moduleClassCount;
         }
 
         const wchar_t * VOODOO_CALLTYPE API_ClassInfo(_In_ const uint32_t index, _Out_ Uuid * pUuid)
@@ -54,10 +66,10 @@ namespace VoodooShader
                 return nullptr;
             }
 
-            if (index == 0)
+            if (index < moduleClassCount)
             {
-                *pUuid = clsid_VSBindingDX9;
-                return name_VSBindingDX9;
+                *pUuid = moduleClasses[index].ClsId;
+                return moduleClasses[index].Name;
             }
 
 			*pUuid = NilUuid;
@@ -78,5 +90,23 @@ namespace VoodooShader
 
             return nullptr;
         }
+
+        const PluginDesc * VOODOO_CALLTYPE API_PluginDesc()
+        {
+            static const PluginDesc moduleDesc =
+            {
+                VOODOO_PLUGIN_ABI,
+                sizeof(PluginDesc),
+                &API_PluginInit,
+                &API_PluginReset,
+                &API_ClassCreate,
+                nullptr,
+                moduleClassCount,
+                moduleClasses,
+                &API_PluginCanUnload
+            };
+
+            return &moduleDesc;
+        }
     }
 }
@@ -56,39 +56,36 @@ namespace VoodooShader
         UNREFERENCED_PARAMETER(pCore);
     }
 
+    static CONST PluginClassDesc coreClasses[] =
+    {
+        { CLSID_VSCore,         VSTR("VSCore") },
+        { CLSID_VSFileSystem,   VSTR("VSFileSystem") },
+        { CLSID_VSHookManager,  VSTR("VSHookManager") },
+        { CLSID_VSLogger,       VSTR("VSLogger") },
+    };
+
+    static CONST uint32_t coreClassCount = sizeof(coreClasses) / sizeof(coreClasses[0]);
+
     CONST uint32_t VOODOO_CALLTYPE API_ClassCount()
     {
-        return 4;
+        return coreClassCount;
     }
 
-	CONST wchar_t * VOODOO_CALLTYPE API_ClassInfo(_In_ CONST uint32_t index, _Out_ Uuid * pUuid )
-	{
-        static CONST wchar_t * name_VSCore = VSTR("VSCore");
-        static CONST wchar_t * name_VSFileSystem = VSTR("VSFileSystem");
-        static CONST wchar_t * name_VSHookManager = VSTR("VSHookManager");
-        static CONST wchar_t * name_VSLogger = VSTR("VSLogger");
-
+    CONST wchar_t * VOODOO_CALLTYPE API_ClassInfo(_In_ CONST uint32_t index, _Out_ Uuid * pUuid )
+    {
         if (!pUuid)
         {
             return nullptr;
         }
 
-        switch (index)
+        if (index < coreClassCount)
         {
-        case 0:
-            *pUuid = CLSID_VSCore;
-            return name_VSCore;
-        case 1:
-            *pUuid = CLSID_VSFileSystem;
-            return name_VSFileSystem;
-        case 2:
-            *pUuid = CLSID_VSHookManager;
-            return name_VSHookManager;
-        case 3:
-            *pUuid = CLSID_VSLogger;
-            return name_VSLogger;
-        default:
-			*pUuid = VoodooShader::NilUuid;
+            *pUuid = coreClasses[index].ClsId;
+            return coreClasses[index].Name;
+        }
+        else
+        {
+            *pUuid = VoodooShader::NilUuid;
             return nullptr;
         }
     }
@@ -108,31 +105,44 @@ namespace VoodooShader
         }
     }
 
-    // Boost intrusive_ptr functions
-    VOODOO_FUNCTION(void, intrusive_ptr_add_ref)(IObject * obj)
+    CONST PluginDesc * VOODOO_CALLTYPE API_PluginDesc()
     {
+        static CONST PluginDesc coreDesc =
+        {
+            VOODOO_PLUGIN_ABI,
+            sizeof(PluginDesc),
+            &API_PluginInit,
+            &API_PluginReset,
+            &API_ClassCreate,
+            nullptr,
+            coreClassCount,
+            coreClasses,
+            nullptr
+        };
+
+        return &coreDesc;
+    }
+
 #if defined(VOODOO_DEBUG_MEMORY)
+    // Boost intrusive_ptr functions, logged through the core (otherwise inline in IObject.hpp)
+    VOODOO_FUNCTION(void, intrusive_ptr_add_ref)(IObject * obj)
+    {
         uint32_t refs = obj->AddRef();
         if (obj && obj->GetCore() && obj->GetCore()->GetLogger())
         {
             obj->GetCore()->GetLogger()->Log(VSLog_CoreError, VSTR("VOODOO_DEBUG_MEMORY"), VSTR("intrusive_ptr_add_ref(%p) = %d"), obj, refs);
         }
-#else
-        obj->AddRef();
-#endif
     }
 
     VOODOO_FUNCTION(void, intrusive_ptr_release)(IObject * obj)
     {
-#if defined(VOODOO_DEBUG_MEMORY)
-        if (obj && obj->GetCore() && obj->GetCore()->GetLogger())
+        // The object may be gone after the release, so find the logger first
+        ILogger * logger = (obj->GetCore()) ? obj->GetCore()->GetLogger() : nullptr;
+        uint32_t refs = obj->Release();
+        if (logger && (refs > 0 || static_cast<IObject*>(logger) != obj))
         {
-            obj->AddRef();
-            uint32_t refs = obj->Release() - 1;
-            obj->GetCore()->GetLogger()->Log(VSLog_CoreError, VSTR("VOODOO_DEBUG_MEMORY"), VSTR("intrusive_ptr_release(%p) = %d"), obj, refs);
+            logger->Log(VSLog_CoreError, VSTR("VOODOO_DEBUG_MEMORY"), VSTR("intrusive_ptr_release(%p) = %d"), obj, refs);
         }
-#else
-        obj->Release();
-#endif
     }
+#endif
 }
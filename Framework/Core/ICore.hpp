@@ -23,6 +23,33 @@
 
 namespace VoodooShader
 {
+    /**
+     * @ingroup voodoo_structs
+     * Pre-parsed config, read from the config document in a single pass. Values are stored as they appear in the
+     * document, without variables parsed.
+     */
+    struct ConfigDesc
+    {
+        StringMap       Variables;
+        String          LogFile;
+        String          LogAppend;
+        String          LogFilter;
+        StringPairList  PluginPaths;    /* !< Plugin paths and their filters, in document order. */
+        StringList      PluginFiles;
+        String          PluginThreads;  /* !< Worker threads used when loading sets of plugins, a number or "auto". */
+        String          PluginManifest; /* !< File caching the classes of each plugin, allowing plugins to be loaded on demand. */
+        String          PluginReload;   /* !< Whether plugins are loaded from copies and reloaded when their files change. */
+        String          FileSystem;
+        String          HookManager;
+        String          AutoReload;     /* !< Whether the config file is watched and changes applied while running. */
+        StringMap       Expressions;    /* !< Parameter expressions, keyed by the name of the global parameter they drive. */
+        /**
+         * Class config sections, keyed by class name. Each section holds the text of every element within it, keyed by the
+         * element's path relative to the section (e.g., <code>SearchPaths/Path</code>).
+         */
+        ConfigClassMap  Classes;
+    };
+
     /**
      * @addtogroup voodoo_interfaces
      * @{
@@ -90,6 +117,19 @@ namespace VoodooShader
          * @post If this call fails, the core is in an undefined state and must be destroyed.
          */
         _Check_return_ VOODOO_METHOD(Reset)() PURE;
+        /**
+         * Applies pending work picked up in the background, such as changes to the config file when auto-reload is
+         * enabled, and reloads changed plugins when plugin reloading is enabled. Plugins newly listed in the config are
+         * mapped on a worker and registered by a later call, once mapped. Events posted for the frame (see PostEvent())
+         * are then delivered. This should be called once per frame from the render thread; it does not block and returns
+         * immediately if nothing is pending.
+         *
+         * @return VSF_OK if changes were applied or events delivered, VSFOK_REDUNDANT if nothing was pending.
+         *
+         * @pre ICore::Init()
+         * @post If the config changed, EventIds::ConfigChanged has been called.
+         */
+        VOODOO_METHOD(Update)() PURE;
         /**
          * @}
          * @name Callback Methods
@@ -109,6 +149,18 @@ namespace VoodooShader
          *      changed to a map of variants in the future, once a map class is added).
          */
         VOODOO_METHOD(OnEvent)(_In_ CONST Uuid event, _In_ Functions::CallbackFunc func) PURE;
+        /**
+         * Registers a callback with user data and a priority. Callbacks with a higher priority are called first; callbacks
+         * registered through the overload without user data have priority 0.
+         *
+         * @param   event   The Uuid of the event to subscribe to.
+         * @param   func    The callback function for the event.
+         * @param   pUser   Data passed to the callback, which may register the same function more than once with
+         *      different data.
+         * @param   priority    The callback's priority.
+         * @return VSFOK_REDUNDANT if the function was already registered for the event with the same data.
+         */
+        VOODOO_METHOD(OnEvent)(_In_ CONST Uuid event, _In_ Functions::EventFunc func, _In_opt_ void * pUser, _In_ CONST int32_t priority) PURE;
         /**
          * Removes a callback from an event on this core. The callback will no longer be notified when the event is called.
          *
@@ -118,6 +170,18 @@ namespace VoodooShader
          * @pre ICore::OnEvent() must be called with the same parameters.
          */
         VOODOO_METHOD(DropEvent)(_In_ CONST Uuid event, _In_ Functions::CallbackFunc func) PURE;
+        /**
+         * Removes a callback registered with user data. Both the function and the data must match.
+         */
+        VOODOO_METHOD(DropEvent)(_In_ CONST Uuid event, _In_ Functions::EventFunc func, _In_opt_ void * pUser) PURE;
+        /**
+         * Retrieves the slot for an event, a small integer that can be used to call the event without looking it up. Slots
+         * are assigned the first time an event is used and do not change for the life of the core.
+         *
+         * @param   event   The Uuid of the event.
+         * @return The slot, or -1 if no more events can be registered.
+         */
+        VOODOO_METHOD_(uint32_t, GetEventSlot)(_In_ CONST Uuid event) PURE;
         /**
          * Broadcasts an event to all registered handlers, passing the provided argument list.
          *
@@ -125,13 +189,34 @@ namespace VoodooShader
          * @param   count   The number of variants passed, may be 0.
          * @param   pArgs   The list of variants passed as arguments, may be nullptr if @a count is 0.
          *
-         * @warning This calls all registered callbacks for the given event. The order registered callbacks will be called 
-         *      in is undefined.
+         * @warning This calls all registered callbacks for the given event, in priority order and then the order they were
+         *      registered in.
          * @warning Callbacks can modify the arguments, but not change the count.
+         * @note Events may be called from any thread. Callbacks registered or removed while the event is being called
+         *      (including by the callbacks themselves) take effect from the next call.
          * @warning If a callback returns a failure value, the loop will be aborted and remaining callbacks will not be
          *      called. The failure will be returned by this method. If no callbacks fail, this will return generic success.
          */
         VOODOO_METHOD(CallEvent)(_In_ CONST Uuid event, _In_ CONST uint32_t count, _In_reads_opt_(count) Variant * pArgs) PURE;
+        /**
+         * Broadcasts an event by slot, as retrieved from GetEventSlot(), with the same behavior as calling it by Uuid.
+         */
+        VOODOO_METHOD(CallEvent)(_In_ CONST uint32_t slot, _In_ CONST uint32_t count, _In_reads_opt_(count) Variant * pArgs) PURE;
+        /**
+         * Queues an event to be called later, rather than calling its handlers on this thread. Events posted for the frame
+         * are called by the next ICore::Update(), in the order they were posted; events posted to the worker are called
+         * on the core's event thread.
+         *
+         * @param   event   The Uuid of the event to post.
+         * @param   count   The number of variants passed, may be 0.
+         * @param   pArgs   The arguments, which are copied. Strings and Uuids they point to are copied as well, and objects
+         *      are held until the event has been called. Other pointers must remain valid until then.
+         * @param   flags   Delivery flags, see @ref EventPostFlags.
+         * @return VSFOK_REDUNDANT if the post was coalesced with one already queued.
+         *
+         * @note Posting is safe from any thread. Changes made to the arguments by handlers are not returned.
+         */
+        VOODOO_METHOD(PostEvent)(_In_ CONST Uuid event, _In_ CONST uint32_t count, _In_reads_opt_(count) CONST Variant * pArgs, _In_ CONST uint32_t flags) PURE;
         /**
          * @}
          * @name Core Field Methods
@@ -144,6 +229,13 @@ namespace VoodooShader
          * @return A reference to the config.
          */
         VOODOO_METHOD_(XmlDocument, GetConfig)() CONST PURE;
+        /**
+         * Retrieve the pre-parsed config for this ICore. This holds the global settings and class config sections, read
+         * once when the config was loaded, and should be preferred to querying the config document.
+         *
+         * @return A pointer to the config (valid for the lifetime of the core), or nullptr if the core is not initialized.
+         */
+        VOODOO_METHOD_(CONST ConfigDesc *, GetConfigDesc)() CONST PURE;
         /**
          * Retrieves this core's IFileSystem implementation.
          *
@@ -191,25 +283,27 @@ namespace VoodooShader
          *
          * @param   name    The name for this parameter.
          * @param   desc    The desc of the parameter to create.
+         * @param   pHandle If not null, receives a handle for resolving the parameter with ResolveParameter().
          *
          * @pre ICore::Bind must be called successfully before use.
          *
          * @note This function creates global parameters, which are not associated with any effect. They are primarily used
          *      to propagate values down to other parameters, both global and effect.
          */
-        VOODOO_METHOD_(IParameter *, CreateParameter)(_In_ CONST String & name, _In_ CONST ParameterDesc desc) PURE;
+        VOODOO_METHOD_(IParameter *, CreateParameter)(_In_ CONST String & name, _In_ CONST ParameterDesc desc, _Out_opt_ ParameterHandle * pHandle) PURE;
         /**
          * Registers a texture with this core.
          *
          * @param   name    The texture name (must be unique).
          * @param   desc    Information for the texture to be created.
+         * @param   pHandle If not null, receives a handle for resolving the texture with ResolveTexture().
          *
          * @pre ICore::Bind must be called successfully before use.
          *
          * @note This method calls IAdapter::CreateTexture() to handle the actual creation, then registers
          *     the returned texture with the core and sets things up properly.
          */
-        VOODOO_METHOD_(ITexture *, CreateTexture)(_In_ CONST String & name, _In_ CONST TextureDesc desc) PURE;
+        VOODOO_METHOD_(ITexture *, CreateTexture)(_In_ CONST String & name, _In_ CONST TextureDesc desc, _Out_opt_ TextureHandle * pHandle) PURE;
         /**
          * Loads a texture from file and registers it with this core. The texture file dictates size and format of the
          * resulting object, and only supported formats will be loaded. This relies in part on the active binding, but
@@ -217,10 +311,11 @@ namespace VoodooShader
          * 
          * @param   name    The texture's name, used to register it with the core.
          * @param   pFile   The file to load.
+         * @param   pHandle If not null, receives a handle for resolving the texture with ResolveTexture().
          *
          * @pre ICore::Bind must be called successfully before use.
          */
-        VOODOO_METHOD_(ITexture *, LoadTexture)(_In_ CONST String & name, _In_ IFile * pFile) PURE;
+        VOODOO_METHOD_(ITexture *, LoadTexture)(_In_ CONST String & name, _In_ IFile * pFile, _Out_opt_ TextureHandle * pHandle) PURE;
         /**
          * Retrieve a parameter by name.
          *
@@ -236,6 +331,35 @@ namespace VoodooShader
          * @param   name    The texture name.
          */
         VOODOO_METHOD_(ITexture *, GetTexture)(_In_ CONST String & name) CONST PURE;
+        /**
+         * Retrieves the handle of a global parameter, for code that only has its name.
+         *
+         * @param   name    The name of the parameter.
+         * @return          The handle, or 0 if no parameter has that name.
+         */
+        VOODOO_METHOD_(ParameterHandle, GetParameterHandle)(_In_ CONST String & name) CONST PURE;
+        /**
+         * Retrieves the handle of a texture, for code that only has its name.
+         *
+         * @param   name    The texture name.
+         * @return          The handle, or 0 if no texture has that name.
+         */
+        VOODOO_METHOD_(TextureHandle, GetTextureHandle)(_In_ CONST String & name) CONST PURE;
+        /**
+         * Retrieves a global parameter by handle. This is an indexed load with no hashing or name comparison, so is
+         * suited to code running every frame.
+         *
+         * @param   handle  The handle, from CreateParameter() or GetParameterHandle().
+         * @return          The parameter, or nullptr if the handle is invalid or the parameter has been removed.
+         */
+        VOODOO_METHOD_(IParameter *, ResolveParameter)(_In_ CONST ParameterHandle handle) CONST PURE;
+        /**
+         * Retrieves a texture by handle, as ResolveParameter().
+         *
+         * @param   handle  The handle, from CreateTexture(), LoadTexture() or GetTextureHandle().
+         * @return          The texture, or nullptr if the handle is invalid or the texture has been removed.
+         */
+        VOODOO_METHOD_(ITexture *, ResolveTexture)(_In_ CONST TextureHandle handle) CONST PURE;
         /**
          * Removes a virtual parameter from the core's parameter index.
          *
@@ -250,6 +374,44 @@ namespace VoodooShader
          * @return          Succeeds if the texture was found and removed.
          */
         VOODOO_METHOD(RemoveTexture)(_In_ CONST String & name) PURE;
+        /**
+         * Drives a parameter from an expression, evaluated with every other expression once per frame by ICore::Update().
+         * Expressions combine numbers, arithmetic, common functions, the built-ins <code>time</code>, <code>delta</code>,
+         * <code>frame</code> and <code>random</code>, and other global parameters by name (see
+         * @ref voodoo_graphics_effects_system_expressions).
+         *
+         * @param   pParam      The parameter to drive, a global or effect parameter of float, int or bool type.
+         * @param   expression  The expression, or an empty string to stop driving the parameter.
+         * @return              VSFERR_INVALIDPARAMS if the parameter cannot be driven, or the expression could not be
+         *                      compiled or depends on itself.
+         *
+         * @note The parameter is not referenced, and must have its expression cleared before it is destroyed. Global
+         *      parameters are cleared when removed from the core.
+         */
+        VOODOO_METHOD(SetExpression)(_In_ IParameter * pParam, _In_ CONST String & expression) PURE;
+        /**
+         * @}
+         * @name Diagnostic Methods
+         * @{
+         */
+        /**
+         * Retrieves the live object counts for one tracked type. Types are listed once their first object has been
+         * created, in no particular order, and include types from every loaded plugin.
+         *
+         * @param   index   The index of the type.
+         * @param   pStats  Filled with the counts.
+         * @return          VSFERR_INVALIDPARAMS once @a index is past the last type.
+         */
+        VOODOO_METHOD(GetObjectStats)(_In_ CONST uint32_t index, _Out_ ObjectStats * pStats) CONST PURE;
+        /**
+         * Sets how often the creation stacks of tracked objects are captured, as one object in every @a rate of each type.
+         * A few stacks are kept per type, while their objects are alive. 0 (the default) disables sampling.
+         */
+        VOODOO_METHOD(SetObjectSampling)(_In_ CONST uint32_t rate) PURE;
+        /**
+         * Writes the live counts of every tracked type, and any sampled creation stacks, to the log.
+         */
+        VOODOO_METHOD(LogObjects)() CONST PURE;
         /**
          * @}
          */
@@ -75,6 +75,90 @@ namespace VoodooShader
          */
         VOODOO_METHOD_(ICore *, GetCore)() CONST PURE;
     };
+
+    /**
+     * Entry in an interface map, associating an IID or CLSID with the offset of that interface within the class. Maps
+     * are static arrays built with the VOODOO_INTERFACE_* macros and terminated by VOODOO_INTERFACE_MAP_END.
+     */
+    struct InterfaceMapEntry
+    {
+        CONST Uuid * pRefId;
+        ptrdiff_t Offset;
+    };
+
+    /**
+     * Offset of base @a iface within class @a cls. Like ATL's offsetofclass, this uses a non-null dummy address so the
+     * cast is adjusted, and folds to a constant so maps are statically initialized.
+     */
+#define VOODOO_INTERFACE_OFFSET(cls, iface) \
+    (reinterpret_cast<ptrdiff_t>(static_cast<iface *>(reinterpret_cast<cls *>(8))) - 8)
+#define VOODOO_INTERFACE_ENTRY(cls, iface)  { &IID_##iface, VOODOO_INTERFACE_OFFSET(cls, iface) }
+#define VOODOO_CLASS_ENTRY(cls)             { &CLSID_##cls, 0 }
+#define VOODOO_INTERFACE_MAP_END            { nullptr, 0 }
+
+    /**
+     * Shared QueryInterface implementation, looking the requested ID up in an interface map. The entry found last is
+     * cached in @a pHint and checked first, since most call sites repeatedly ask a class for the same interface.
+     *
+     * @param   pThis   The object, as a pointer to the class the map was built for.
+     * @param   pMap    The interface map.
+     * @param   pHint   Per-map cache of the last matching entry.
+     * @param   refid   The ID requested.
+     * @param   ppOut   The interface, which is referenced, or nullptr if the ID is not in the map.
+     */
+    inline VoodooResult QueryInterfaceMap
+    (
+        _In_ void * pThis,
+        _In_ CONST InterfaceMapEntry * pMap,
+        _Inout_ volatile LONG * pHint,
+        _In_ CONST Uuid & refid,
+        _Outptr_result_maybenull_ IObject ** ppOut
+    )
+    {
+        if (!ppOut)
+        {
+            return VSFERR_INVALIDPARAMS;
+        }
+
+        LONG index = *pHint;
+        if (!IsSameUuid(*pMap[index].pRefId, refid))
+        {
+            index = 0;
+            while (pMap[index].pRefId && !IsSameUuid(*pMap[index].pRefId, refid))
+            {
+                ++index;
+            }
+
+            if (!pMap[index].pRefId)
+            {
+                *ppOut = nullptr;
+                return VSFERR_INVALIDUUID;
+            }
+
+            *pHint = index;
+        }
+
+        // Every interface derives singly from IObject, so each entry is usable as an IObject.
+        *ppOut = reinterpret_cast<IObject *>(static_cast<char *>(pThis) + pMap[index].Offset);
+        (*ppOut)->AddRef();
+        return VSF_OK;
+    }
+
+#if !defined(VOODOO_NO_BOOST) && !defined(VOODOO_DEBUG_MEMORY)
+    /**
+     * Reference functions for Boost's intrusive_ptr. These call the object directly, rather than through the core, so
+     * copying a reference costs only the virtual call.
+     */
+    inline void intrusive_ptr_add_ref(IObject * obj)
+    {
+        obj->AddRef();
+    }
+
+    inline void intrusive_ptr_release(IObject * obj)
+    {
+        obj->Release();
+    }
+#endif
     /**
      * @}
      */
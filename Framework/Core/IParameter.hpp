@@ -67,19 +67,55 @@ namespace VoodooShader
          * @}
          * @name Value Access Methods
          * @{
+         *
+         * @note Bindings may defer uploading set values until the effect or one of its passes is next bound, and may skip
+         *      sets that do not change the value. Errors from a deferred upload are logged rather than returned.
          */
         VOODOO_METHOD(GetBool)(_Out_ bool * pVal) CONST PURE;
         VOODOO_METHOD(GetFloat)(_Out_ float * pVal) CONST PURE;
         VOODOO_METHOD(GetInt)(_Out_ int32_t * pVal) CONST PURE;
+        VOODOO_METHOD(GetMatrix)(_Out_ Float4x4 * pVal) CONST PURE;
         VOODOO_METHOD(GetString)(_Out_ String * pVal) CONST PURE;
         VOODOO_METHOD(GetTexture)(_Out_ ITexture ** pVal) CONST PURE;
         VOODOO_METHOD(GetVector)(_Out_ Float4 * pVal) CONST PURE;
         VOODOO_METHOD(SetBool)(_In_ CONST bool val) PURE;
         VOODOO_METHOD(SetFloat)(_In_ CONST float val) PURE;
+        /**
+         * Sets the leading float components of an array or matrix, in order of element, then row, then column.
+         *
+         * @param count The number of floats, from 1 to the components of every element combined.
+         * @param pVal The floats.
+         */
+        VOODOO_METHOD(SetFloatArray)(_In_ CONST uint32_t count, _In_reads_(count) CONST float * pVal) PURE;
         VOODOO_METHOD(SetInt)(_In_ CONST int32_t val) PURE;
+        VOODOO_METHOD(SetMatrix)(_In_ CONST Float4x4 & val) PURE;
+        /**
+         * Sets the leading elements of a matrix array. Only the top-left block of each matrix, as given by the row and column
+         * counts in the parameter's description, is used.
+         *
+         * @param count The number of matrices, from 1 to the number of elements.
+         * @param pVal The matrices.
+         */
+        VOODOO_METHOD(SetMatrixArray)(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4x4 * pVal) PURE;
+        /**
+         * Sets part of the float components from raw bytes, for data (such as structures) already laid out to match them.
+         *
+         * @param offset The offset of the first byte, from the first component.
+         * @param size The number of bytes, which must lie within the components of every element combined.
+         * @param pData The bytes.
+         */
+        VOODOO_METHOD(SetRaw)(_In_ CONST uint32_t offset, _In_ CONST uint32_t size, _In_reads_bytes_(size) CONST void * pData) PURE;
         VOODOO_METHOD(SetString)(_In_ CONST String & val) PURE;
         VOODOO_METHOD(SetTexture)(_In_ ITexture * pVal) PURE;
         VOODOO_METHOD(SetVector)(_In_ CONST Float4 val) PURE;
+        /**
+         * Sets the leading elements of a vector array. Each element takes as many components as its description has
+         * columns.
+         *
+         * @param count The number of vectors, from 1 to the number of elements.
+         * @param pVal The vectors.
+         */
+        VOODOO_METHOD(SetVectorArray)(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4 * pVal) PURE;
         /**
          * @}
          * @name Link Methods
@@ -85,7 +85,8 @@ namespace VoodooShader
          * @param   path    The path to load from (may be any Windows path type). Sent through the parser before use.
          * @param   filter  A regex to filter filenames by.
          *
-         * @note Only loads files whose filename matches the filter (standard regex match).
+         * @note Only loads files whose filename matches the filter (standard regex match). Matching files are loaded as
+         *      a single set, see LoadPlugins.
          */
         VOODOO_METHOD(LoadPath)(_In_ ICore * pCore, _In_ CONST String & path, _In_ CONST String & filter) PURE;
         /**
@@ -124,6 +125,26 @@ namespace VoodooShader
          * @note This always uses the module's directory in the search path for required DLLs.
          */
         VOODOO_METHOD(LoadPlugin)(_In_ ICore * pCore, _In_ IFile * pFile) PURE;
+        /**
+         * Loads a set of modules, using absolute or relative filenames (resolved as with LoadPlugin).
+         *
+         * @param   pCore   The core to use for loading and resolution.
+         * @param   count   The number of filenames.
+         * @param   pNames  The files to load, each sent through the parser before use.
+         *
+         * @note If the core's config gives a thread count for plugins (<code>Plugins/@threads</code>, a number or
+         *      <code>auto</code>), the modules are mapped and their exports resolved on that many worker threads. Each
+         *      module's @p PluginInit is always called on the calling thread and classes are registered in the order the
+         *      files were given, so the result does not depend on which module finished mapping first.
+         *
+         * @note Modules exporting @p PluginDepends are initialized after the modules they name, when those are part of the
+         *      same set. See @ref voodoo_spec_plugin_exports_depends.
+         *
+         * @note If the core's config gives a plugin manifest (<code>Plugins/@manifest</code>), the classes of each module
+         *      loaded are recorded there. On later runs, modules that have not changed since are not loaded with the set;
+         *      their classes are registered from the manifest and the module is loaded the first time one is created.
+         */
+        VOODOO_METHOD(LoadPlugins)(_In_ ICore * pCore, _In_ CONST uint32_t count, _In_reads_(count) CONST String * pNames) PURE;
 		/**
 		 * Unloads a single module.
 		 *
@@ -138,6 +159,31 @@ namespace VoodooShader
 		 * @param	libid	The UUID of the library to unload.
 		 */
         VOODOO_METHOD(UnloadPlugin)(_In_ ICore * pCore, _In_ CONST Uuid libid) PURE;
+        /**
+         * Reloads a module from its file, while the old copy of the module stays loaded for any objects it created.
+         *
+         * The new copy is mapped and initialized, then takes over the module's classes, so objects created after the
+         * reload use the new code. The old copy is reset (PluginReset) and retired; it is freed once nothing else holds
+         * it and its @p PluginCanUnload export reports no live objects (the bundled plugins report gModuleObjects). Modules
+         * without that export are kept loaded until the server is destroyed. If the new copy fails to load, the old copy
+         * remains in use.
+         *
+         * @param   pCore   The core to reload with.
+         * @param   name    The name of the module to reload.
+         * @return VSFERR_INVALIDCALL if plugin reloading is not enabled or the module was not loaded from a copy.
+         *
+         * @note Reloading must be enabled in the config (<code>Plugins/@reload</code>) before modules are loaded, so they
+         *      are loaded from copies and their files can be replaced.
+         */
+        VOODOO_METHOD(ReloadPlugin)(_In_ ICore * pCore, _In_ CONST String & name) PURE;
+        /**
+         * Reloads any modules whose files have changed since they were loaded, and frees retired modules that are no
+         * longer in use. Files are checked at most every half second, so this may be called every frame.
+         *
+         * @param   pCore   The core to reload with.
+         * @return VSFOK_REDUNDANT if no modules were reloaded.
+         */
+        VOODOO_METHOD(ReloadChanged)(_In_ ICore * pCore) PURE;
         /**
          * @}
          * @name Class Methods
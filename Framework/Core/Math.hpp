@@ -0,0 +1,509 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooFramework.hpp"
+
+#pragma warning(push,3)
+#include <math.h>
+#pragma warning(pop)
+
+/**
+ * SIMD backend for the math functions, chosen from the target unless VOODOO_NO_SIMD is defined, in which case the
+ * scalar reference functions are used throughout.
+ */
+#if defined(VOODOO_NO_SIMD)
+#elif defined(_M_IX86) || defined(_M_X64) || defined(__SSE__) || defined(__x86_64__)
+#   define VOODOO_MATH_SSE
+#   pragma warning(push,3)
+#   include <xmmintrin.h>
+#   pragma warning(pop)
+#elif defined(_M_ARM) || defined(__ARM_NEON)
+#   define VOODOO_MATH_NEON
+#   include <arm_neon.h>
+#endif
+
+namespace VoodooShader
+{
+    /**
+     * @ingroup voodoo_utility
+     * Vector, matrix and light math for the framework types. Matrices are row-major and used with row vectors, as in
+     * Direct3D, so <code>Multiply(a, b)</code> applies @p a first. Angles are in radians and the view and projection
+     * builders are left-handed.
+     *
+     * Element-wise vector operations, matrix products and vector transforms use SSE or NEON where available; everything
+     * else, and every function when VOODOO_NO_SIMD is defined, uses the scalar functions in Math::Reference. Vectors and
+     * matrices need no particular alignment.
+     */
+    namespace Math
+    {
+        /**
+         * Scalar implementations of every math function, always available to check the SIMD functions against.
+         */
+        namespace Reference
+        {
+            inline Float4 Add(_In_ CONST Float4 & a, _In_ CONST Float4 & b)
+            {
+                Float4 r = {a.X + b.X, a.Y + b.Y, a.Z + b.Z, a.W + b.W};
+                return r;
+            }
+
+            inline Float4 Subtract(_In_ CONST Float4 & a, _In_ CONST Float4 & b)
+            {
+                Float4 r = {a.X - b.X, a.Y - b.Y, a.Z - b.Z, a.W - b.W};
+                return r;
+            }
+
+            inline Float4 Multiply(_In_ CONST Float4 & a, _In_ CONST Float4 & b)
+            {
+                Float4 r = {a.X * b.X, a.Y * b.Y, a.Z * b.Z, a.W * b.W};
+                return r;
+            }
+
+            inline Float4 Scale(_In_ CONST Float4 & v, _In_ CONST float s)
+            {
+                Float4 r = {v.X * s, v.Y * s, v.Z * s, v.W * s};
+                return r;
+            }
+
+            inline Float4 Lerp(_In_ CONST Float4 & a, _In_ CONST Float4 & b, _In_ CONST float t)
+            {
+                Float4 r = {a.X + (b.X - a.X) * t, a.Y + (b.Y - a.Y) * t, a.Z + (b.Z - a.Z) * t, a.W + (b.W - a.W) * t};
+                return r;
+            }
+
+            inline float Dot(_In_ CONST Float4 & a, _In_ CONST Float4 & b)
+            {
+                return a.X * b.X + a.Y * b.Y + a.Z * b.Z + a.W * b.W;
+            }
+
+            inline float Dot(_In_ CONST Float3 & a, _In_ CONST Float3 & b)
+            {
+                return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+            }
+
+            inline Float3 Cross(_In_ CONST Float3 & a, _In_ CONST Float3 & b)
+            {
+                Float3 r = {a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X};
+                return r;
+            }
+
+            inline float Length(_In_ CONST Float3 & v)
+            {
+                return sqrtf(Dot(v, v));
+            }
+
+            /**
+             * Scales a vector to unit length. Zero vectors are returned as they are.
+             */
+            inline Float3 Normalize(_In_ CONST Float3 & v)
+            {
+                float length = Length(v);
+                if (length == 0.0f)
+                {
+                    return v;
+                }
+
+                Float3 r = {v.X / length, v.Y / length, v.Z / length};
+                return r;
+            }
+
+            inline Float4x4 Identity()
+            {
+                Float4x4 r =
+                {{
+                    {1.0f, 0.0f, 0.0f, 0.0f},
+                    {0.0f, 1.0f, 0.0f, 0.0f},
+                    {0.0f, 0.0f, 1.0f, 0.0f},
+                    {0.0f, 0.0f, 0.0f, 1.0f},
+                }};
+                return r;
+            }
+
+            inline Float4x4 Multiply(_In_ CONST Float4x4 & a, _In_ CONST Float4x4 & b)
+            {
+                Float4x4 r;
+                for (uint32_t row = 0; row < 4; ++row)
+                {
+                    for (uint32_t col = 0; col < 4; ++col)
+                    {
+                        r.M[row][col] = a.M[row][0] * b.M[0][col] + a.M[row][1] * b.M[1][col] +
+                                        a.M[row][2] * b.M[2][col] + a.M[row][3] * b.M[3][col];
+                    }
+                }
+                return r;
+            }
+
+            inline Float4x4 Transpose(_In_ CONST Float4x4 & m)
+            {
+                Float4x4 r;
+                for (uint32_t row = 0; row < 4; ++row)
+                {
+                    for (uint32_t col = 0; col < 4; ++col)
+                    {
+                        r.M[row][col] = m.M[col][row];
+                    }
+                }
+                return r;
+            }
+
+            /**
+             * Inverts a matrix by cofactor expansion.
+             *
+             * @param pDeterminant If given, receives the determinant.
+             * @return The inverse, or the identity if the matrix is singular.
+             */
+            inline Float4x4 Inverse(_In_ CONST Float4x4 & m, _Out_opt_ float * pDeterminant = nullptr)
+            {
+                CONST float (*a)[4] = m.M;
+
+                float s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+                float s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+                float s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+                float s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+                float s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+                float s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+
+                float c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+                float c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+                float c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+                float c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+                float c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+                float c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+
+                float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+                if (pDeterminant)
+                {
+                    *pDeterminant = det;
+                }
+
+                if (det == 0.0f)
+                {
+                    return Identity();
+                }
+
+                float inv = 1.0f / det;
+                Float4x4 r =
+                {{
+                    {
+                        ( a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * inv,
+                        (-a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3) * inv,
+                        ( a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * inv,
+                        (-a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3) * inv,
+                    },
+                    {
+                        (-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1) * inv,
+                        ( a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * inv,
+                        (-a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1) * inv,
+                        ( a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * inv,
+                    },
+                    {
+                        ( a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * inv,
+                        (-a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0) * inv,
+                        ( a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * inv,
+                        (-a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0) * inv,
+                    },
+                    {
+                        (-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0) * inv,
+                        ( a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * inv,
+                        (-a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0) * inv,
+                        ( a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * inv,
+                    },
+                }};
+                return r;
+            }
+
+            inline Float4x4 Translation(_In_ CONST Float3 & offset)
+            {
+                Float4x4 r = Identity();
+                r.M[3][0] = offset.X;
+                r.M[3][1] = offset.Y;
+                r.M[3][2] = offset.Z;
+                return r;
+            }
+
+            inline Float4x4 Scaling(_In_ CONST Float3 & scale)
+            {
+                Float4x4 r = Identity();
+                r.M[0][0] = scale.X;
+                r.M[1][1] = scale.Y;
+                r.M[2][2] = scale.Z;
+                return r;
+            }
+
+            inline Float4x4 RotationX(_In_ CONST float angle)
+            {
+                float s = sinf(angle), c = cosf(angle);
+                Float4x4 r = Identity();
+                r.M[1][1] = c;  r.M[1][2] = s;
+                r.M[2][1] = -s; r.M[2][2] = c;
+                return r;
+            }
+
+            inline Float4x4 RotationY(_In_ CONST float angle)
+            {
+                float s = sinf(angle), c = cosf(angle);
+                Float4x4 r = Identity();
+                r.M[0][0] = c;  r.M[0][2] = -s;
+                r.M[2][0] = s;  r.M[2][2] = c;
+                return r;
+            }
+
+            inline Float4x4 RotationZ(_In_ CONST float angle)
+            {
+                float s = sinf(angle), c = cosf(angle);
+                Float4x4 r = Identity();
+                r.M[0][0] = c;  r.M[0][1] = s;
+                r.M[1][0] = -s; r.M[1][1] = c;
+                return r;
+            }
+
+            inline Float4x4 LookAt(_In_ CONST Float3 & eye, _In_ CONST Float3 & at, _In_ CONST Float3 & up)
+            {
+                Float3 forward = {at.X - eye.X, at.Y - eye.Y, at.Z - eye.Z};
+                Float3 zaxis = Normalize(forward);
+                Float3 xaxis = Normalize(Cross(up, zaxis));
+                Float3 yaxis = Cross(zaxis, xaxis);
+
+                Float4x4 r =
+                {{
+                    {xaxis.X, yaxis.X, zaxis.X, 0.0f},
+                    {xaxis.Y, yaxis.Y, zaxis.Y, 0.0f},
+                    {xaxis.Z, yaxis.Z, zaxis.Z, 0.0f},
+                    {-Dot(xaxis, eye), -Dot(yaxis, eye), -Dot(zaxis, eye), 1.0f},
+                }};
+                return r;
+            }
+
+            /**
+             * Builds a perspective projection, mapping depth from @p zn to @p zf onto 0 to 1.
+             *
+             * @param fovY The vertical field of view.
+             * @param aspect The width of the view divided by its height.
+             */
+            inline Float4x4 Perspective(_In_ CONST float fovY, _In_ CONST float aspect, _In_ CONST float zn, _In_ CONST float zf)
+            {
+                float yscale = 1.0f / tanf(fovY * 0.5f);
+                float xscale = yscale / aspect;
+                float depth = zf / (zf - zn);
+
+                Float4x4 r =
+                {{
+                    {xscale, 0.0f, 0.0f, 0.0f},
+                    {0.0f, yscale, 0.0f, 0.0f},
+                    {0.0f, 0.0f, depth, 1.0f},
+                    {0.0f, 0.0f, -zn * depth, 0.0f},
+                }};
+                return r;
+            }
+
+            inline Float4 Transform(_In_ CONST Float4 & v, _In_ CONST Float4x4 & m)
+            {
+                Float4 r =
+                {
+                    v.X * m.M[0][0] + v.Y * m.M[1][0] + v.Z * m.M[2][0] + v.W * m.M[3][0],
+                    v.X * m.M[0][1] + v.Y * m.M[1][1] + v.Z * m.M[2][1] + v.W * m.M[3][1],
+                    v.X * m.M[0][2] + v.Y * m.M[1][2] + v.Z * m.M[2][2] + v.W * m.M[3][2],
+                    v.X * m.M[0][3] + v.Y * m.M[1][3] + v.Z * m.M[2][3] + v.W * m.M[3][3],
+                };
+                return r;
+            }
+
+            inline void Transform(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4 * pIn, _Out_writes_(count) Float4 * pOut, _In_ CONST Float4x4 & m)
+            {
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    pOut[i] = Transform(pIn[i], m);
+                }
+            }
+
+            /**
+             * Transforms a point (with w of 1), dividing the result by its w.
+             */
+            inline Float3 TransformPoint(_In_ CONST Float3 & p, _In_ CONST Float4x4 & m)
+            {
+                Float4 v = {p.X, p.Y, p.Z, 1.0f};
+                Float4 t = Transform(v, m);
+                float inv = (t.W != 0.0f) ? 1.0f / t.W : 1.0f;
+                Float3 r = {t.X * inv, t.Y * inv, t.Z * inv};
+                return r;
+            }
+
+            /**
+             * Transforms a direction (with w of 0), ignoring translation.
+             */
+            inline Float3 TransformNormal(_In_ CONST Float3 & n, _In_ CONST Float4x4 & m)
+            {
+                Float3 r =
+                {
+                    n.X * m.M[0][0] + n.Y * m.M[1][0] + n.Z * m.M[2][0],
+                    n.X * m.M[0][1] + n.Y * m.M[1][1] + n.Z * m.M[2][1],
+                    n.X * m.M[0][2] + n.Y * m.M[1][2] + n.Z * m.M[2][2],
+                };
+                return r;
+            }
+
+            /**
+             * Transforms a light into another space. The position is transformed as a point and the direction as a
+             * normal, then renormalized; range and attenuation are left as they are, so the matrix should not scale.
+             */
+            inline LightDesc TransformLight(_In_ CONST LightDesc & light, _In_ CONST Float4x4 & m)
+            {
+                LightDesc r = light;
+                r.Position = TransformPoint(light.Position, m);
+                r.Direction = Normalize(TransformNormal(light.Direction, m));
+                return r;
+            }
+        }
+
+#if defined(VOODOO_MATH_SSE) || defined(VOODOO_MATH_NEON)
+        /**
+         * Four-lane register operations for the SIMD backend.
+         */
+        namespace Lanes
+        {
+#   if defined(VOODOO_MATH_SSE)
+            typedef __m128 Type;
+
+            inline Type Load(_In_reads_(4) CONST float * p)                 { return _mm_loadu_ps(p); }
+            inline void Store(_Out_writes_(4) float * p, _In_ Type v)       { _mm_storeu_ps(p, v); }
+            inline Type Splat(_In_ CONST float s)                           { return _mm_set1_ps(s); }
+            inline Type Add(_In_ Type a, _In_ Type b)                       { return _mm_add_ps(a, b); }
+            inline Type Subtract(_In_ Type a, _In_ Type b)                  { return _mm_sub_ps(a, b); }
+            inline Type Multiply(_In_ Type a, _In_ Type b)                  { return _mm_mul_ps(a, b); }
+            inline Type MultiplyAdd(_In_ Type a, _In_ Type b, _In_ Type c)  { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#   else
+            typedef float32x4_t Type;
+
+            inline Type Load(_In_reads_(4) CONST float * p)                 { return vld1q_f32(p); }
+            inline void Store(_Out_writes_(4) float * p, _In_ Type v)       { vst1q_f32(p, v); }
+            inline Type Splat(_In_ CONST float s)                           { return vdupq_n_f32(s); }
+            inline Type Add(_In_ Type a, _In_ Type b)                       { return vaddq_f32(a, b); }
+            inline Type Subtract(_In_ Type a, _In_ Type b)                  { return vsubq_f32(a, b); }
+            inline Type Multiply(_In_ Type a, _In_ Type b)                  { return vmulq_f32(a, b); }
+            inline Type MultiplyAdd(_In_ Type a, _In_ Type b, _In_ Type c)  { return vmlaq_f32(c, a, b); }
+#   endif
+
+            /**
+             * Transforms a row vector by the matrix rows, as the sum of each row scaled by the matching component.
+             */
+            inline Type Transform(_In_reads_(4) CONST float * v, _In_ Type r0, _In_ Type r1, _In_ Type r2, _In_ Type r3)
+            {
+                Type result = Multiply(Splat(v[0]), r0);
+                result = MultiplyAdd(Splat(v[1]), r1, result);
+                result = MultiplyAdd(Splat(v[2]), r2, result);
+                return MultiplyAdd(Splat(v[3]), r3, result);
+            }
+        }
+
+        inline Float4 Add(_In_ CONST Float4 & a, _In_ CONST Float4 & b)
+        {
+            Float4 r;
+            Lanes::Store(&r.X, Lanes::Add(Lanes::Load(&a.X), Lanes::Load(&b.X)));
+            return r;
+        }
+
+        inline Float4 Subtract(_In_ CONST Float4 & a, _In_ CONST Float4 & b)
+        {
+            Float4 r;
+            Lanes::Store(&r.X, Lanes::Subtract(Lanes::Load(&a.X), Lanes::Load(&b.X)));
+            return r;
+        }
+
+        inline Float4 Multiply(_In_ CONST Float4 & a, _In_ CONST Float4 & b)
+        {
+            Float4 r;
+            Lanes::Store(&r.X, Lanes::Multiply(Lanes::Load(&a.X), Lanes::Load(&b.X)));
+            return r;
+        }
+
+        inline Float4 Scale(_In_ CONST Float4 & v, _In_ CONST float s)
+        {
+            Float4 r;
+            Lanes::Store(&r.X, Lanes::Multiply(Lanes::Load(&v.X), Lanes::Splat(s)));
+            return r;
+        }
+
+        inline Float4 Lerp(_In_ CONST Float4 & a, _In_ CONST Float4 & b, _In_ CONST float t)
+        {
+            Lanes::Type la = Lanes::Load(&a.X);
+            Float4 r;
+            Lanes::Store(&r.X, Lanes::MultiplyAdd(Lanes::Subtract(Lanes::Load(&b.X), la), Lanes::Splat(t), la));
+            return r;
+        }
+
+        inline Float4x4 Multiply(_In_ CONST Float4x4 & a, _In_ CONST Float4x4 & b)
+        {
+            Lanes::Type r0 = Lanes::Load(b.M[0]), r1 = Lanes::Load(b.M[1]), r2 = Lanes::Load(b.M[2]), r3 = Lanes::Load(b.M[3]);
+
+            Float4x4 r;
+            for (uint32_t row = 0; row < 4; ++row)
+            {
+                Lanes::Store(r.M[row], Lanes::Transform(a.M[row], r0, r1, r2, r3));
+            }
+            return r;
+        }
+
+        inline Float4 Transform(_In_ CONST Float4 & v, _In_ CONST Float4x4 & m)
+        {
+            Float4 r;
+            Lanes::Store(&r.X, Lanes::Transform(&v.X, Lanes::Load(m.M[0]), Lanes::Load(m.M[1]), Lanes::Load(m.M[2]), Lanes::Load(m.M[3])));
+            return r;
+        }
+
+        /**
+         * Transforms an array of vectors, loading the matrix once. The input and output may be the same array.
+         */
+        inline void Transform(_In_ CONST uint32_t count, _In_reads_(count) CONST Float4 * pIn, _Out_writes_(count) Float4 * pOut, _In_ CONST Float4x4 & m)
+        {
+            Lanes::Type r0 = Lanes::Load(m.M[0]), r1 = Lanes::Load(m.M[1]), r2 = Lanes::Load(m.M[2]), r3 = Lanes::Load(m.M[3]);
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                Lanes::Store(&pOut[i].X, Lanes::Transform(&pIn[i].X, r0, r1, r2, r3));
+            }
+        }
+#else
+        using Reference::Add;
+        using Reference::Subtract;
+        using Reference::Multiply;
+        using Reference::Scale;
+        using Reference::Lerp;
+        using Reference::Transform;
+#endif
+        using Reference::Dot;
+        using Reference::Cross;
+        using Reference::Length;
+        using Reference::Normalize;
+        using Reference::Identity;
+        using Reference::Transpose;
+        using Reference::Inverse;
+        using Reference::Translation;
+        using Reference::Scaling;
+        using Reference::RotationX;
+        using Reference::RotationY;
+        using Reference::RotationZ;
+        using Reference::LookAt;
+        using Reference::Perspective;
+        using Reference::TransformPoint;
+        using Reference::TransformNormal;
+        using Reference::TransformLight;
+    }
+}
@@ -0,0 +1,193 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooFramework.hpp"
+
+#if !defined(VOODOO_NO_STDLIB)
+namespace VoodooShader
+{
+    /**
+     * @ingroup voodoo_utility
+     * Fixed-size block allocator for objects created in bulk. Blocks are carved from slabs holding a set number of
+     * objects, so objects created together (such as the parameters, techniques and passes of one effect) sit next to each
+     * other in memory. Freed blocks are reused, most recently freed first; slabs are only released with the pool.
+     *
+     * Classes use a pool through VOODOO_DECLARE_POOLED and VOODOO_DEFINE_POOLED, which route their operator new and
+     * delete through a static pool. Objects still live when the pool is destroyed keep their memory, which is leaked.
+     */
+    class ObjectPool
+    {
+        struct FreeBlock
+        {
+            FreeBlock * pNext;
+        };
+
+    public:
+        /**
+         * Creates an empty pool. No memory is allocated until the first block is requested.
+         *
+         * @param size The size of each block, which will be rounded up to a multiple of 16 bytes.
+         * @param count The number of blocks in each slab.
+         */
+        ObjectPool(_In_ CONST size_t size, _In_ CONST uint32_t count) :
+            m_Size((size + 15) & ~static_cast<size_t>(15)), m_Count(count), m_Free(nullptr), m_Live(0)
+        {
+            InitializeCriticalSection(&m_Lock);
+        }
+
+        /**
+         * Releases the slabs, unless objects are still live. Static pools can be destroyed before objects released by
+         * other static destructors, so the slabs and lock are leaked in that case and a late Free stays safe.
+         */
+        ~ObjectPool()
+        {
+            if (m_Live > 0)
+            {
+                return;
+            }
+
+            std::vector<void *>::iterator slab = m_Slabs.begin();
+            while (slab != m_Slabs.end())
+            {
+                free(*slab);
+                ++slab;
+            }
+
+            DeleteCriticalSection(&m_Lock);
+        }
+
+        /**
+         * Allocates one block.
+         *
+         * @return The block, or nullptr if a new slab was needed and could not be allocated.
+         */
+        void * Alloc()
+        {
+            EnterCriticalSection(&m_Lock);
+
+            if (!m_Free)
+            {
+                this->Grow();
+            }
+
+            FreeBlock * pBlock = m_Free;
+            if (pBlock)
+            {
+                m_Free = pBlock->pNext;
+                ++m_Live;
+            }
+
+            LeaveCriticalSection(&m_Lock);
+            return pBlock;
+        }
+
+        void Free(_In_opt_ void * pBlock)
+        {
+            if (!pBlock) return;
+
+            EnterCriticalSection(&m_Lock);
+
+            FreeBlock * pFree = reinterpret_cast<FreeBlock *>(pBlock);
+            pFree->pNext = m_Free;
+            m_Free = pFree;
+            --m_Live;
+
+            LeaveCriticalSection(&m_Lock);
+        }
+
+        /**
+         * Retrieves the number of blocks currently allocated.
+         */
+        uint32_t GetLive() CONST
+        {
+            return m_Live;
+        }
+
+        /**
+         * Retrieves the number of blocks in all slabs.
+         */
+        uint32_t GetCapacity() CONST
+        {
+            return static_cast<uint32_t>(m_Slabs.size()) * m_Count;
+        }
+
+    private:
+        ObjectPool(CONST ObjectPool & other);
+        ObjectPool & operator=(CONST ObjectPool & other);
+
+        void Grow()
+        {
+            char * pSlab = static_cast<char *>(malloc(m_Size * m_Count));
+            if (!pSlab) return;
+
+            m_Slabs.push_back(pSlab);
+
+            // Push in reverse, so blocks are handed out in address order.
+            uint32_t index = m_Count;
+            while (index > 0)
+            {
+                --index;
+                FreeBlock * pBlock = reinterpret_cast<FreeBlock *>(pSlab + index * m_Size);
+                pBlock->pNext = m_Free;
+                m_Free = pBlock;
+            }
+        }
+
+        CRITICAL_SECTION m_Lock;
+        size_t m_Size;
+        uint32_t m_Count;
+        FreeBlock * m_Free;
+        uint32_t m_Live;
+        std::vector<void *> m_Slabs;
+    };
+
+    /**
+     * @ingroup voodoo_utility
+     * Declares pooled operator new and delete for a class, to be placed in the class body. The class must have a matching
+     * VOODOO_DEFINE_POOLED in one source file.
+     */
+#define VOODOO_DECLARE_POOLED() \
+    public: \
+        static void * operator new(size_t size); \
+        static void operator delete(void * pObj, size_t size); \
+    private: \
+        static ObjectPool s_Pool
+    /**
+     * @ingroup voodoo_utility
+     * Defines the pool for class @a cls, with @a count objects per slab. Objects of other sizes (derived classes) fall
+     * back to the global operators.
+     */
+#define VOODOO_DEFINE_POOLED(cls, count) \
+    ObjectPool cls::s_Pool(sizeof(cls), count); \
+    void * cls::operator new(size_t size) \
+    { \
+        if (size != sizeof(cls)) return ::operator new(size); \
+        void * pObj = s_Pool.Alloc(); \
+        if (!pObj) throw std::bad_alloc(); \
+        return pObj; \
+    } \
+    void cls::operator delete(void * pObj, size_t size) \
+    { \
+        if (size != sizeof(cls)) ::operator delete(pObj); \
+        else s_Pool.Free(pObj); \
+    }
+}
+#endif
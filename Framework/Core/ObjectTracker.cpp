@@ -0,0 +1,203 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+#include "VoodooFramework.hpp"
+#include "VoodooInternal.hpp"
+
+namespace VoodooShader
+{
+    namespace
+    {
+        /**
+         * Guards the registry list and the samples of every record. Records register and unregister from static
+         * constructors and destructors in every translation unit, in no defined order relative to this one, so the lock
+         * is created on first use and never destroyed. The first use is a record registering during module load, which
+         * runs under the loader lock.
+         */
+        class TrackerLock
+        {
+        public:
+            static void Enter() { EnterCriticalSection(Get()); }
+            static void Leave() { LeaveCriticalSection(Get()); }
+
+        private:
+            static CRITICAL_SECTION * Get()
+            {
+                static bool initialized = false;
+                static CRITICAL_SECTION lock;
+                if (!initialized)
+                {
+                    InitializeCriticalSection(&lock);
+                    initialized = true;
+                }
+                return &lock;
+            }
+        };
+
+        /** Constant-initialized, so valid before any record registers. */
+        ObjectTypeRecord * gTrackerHead = nullptr;
+    }
+
+    volatile LONG ObjectTracker::SampleRate = 0;
+
+    void ObjectTracker::Register(_In_ ObjectTypeRecord * pRecord)
+    {
+        if (!pRecord) return;
+
+        TrackerLock::Enter();
+        pRecord->pNext = gTrackerHead;
+        gTrackerHead = pRecord;
+        TrackerLock::Leave();
+    }
+
+    void ObjectTracker::Unregister(_In_ ObjectTypeRecord * pRecord)
+    {
+        if (!pRecord) return;
+
+        TrackerLock::Enter();
+        ObjectTypeRecord ** ppLink = &gTrackerHead;
+        while (*ppLink)
+        {
+            if (*ppLink == pRecord)
+            {
+                *ppLink = pRecord->pNext;
+                break;
+            }
+            ppLink = &(*ppLink)->pNext;
+        }
+        pRecord->pNext = nullptr;
+        TrackerLock::Leave();
+    }
+
+    void ObjectTracker::Sample(_In_ ObjectTypeRecord * pRecord, _In_ CONST void * pObject)
+    {
+        if (!pRecord) return;
+
+        // Capture outside the lock, skipping this function and ObjectTypeRecord::Add.
+        ObjectSample sample;
+        sample.pObject = pObject;
+        sample.Frames = CaptureStackBackTrace(2, VOODOO_TRACKER_FRAMES, sample.Stack, nullptr);
+
+        TrackerLock::Enter();
+        ObjectSample & slot = pRecord->Samples[pRecord->NextSample];
+        if (!slot.pObject)
+        {
+            ++pRecord->Sampled;
+        }
+        slot = sample;
+        pRecord->NextSample = (pRecord->NextSample + 1) % VOODOO_TRACKER_SAMPLES;
+        TrackerLock::Leave();
+    }
+
+    void ObjectTracker::Unsample(_In_ ObjectTypeRecord * pRecord, _In_ CONST void * pObject)
+    {
+        if (!pRecord) return;
+
+        TrackerLock::Enter();
+        for (uint32_t index = 0; index < VOODOO_TRACKER_SAMPLES; ++index)
+        {
+            if (pRecord->Samples[index].pObject == pObject)
+            {
+                pRecord->Samples[index].pObject = nullptr;
+                --pRecord->Sampled;
+                break;
+            }
+        }
+        TrackerLock::Leave();
+    }
+
+    bool ObjectTracker::GetStats(_In_ CONST uint32_t index, _Out_ ObjectStats * pStats)
+    {
+        if (!pStats) return false;
+
+        TrackerLock::Enter();
+        ObjectTypeRecord * pRecord = gTrackerHead;
+        uint32_t current = 0;
+        while (pRecord && current < index)
+        {
+            pRecord = pRecord->pNext;
+            ++current;
+        }
+
+        if (pRecord)
+        {
+            pStats->Name = pRecord->Name;
+            pStats->Size = pRecord->Size;
+            pStats->Live = static_cast<uint32_t>(pRecord->Live);
+            pStats->Created = static_cast<uint32_t>(pRecord->Created);
+            pStats->Bytes = static_cast<uint64_t>(pStats->Live) * pRecord->Size;
+        }
+        TrackerLock::Leave();
+
+        return (pRecord != nullptr);
+    }
+
+    void ObjectTracker::Log(_In_ ILogger * pLogger)
+    {
+        if (!pLogger) return;
+
+        TrackerLock::Enter();
+        ObjectTypeRecord * pRecord = gTrackerHead;
+        while (pRecord)
+        {
+            uint32_t live = static_cast<uint32_t>(pRecord->Live);
+            pLogger->LogMessage(VSLog_CoreInfo, VOODOO_CORE_NAME, StringFormat(VSTR("Objects of type %1%: %2% live (%3% bytes), %4% created.")) 
+                << pRecord->Name << live << (static_cast<uint64_t>(live) * pRecord->Size) << static_cast<uint32_t>(pRecord->Created));
+
+            for (uint32_t index = 0; index < VOODOO_TRACKER_SAMPLES; ++index)
+            {
+                CONST ObjectSample & sample = pRecord->Samples[index];
+                if (!sample.pObject) continue;
+
+                StringFormat stack(VSTR("Live %1% at %2%, created from:"));
+                stack << pRecord->Name << sample.pObject;
+                String frames = stack.ToString();
+
+                for (uint32_t frame = 0; frame < sample.Frames; ++frame)
+                {
+                    HMODULE module = nullptr;
+                    wchar_t moduleName[MAX_PATH];
+                    moduleName[0] = L'\0';
+                    GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                        reinterpret_cast<LPCWSTR>(sample.Stack[frame]), &module);
+                    if (module)
+                    {
+                        GetModuleFileName(module, moduleName, MAX_PATH);
+                    }
+
+                    String modulePath(moduleName);
+                    CONST void * pOffset = reinterpret_cast<CONST void *>(
+                        reinterpret_cast<uintptr_t>(sample.Stack[frame]) - reinterpret_cast<uintptr_t>(module));
+                    frames += (StringFormat(VSTR("\n    %1%+%2%")) << modulePath.Substr(modulePath.ReverseFind(L'\\') + 1) << pOffset).ToString();
+                }
+
+                pLogger->LogMessage(VSLog_CoreInfo, VOODOO_CORE_NAME, frames);
+            }
+
+            pRecord = pRecord->pNext;
+        }
+        TrackerLock::Leave();
+    }
+
+    void ObjectTracker::SetSampleRate(_In_ CONST uint32_t rate)
+    {
+        InterlockedExchange(&SampleRate, static_cast<LONG>(rate));
+    }
+}
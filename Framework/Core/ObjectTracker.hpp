@@ -0,0 +1,147 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooFramework.hpp"
+
+namespace VoodooShader
+{
+    /**
+     * @addtogroup voodoo_utility
+     * @{
+     */
+#define VOODOO_TRACKER_SAMPLES  4
+#define VOODOO_TRACKER_FRAMES   12
+
+    class ObjectTypeRecord;
+
+    /**
+     * Live objects of every tracked type in the current module. Not exported: each module using DeclareDebugCache()
+     * defines its own, and plugins report it from their @p PluginCanUnload export.
+     */
+    extern volatile LONG gModuleObjects;
+
+    /**
+     * Creation stack captured for a sampled object, kept while the object is alive.
+     */
+    struct ObjectSample
+    {
+        CONST void * pObject;
+        uint32_t Frames;
+        void * Stack[VOODOO_TRACKER_FRAMES];
+    };
+
+    /**
+     * Process-wide registry of object type records. Types register the first time an object is created, so the registry
+     * only lists types that have been used, and unregister when their module unloads. Stats are available through
+     * ICore::GetObjectStats() and ICore::LogObjects().
+     */
+    class VOODOO_API ObjectTracker
+    {
+    public:
+        static void Register(_In_ ObjectTypeRecord * pRecord);
+        static void Unregister(_In_ ObjectTypeRecord * pRecord);
+
+        /**
+         * Captures the calling stack for an object, replacing the oldest sample for the type.
+         */
+        static void Sample(_In_ ObjectTypeRecord * pRecord, _In_ CONST void * pObject);
+        static void Unsample(_In_ ObjectTypeRecord * pRecord, _In_ CONST void * pObject);
+
+        static bool GetStats(_In_ CONST uint32_t index, _Out_ ObjectStats * pStats);
+        static void Log(_In_ ILogger * pLogger);
+
+        /**
+         * Sets how often creation stacks are captured: one object in every @a rate, per type. 0 disables sampling.
+         */
+        static void SetSampleRate(_In_ CONST uint32_t rate);
+
+        static volatile LONG SampleRate;
+    };
+
+    /**
+     * Live count record for one object type, declared once at namespace scope in the source defining the type (usually
+     * through DeclareDebugCache()). Creating and destroying an object costs three interlocked operations, one of them on
+     * the module count; the registry lock is only taken for the first object and for sampled objects.
+     */
+    class ObjectTypeRecord
+    {
+    public:
+        ObjectTypeRecord(_In_z_ CONST wchar_t * name, _In_ CONST uint32_t size) :
+            Name(name), Size(size), Live(0), Created(0), Registered(0), Sampled(0), NextSample(0), pNext(nullptr)
+        {
+            ZeroMemory(Samples, sizeof(Samples));
+        }
+
+        ~ObjectTypeRecord()
+        {
+            if (Registered)
+            {
+                ObjectTracker::Unregister(this);
+            }
+        }
+
+        void Add(_In_ CONST void * pObject)
+        {
+            LONG created = InterlockedIncrement(&Created);
+            InterlockedIncrement(&Live);
+            InterlockedIncrement(&gModuleObjects);
+
+            if (!Registered && InterlockedCompareExchange(&Registered, 1, 0) == 0)
+            {
+                ObjectTracker::Register(this);
+            }
+
+            LONG rate = ObjectTracker::SampleRate;
+            if (rate > 0 && (created % rate) == 0)
+            {
+                ObjectTracker::Sample(this, pObject);
+            }
+        }
+
+        void Remove(_In_ CONST void * pObject)
+        {
+            InterlockedDecrement(&Live);
+            InterlockedDecrement(&gModuleObjects);
+
+            if (Sampled)
+            {
+                ObjectTracker::Unsample(this, pObject);
+            }
+        }
+
+        CONST wchar_t * Name;
+        uint32_t Size;
+        volatile LONG Live;
+        volatile LONG Created;
+        volatile LONG Registered;
+        volatile LONG Sampled;      /* !< Number of samples held, only changed under the registry lock. */
+        uint32_t NextSample;
+        ObjectTypeRecord * pNext;
+        ObjectSample Samples[VOODOO_TRACKER_SAMPLES];
+
+    private:
+        ObjectTypeRecord(CONST ObjectTypeRecord & other);
+        ObjectTypeRecord & operator=(CONST ObjectTypeRecord & other);
+    };
+    /**
+     * @}
+     */
+}
@@ -0,0 +1,157 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooFramework.hpp"
+
+#if !defined(VOODOO_NO_STDLIB)
+namespace VoodooShader
+{
+    /**
+     * @ingroup voodoo_utility
+     * Fixed slots for the well-known properties used by the bindings. Each of these is stored inline in a PropertyStore.
+     */
+    enum PropertySlot : uint32_t
+    {
+        VSPropSlot_D3D9Texture  = 0x00,
+        VSPropSlot_D3D9Surface  = 0x01,
+        VSPropSlot_D3DX9Effect  = 0x02,
+        VSPropSlot_D3DX9Handle  = 0x03,
+        VSPropSlot_D3DX9PassId  = 0x04,
+        VSPropSlot_Count        = 0x05,
+        VSPropSlot_Spill        = VSPropSlot_Count  /* !< Not a well-known property, stored in the spill map. */
+    };
+
+    /**
+     * @ingroup voodoo_utility
+     * Property storage for resources. Well-known properties live in fixed inline slots, which can be addressed at compile
+     * time through the templated accessors; any others are kept in a map that is only allocated once used.
+     */
+    class PropertyStore
+    {
+    public:
+        PropertyStore() :
+            m_Present(0), m_Spill(nullptr)
+        { }
+
+        ~PropertyStore()
+        {
+            delete m_Spill;
+        }
+
+        /**
+         * Finds the fixed slot for a property.
+         *
+         * @return The slot, or VSPropSlot_Spill if the property is not well-known.
+         */
+        static PropertySlot FindSlot(_In_ CONST Uuid & propid)
+        {
+            static CONST Uuid * CONST slotIds[VSPropSlot_Count] =
+            {
+                &PropIds::D3D9Texture,
+                &PropIds::D3D9Surface,
+                &PropIds::D3DX9Effect,
+                &PropIds::D3DX9Handle,
+                &PropIds::D3DX9PassId
+            };
+
+            uint32_t slot = 0;
+            while (slot < VSPropSlot_Count && !IsSameUuid(*slotIds[slot], propid))
+            {
+                ++slot;
+            }
+            return static_cast<PropertySlot>(slot);
+        }
+
+        template<PropertySlot Slot>
+        bool Has() CONST
+        {
+            return (m_Present & (1 << Slot)) != 0;
+        }
+
+        template<PropertySlot Slot>
+        CONST Variant & Get() CONST
+        {
+            return m_Slots[Slot];
+        }
+
+        template<PropertySlot Slot>
+        void Set(_In_ CONST Variant & value)
+        {
+            m_Slots[Slot] = value;
+            m_Present |= (1 << Slot);
+        }
+
+        /**
+         * Retrieves a property by ID.
+         *
+         * @return True if the property has been set, otherwise false and @a pValue is left untouched.
+         */
+        bool Get(_In_ CONST Uuid & propid, _Out_ Variant * pValue) CONST
+        {
+            PropertySlot slot = FindSlot(propid);
+            if (slot != VSPropSlot_Spill)
+            {
+                if (!(m_Present & (1 << slot))) return false;
+
+                (*pValue) = m_Slots[slot];
+                return true;
+            }
+            else if (m_Spill)
+            {
+                PropertyMap::const_iterator property = m_Spill->find(propid);
+                if (property != m_Spill->end())
+                {
+                    (*pValue) = property->second;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void Set(_In_ CONST Uuid & propid, _In_ CONST Variant & value)
+        {
+            PropertySlot slot = FindSlot(propid);
+            if (slot != VSPropSlot_Spill)
+            {
+                m_Slots[slot] = value;
+                m_Present |= (1 << slot);
+            }
+            else
+            {
+                if (!m_Spill)
+                {
+                    m_Spill = new PropertyMap();
+                }
+                (*m_Spill)[propid] = value;
+            }
+        }
+
+    private:
+        PropertyStore(CONST PropertyStore & other);
+        PropertyStore & operator=(CONST PropertyStore & other);
+
+        uint32_t m_Present;
+        Variant m_Slots[VSPropSlot_Count];
+        PropertyMap * m_Spill;
+    };
+}
+#endif
@@ -186,6 +186,9 @@ namespace VoodooShader
         case VSUT_PVoid:
             out << VSTR(", ") << v.VPVoid;
             break;
+        case VSUT_Array:
+            out << VSTR(", ") << v.VArray.ElementType << VSTR("[") << v.VArray.Count << VSTR("], ") << v.VArray.Data;
+            break;
         case VSUT_Unknown:
         default:
             break;
@@ -0,0 +1,154 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+/**
+ * Standalone micro-benchmark for reference count traffic: AddRef/Release pairs through a virtual interface, as
+ * IObject makes them, with a plain counter (the old release build SAFE_INCREMENT) and an interlocked one (what every
+ * build uses now), on one thread and with two threads sharing the object. Needs only a C++ compiler, for example:
+ *
+ *     g++ -std=c++11 -O2 -pthread -o RefCountBench RefCountBench.cpp && ./RefCountBench
+ *
+ * The interlocked counter is a sequentially consistent atomic, which compiles to the same locked instruction as
+ * InterlockedIncrement on x86. Returns zero when every count balances.
+ */
+#pragma warning(push,3)
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#pragma warning(pop)
+
+namespace
+{
+    int gFailures = 0;
+
+#define CHECK(expr) \
+    if (!(expr)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #expr); ++gFailures; }
+
+    const uint32_t Pairs = 50000000;
+
+    /**
+     * Stands in for IObject, only the reference methods.
+     */
+    class Counted
+    {
+    public:
+        virtual ~Counted() { }
+        virtual uint32_t AddRef() const = 0;
+        virtual uint32_t Release() const = 0;
+        virtual uint32_t GetRefs() const = 0;
+    };
+
+    class PlainCounted : public Counted
+    {
+    public:
+        PlainCounted() : m_Refs(1) { }
+        uint32_t AddRef() const { return ++m_Refs; }
+        uint32_t Release() const { return --m_Refs; }
+        uint32_t GetRefs() const { return m_Refs; }
+
+    private:
+        mutable uint32_t m_Refs;
+    };
+
+    class AtomicCounted : public Counted
+    {
+    public:
+        AtomicCounted() : m_Refs(1) { }
+        uint32_t AddRef() const { return m_Refs.fetch_add(1) + 1; }
+        uint32_t Release() const { return m_Refs.fetch_sub(1) - 1; }
+        uint32_t GetRefs() const { return m_Refs.load(); }
+
+    private:
+        mutable std::atomic<uint32_t> m_Refs;
+    };
+
+    // Read through a volatile pointer so the calls stay virtual, as they are across module boundaries
+    Counted * volatile gObject = nullptr;
+
+    void Churn(const uint32_t pairs)
+    {
+        for (uint32_t i = 0; i < pairs; ++i)
+        {
+            Counted * pObject = gObject;
+            pObject->AddRef();
+            pObject->Release();
+        }
+    }
+
+    double Time(Counted * pObject, const uint32_t threads)
+    {
+        gObject = pObject;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (threads == 1)
+        {
+            Churn(Pairs);
+        }
+        else
+        {
+            std::thread other(Churn, Pairs);
+            Churn(Pairs);
+            other.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return seconds * 1e9 / ((double)Pairs * threads);
+    }
+
+    void BenchSingle()
+    {
+        PlainCounted plain;
+        AtomicCounted atomic;
+
+        double plainNs = Time(&plain, 1);
+        double atomicNs = Time(&atomic, 1);
+        CHECK(plain.GetRefs() == 1);
+        CHECK(atomic.GetRefs() == 1);
+
+        printf("One thread:  plain %.2f ns, interlocked %.2f ns per AddRef/Release pair (%.1fx).\n", plainNs, atomicNs,
+            atomicNs / plainNs);
+    }
+
+    void BenchShared()
+    {
+        // The plain counter loses updates when shared, which is why it cannot be used; only the interlocked one is timed
+        AtomicCounted atomic;
+
+        double atomicNs = Time(&atomic, 2);
+        CHECK(atomic.GetRefs() == 1);
+
+        printf("Two threads: interlocked %.2f ns per AddRef/Release pair on a shared object.\n", atomicNs);
+    }
+}
+
+int main()
+{
+    BenchSingle();
+    BenchShared();
+
+    if (gFailures == 0)
+    {
+        printf("All reference counts balanced.\n");
+    }
+
+    return gFailures;
+}
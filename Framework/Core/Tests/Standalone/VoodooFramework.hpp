@@ -0,0 +1,174 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+/**
+ * Minimal stand-in for the framework header, with just what VSON.hpp and VSON.cpp use, so they can be built by the
+ * standalone tests without Windows or the rest of the core. Only the tests include this; see VSONTest.cpp.
+ */
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#define CONST const
+#define EXPLICIT explicit
+#define VOODOO_API
+#define VOODOO_CHECK_IMPL
+#define VSTR(arg) L ## arg
+
+#define _In_
+#define _In_z_
+#define _In_reads_(size)
+#define _Out_
+#define _Inout_opt_
+
+#define CP_UTF8 65001
+
+template<size_t Size>
+inline int sprintf_s(char (&buffer)[Size], const char * format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int count = vsnprintf(buffer, Size, format, args);
+    va_end(args);
+    return count;
+}
+
+template<size_t Size>
+inline int strcpy_s(char (&buffer)[Size], const char * str)
+{
+    snprintf(buffer, Size, "%s", str);
+    return 0;
+}
+
+/**
+ * UTF-8 decoding with the semantics VSON.cpp relies on: returns the number of characters, writing them if @a pWide
+ * is given.
+ */
+inline int MultiByteToWideChar(unsigned codePage, unsigned flags, const char * pBytes, int length, wchar_t * pWide, int wideLength)
+{
+    (void)codePage;
+    (void)flags;
+
+    int count = 0;
+    for (int i = 0; i < length; ++count)
+    {
+        unsigned char c = (unsigned char)pBytes[i];
+        int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : 0;
+        uint32_t ch = (extra == 0) ? c : (c & (0x3F >> extra));
+        for (++i; extra > 0 && i < length; --extra, ++i)
+        {
+            ch = (ch << 6) | ((unsigned char)pBytes[i] & 0x3F);
+        }
+
+        if (pWide)
+        {
+            if (count >= wideLength) return 0;
+            pWide[count] = (wchar_t)ch;
+        }
+    }
+    return count;
+}
+
+namespace VoodooShader
+{
+    class String
+    {
+    public:
+        String() { }
+        String(const wchar_t * str) : m_Data(str) { }
+        EXPLICIT String(const uint32_t size, const wchar_t * str) : m_Data(str, size) { }
+
+        void Clear() { m_Data.clear(); }
+        bool IsEmpty() const { return m_Data.empty(); }
+        bool EndsWith(const wchar_t ch) const { return !m_Data.empty() && m_Data[m_Data.size() - 1] == ch; }
+        const wchar_t * GetData() const { return m_Data.c_str(); }
+        bool operator==(const String & other) const { return m_Data == other.m_Data; }
+
+        std::string ToStringA() const
+        {
+            std::string out;
+            for (size_t i = 0; i < m_Data.size(); ++i)
+            {
+                uint32_t ch = (uint32_t)m_Data[i];
+                if (ch < 0x80)
+                {
+                    out += (char)ch;
+                }
+                else if (ch < 0x800)
+                {
+                    out += (char)(0xC0 | (ch >> 6));
+                    out += (char)(0x80 | (ch & 0x3F));
+                }
+                else
+                {
+                    out += (char)(0xE0 | (ch >> 12));
+                    out += (char)(0x80 | ((ch >> 6) & 0x3F));
+                    out += (char)(0x80 | (ch & 0x3F));
+                }
+            }
+            return out;
+        }
+
+    private:
+        std::wstring m_Data;
+    };
+
+    enum UnionType : uint32_t
+    {
+        VSUT_Unknown, VSUT_None, VSUT_Bool, VSUT_Int8, VSUT_UInt8, VSUT_Int16, VSUT_UInt16, VSUT_Int32, VSUT_UInt32,
+        VSUT_Float, VSUT_Double, VSUT_Uuid, VSUT_String
+    };
+
+    template<typename T>
+    struct Vector1
+    {
+        T X;
+    };
+
+    struct Variant
+    {
+        UnionType   Type;
+        uint32_t    Components;
+        union
+        {
+            bool                VBool;
+            Vector1<int8_t>     VInt8;
+            Vector1<uint8_t>    VUInt8;
+            Vector1<int16_t>    VInt16;
+            Vector1<uint16_t>   VUInt16;
+            Vector1<int32_t>    VInt32;
+            Vector1<uint32_t>   VUInt32;
+            Vector1<float>      VFloat;
+            Vector1<double>     VDouble;
+            String *            VPString;
+        };
+    };
+
+    inline Variant CreateVariant(const UnionType t)     { Variant var; memset(&var, 0, sizeof(var)); var.Type = t; return var; }
+    inline Variant CreateVariant(const bool & v)        { Variant var = CreateVariant(VSUT_Bool); var.VBool = v; return var; }
+    inline Variant CreateVariant(const int32_t & v)     { Variant var = CreateVariant(VSUT_Int32); var.Components = 1; var.VInt32.X = v; return var; }
+    inline Variant CreateVariant(const double & v)      { Variant var = CreateVariant(VSUT_Double); var.Components = 1; var.VDouble.X = v; return var; }
+}
+
+// Like the framework header, this brings in the VSON declarations for VSON.cpp
+#include "VSON.hpp"
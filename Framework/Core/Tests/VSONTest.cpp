@@ -0,0 +1,224 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+/**
+ * Standalone tests for the VSON reader and writer: documents written by VSONWriter are read back through VSONReader,
+ * and malformed documents must stop at VSON_Error. Builds against the stand-ins in Standalone/ in place of the
+ * framework header, for example:
+ *
+ *     g++ -std=c++11 -IStandalone -I- -I.. -o VSONTest VSONTest.cpp ../VSON.cpp && ./VSONTest
+ *
+ * The -I- keeps VSON.cpp from picking up the real VoodooFramework.hpp beside it.
+ *
+ * Pass --bench to also time reading a large generated document. Returns zero when every check passes.
+ */
+#include "VSON.hpp"
+
+#pragma warning(push,3)
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#pragma warning(pop)
+
+using VoodooShader::CreateVariant;
+using VoodooShader::String;
+using VoodooShader::VSONReader;
+using VoodooShader::VSONSlice;
+using VoodooShader::VSONWriter;
+
+namespace
+{
+    int gFailures = 0;
+
+#define CHECK(expr) \
+    if (!(expr)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #expr); ++gFailures; }
+
+    bool SliceIs(const VSONSlice & slice, const char * str)
+    {
+        return slice.Length == strlen(str) && memcmp(slice.Data, str, slice.Length) == 0;
+    }
+
+    void TestRoundTrip()
+    {
+        VSONWriter writer;
+        CHECK(writer.BeginObject(VSTR("Config"), VSTR("main")));
+        CHECK(writer.WriteProperty(VSTR("enabled"), CreateVariant(true)));
+        CHECK(writer.WriteProperty(VSTR("count"), CreateVariant((int32_t)-42)));
+        CHECK(writer.WriteProperty(VSTR("scale"), CreateVariant(2.0)));
+        CHECK(writer.WriteProperty(VSTR("path"), String(VSTR("C:\\dir\t\"x\""))));
+        CHECK(writer.WriteProperty(VSTR("target"), String(VSTR("$(games)")), true));
+        CHECK(writer.BeginObject(VSTR("Plugin")));
+        CHECK(writer.WriteProperty(VSTR("file"), String(VSTR("Voodoo_D3D9.dll"))));
+        CHECK(writer.EndObject());
+        CHECK(writer.EndObject());
+        CHECK(!writer.EndObject());
+
+        VSONReader reader(writer.GetData(), writer.GetLength());
+
+        String value;
+        bool flag = false;
+        int64_t integer = 0;
+        double decimal = 0.0;
+
+        CHECK(reader.Next() == VoodooShader::VSON_BeginObject);
+        CHECK(SliceIs(reader.GetType(), "Config") && SliceIs(reader.GetName(), "main"));
+        CHECK(reader.GetDepth() == 1);
+
+        CHECK(reader.Next() == VoodooShader::VSON_Property);
+        CHECK(SliceIs(reader.GetName(), "enabled") && reader.GetValueType() == VoodooShader::VSONT_Boolean);
+        CHECK(reader.GetBool(&flag) && flag);
+
+        CHECK(reader.Next() == VoodooShader::VSON_Property);
+        CHECK(reader.GetValueType() == VoodooShader::VSONT_Integer);
+        CHECK(reader.GetInteger(&integer) && integer == -42);
+
+        // Whole decimals keep their point, so they are not read back as integers
+        CHECK(reader.Next() == VoodooShader::VSON_Property);
+        CHECK(reader.GetValueType() == VoodooShader::VSONT_Decimal);
+        CHECK(reader.GetDecimal(&decimal) && decimal == 2.0);
+
+        CHECK(reader.Next() == VoodooShader::VSON_Property);
+        CHECK(reader.GetValueType() == VoodooShader::VSONT_String);
+        CHECK(reader.GetString(&value) && value == String(VSTR("C:\\dir\t\"x\"")));
+
+        CHECK(reader.Next() == VoodooShader::VSON_Property);
+        CHECK(reader.GetValueType() == VoodooShader::VSONT_Parsed);
+        CHECK(reader.GetString(&value) && value == String(VSTR("$(games)")));
+
+        CHECK(reader.Next() == VoodooShader::VSON_BeginObject);
+        CHECK(SliceIs(reader.GetType(), "Plugin") && reader.GetName().Length == 0);
+        CHECK(reader.Next() == VoodooShader::VSON_Property);
+        CHECK(reader.GetString(&value) && value == String(VSTR("Voodoo_D3D9.dll")));
+        CHECK(reader.Next() == VoodooShader::VSON_EndObject);
+
+        CHECK(reader.Next() == VoodooShader::VSON_EndObject);
+        CHECK(reader.GetDepth() == 0);
+        CHECK(reader.Next() == VoodooShader::VSON_End);
+        CHECK(reader.Next() == VoodooShader::VSON_End);
+    }
+
+    void TestLiteral()
+    {
+        VSONWriter writer;
+        CHECK(writer.WriteLiteral(VSTR("float4 main() : COLOR0 { return 0; }")));
+        CHECK(writer.BeginObject(VSTR("Effect")));
+        CHECK(writer.EndObject());
+
+        VSONReader reader(writer.GetData(), writer.GetLength());
+
+        CHECK(reader.Next() == VoodooShader::VSON_Literal);
+        CHECK(SliceIs(reader.GetValue(), "float4 main() : COLOR0 { return 0; }\n"));
+        CHECK(reader.Next() == VoodooShader::VSON_BeginObject);
+        CHECK(reader.Next() == VoodooShader::VSON_EndObject);
+        CHECK(reader.Next() == VoodooShader::VSON_End);
+    }
+
+    void TestUnclosed()
+    {
+        // LoadConfig relies on the reader reporting unclosed objects, it never sees VSON_End while one is open
+        const char open[] = "//# VSON-0.1\nConfig\n{\n    a = 1;\n    Inner\n    {\n    }\n";
+        VSONReader reader(open, sizeof(open) - 1);
+
+        CHECK(reader.Next() == VoodooShader::VSON_BeginObject);
+        CHECK(reader.Next() == VoodooShader::VSON_Property);
+        CHECK(reader.Next() == VoodooShader::VSON_BeginObject);
+        CHECK(reader.Next() == VoodooShader::VSON_EndObject);
+        CHECK(reader.Next() == VoodooShader::VSON_Error);
+        CHECK(reader.GetError() != nullptr);
+        CHECK(reader.Next() == VoodooShader::VSON_Error);
+
+        const char extra[] = "//# VSON-0.1\nConfig\n{\n}\n}\n";
+        VSONReader closed(extra, sizeof(extra) - 1);
+
+        CHECK(closed.Next() == VoodooShader::VSON_BeginObject);
+        CHECK(closed.Next() == VoodooShader::VSON_EndObject);
+        CHECK(closed.Next() == VoodooShader::VSON_Error);
+    }
+
+    /**
+     * Writes a config-like document with @a objects objects of a few properties each, then reads every element and
+     * value back, reporting the throughput.
+     */
+    void BenchParse(const uint32_t objects, const uint32_t passes)
+    {
+        VSONWriter writer;
+        for (uint32_t i = 0; i < objects; ++i)
+        {
+            writer.BeginObject(VSTR("Parameter"), VSTR("shadowMapSize"));
+            writer.WriteProperty(VSTR("enabled"), CreateVariant(true));
+            writer.WriteProperty(VSTR("index"), CreateVariant((int32_t)i));
+            writer.WriteProperty(VSTR("bias"), CreateVariant(0.0015));
+            writer.WriteProperty(VSTR("source"), String(VSTR("$(resources)\\textures\\noise.dds")), true);
+            writer.EndObject();
+        }
+        std::string doc(writer.GetData(), writer.GetLength());
+
+        uint64_t elements = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t pass = 0; pass < passes; ++pass)
+        {
+            VSONReader reader(doc.data(), (uint32_t)doc.length());
+            String value;
+            int64_t integer;
+            double decimal;
+            bool flag;
+
+            for (VoodooShader::VSONToken token = reader.Next(); token > VoodooShader::VSON_Error; token = reader.Next())
+            {
+                ++elements;
+                switch (reader.GetValueType())
+                {
+                case VoodooShader::VSONT_Boolean: reader.GetBool(&flag); break;
+                case VoodooShader::VSONT_Integer: reader.GetInteger(&integer); break;
+                case VoodooShader::VSONT_Decimal: reader.GetDecimal(&decimal); break;
+                case VoodooShader::VSONT_String:
+                case VoodooShader::VSONT_Parsed:  reader.GetString(&value); break;
+                default: break;
+                }
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double megabytes = (double)doc.length() * passes / (1024.0 * 1024.0);
+        printf("Parsed %u x %.2f MB (%llu elements) in %.3f s: %.1f MB/s, %.1f ns per element.\n", passes,
+            doc.length() / (1024.0 * 1024.0), (unsigned long long)elements, seconds, megabytes / seconds,
+            seconds * 1e9 / (double)elements);
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    TestRoundTrip();
+    TestLiteral();
+    TestUnclosed();
+
+    if (gFailures == 0)
+    {
+        printf("All VSON checks passed.\n");
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        BenchParse(100000, 10);
+    }
+
+    return gFailures;
+}
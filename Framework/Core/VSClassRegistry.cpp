@@ -0,0 +1,337 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+#include "VSClassRegistry.hpp"
+
+namespace VoodooShader
+{
+    VSClassRegistry::VSClassRegistry() :
+        m_Mask(0), m_Frozen(false)
+    { }
+
+    VSClassRegistry::~VSClassRegistry()
+    {
+        this->Clear();
+    }
+
+    bool VSClassRegistry::Add(_In_ CONST Uuid & clsid, _In_ CONST String & name, _In_ PluginRef module, _In_ CONST uint32_t index)
+    {
+        ClassRecord record;
+        record.ClsId = clsid;
+        record.Name = name;
+        record.Module = module;
+        record.Index = index;
+
+        return this->Append(record);
+    }
+
+    bool VSClassRegistry::AddDeferred(_In_ CONST Uuid & clsid, _In_ CONST String & name, _In_ CONST String & path)
+    {
+        ClassRecord record;
+        record.ClsId = clsid;
+        record.Name = name;
+        record.Index = 0;
+        record.Path = path;
+
+        return this->Append(record);
+    }
+
+    bool VSClassRegistry::Append(_In_ CONST ClassRecord & record)
+    {
+        if (this->Find(record.ClsId))
+        {
+            return false;
+        }
+
+        m_Records.push_back(record);
+        m_Records.back().IdHash = VSClassRegistry::HashId(record.ClsId);
+        m_Records.back().NameHash = VSClassRegistry::HashName(record.Name);
+        m_Frozen = false;
+
+        return true;
+    }
+
+    void VSClassRegistry::RemoveDeferred(_In_ CONST String & path)
+    {
+        std::vector<ClassRecord>::iterator iter = m_Records.begin();
+        while (iter != m_Records.end())
+        {
+            if (!iter->Module && iter->Path == path)
+            {
+                iter = m_Records.erase(iter);
+                m_Frozen = false;
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+
+    void VSClassRegistry::RemoveModule(_In_ CONST IPlugin * pModule)
+    {
+        std::vector<ClassRecord>::iterator iter = m_Records.begin();
+        while (iter != m_Records.end())
+        {
+            if (iter->Module.get() == pModule)
+            {
+                iter = m_Records.erase(iter);
+                m_Frozen = false;
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+
+    void VSClassRegistry::Clear()
+    {
+        m_Records.clear();
+        m_IdTable.clear();
+        m_NameTable.clear();
+        m_Mask = 0;
+        m_Frozen = false;
+    }
+
+    void VSClassRegistry::Freeze()
+    {
+        if (m_Frozen)
+        {
+            return;
+        }
+
+        // Keep the tables at most half full, so probe sequences stay short
+        uint32_t capacity = 8;
+        while (capacity < m_Records.size() * 2)
+        {
+            capacity <<= 1;
+        }
+
+        m_Mask = capacity - 1;
+        m_IdTable.assign(capacity, 0);
+        m_NameTable.assign(capacity, 0);
+
+        // Records are inserted in order, so the first class registered with a name is the one found
+        for (uint32_t record = 0; record < m_Records.size(); ++record)
+        {
+            this->InsertId(record);
+            this->InsertName(record);
+        }
+
+        m_Frozen = true;
+    }
+
+    void VSClassRegistry::InsertId(_In_ uint32_t record)
+    {
+        uint32_t pos = m_Records[record].IdHash & m_Mask;
+        uint32_t dist = 0;
+
+        for (;;)
+        {
+            uint32_t & slot = m_IdTable[pos];
+            if (slot == 0)
+            {
+                slot = record + 1;
+                return;
+            }
+
+            // Take the slot from any entry closer to its home, and carry that entry on instead
+            uint32_t slotDist = (pos - (m_Records[slot - 1].IdHash & m_Mask)) & m_Mask;
+            if (slotDist < dist)
+            {
+                uint32_t displaced = slot - 1;
+                slot = record + 1;
+                record = displaced;
+                dist = slotDist;
+            }
+
+            pos = (pos + 1) & m_Mask;
+            ++dist;
+        }
+    }
+
+    void VSClassRegistry::InsertName(_In_ uint32_t record)
+    {
+        uint32_t pos = m_Records[record].NameHash & m_Mask;
+        uint32_t dist = 0;
+        bool checkDuplicate = true;
+
+        for (;;)
+        {
+            uint32_t & slot = m_NameTable[pos];
+            if (slot == 0)
+            {
+                slot = record + 1;
+                return;
+            }
+
+            CONST ClassRecord & other = m_Records[slot - 1];
+            if (checkDuplicate && other.NameHash == m_Records[record].NameHash && other.Name == m_Records[record].Name)
+            {
+                return;
+            }
+
+            uint32_t slotDist = (pos - (other.NameHash & m_Mask)) & m_Mask;
+            if (slotDist < dist)
+            {
+                // A duplicate would have been found before this point, and displaced entries are already unique
+                uint32_t displaced = slot - 1;
+                slot = record + 1;
+                record = displaced;
+                dist = slotDist;
+                checkDuplicate = false;
+            }
+
+            pos = (pos + 1) & m_Mask;
+            ++dist;
+        }
+    }
+
+    CONST ClassRecord * VSClassRegistry::Find(_In_ CONST Uuid & clsid) CONST
+    {
+        if (!m_Frozen)
+        {
+            std::vector<ClassRecord>::const_iterator iter = m_Records.begin();
+            while (iter != m_Records.end())
+            {
+                if (iter->ClsId == clsid)
+                {
+                    return &(*iter);
+                }
+                ++iter;
+            }
+            return nullptr;
+        }
+
+        uint32_t hash = VSClassRegistry::HashId(clsid);
+        uint32_t pos = hash & m_Mask;
+        uint32_t dist = 0;
+
+        for (;;)
+        {
+            uint32_t slot = m_IdTable[pos];
+            if (slot == 0)
+            {
+                return nullptr;
+            }
+
+            CONST ClassRecord & record = m_Records[slot - 1];
+            if (record.IdHash == hash && record.ClsId == clsid)
+            {
+                return &record;
+            }
+
+            // Every entry past here is closer to its home than this one would be, so it cannot be present
+            if (((pos - (record.IdHash & m_Mask)) & m_Mask) < dist)
+            {
+                return nullptr;
+            }
+
+            pos = (pos + 1) & m_Mask;
+            ++dist;
+        }
+    }
+
+    CONST ClassRecord * VSClassRegistry::Find(_In_ CONST String & name) CONST
+    {
+        if (!m_Frozen)
+        {
+            std::vector<ClassRecord>::const_iterator iter = m_Records.begin();
+            while (iter != m_Records.end())
+            {
+                if (iter->Name == name)
+                {
+                    return &(*iter);
+                }
+                ++iter;
+            }
+            return nullptr;
+        }
+
+        uint32_t hash = VSClassRegistry::HashName(name);
+        uint32_t pos = hash & m_Mask;
+        uint32_t dist = 0;
+
+        for (;;)
+        {
+            uint32_t slot = m_NameTable[pos];
+            if (slot == 0)
+            {
+                return nullptr;
+            }
+
+            CONST ClassRecord & record = m_Records[slot - 1];
+            if (record.NameHash == hash && record.Name == name)
+            {
+                return &record;
+            }
+
+            if (((pos - (record.NameHash & m_Mask)) & m_Mask) < dist)
+            {
+                return nullptr;
+            }
+
+            pos = (pos + 1) & m_Mask;
+            ++dist;
+        }
+    }
+
+    uint32_t VSClassRegistry::GetCount() CONST
+    {
+        return static_cast<uint32_t>(m_Records.size());
+    }
+
+    CONST ClassRecord * VSClassRegistry::GetRecord(_In_ CONST uint32_t index) CONST
+    {
+        if (index < m_Records.size())
+        {
+            return &m_Records[index];
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    uint32_t VSClassRegistry::HashId(_In_ CONST Uuid & clsid)
+    {
+        // FNV-1a
+        CONST uint8_t * bytes = reinterpret_cast<CONST uint8_t *>(&clsid);
+        uint32_t hash = 2166136261U;
+        for (uint32_t i = 0; i < sizeof(Uuid); ++i)
+        {
+            hash = (hash ^ bytes[i]) * 16777619U;
+        }
+        return hash;
+    }
+
+    uint32_t VSClassRegistry::HashName(_In_ CONST String & name)
+    {
+        CONST wchar_t * chars = name.GetData();
+        uint32_t hash = 2166136261U;
+        while (chars && *chars)
+        {
+            hash = (hash ^ static_cast<uint32_t>(*chars)) * 16777619U;
+            ++chars;
+        }
+        return hash;
+    }
+}
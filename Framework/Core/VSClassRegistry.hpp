@@ -0,0 +1,104 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooInternal.hpp"
+
+namespace VoodooShader
+{
+    /**
+     * A class provided by a plugin. Classes listed in the plugin manifest whose module has not been loaded yet have no
+     * module, only the module's path.
+     */
+    struct ClassRecord
+    {
+        Uuid        ClsId;
+        String      Name;
+        PluginRef   Module;
+        uint32_t    Index;      /* !< Class index within the module. */
+        String      Path;       /* !< Module path, for deferred classes. */
+        uint32_t    IdHash;
+        uint32_t    NameHash;
+    };
+
+    /**
+     * Registry of the classes provided by plugins. Records are kept in a single array, indexed by open-addressed (robin
+     * hood) hash tables on the ClsId and on the name, so a lookup takes one hash and a probe or two.
+     *
+     * Classes are added while plugins load and the tables are built by Freeze(), once loading is done. Until then,
+     * lookups scan the records, so the registry is always correct but only fast once frozen.
+     */
+    class VSClassRegistry
+    {
+    public:
+        VSClassRegistry();
+        ~VSClassRegistry();
+
+        /**
+         * Adds a class, unless a class with the same ClsId has already been added. If the name is already in use, the
+         * class can only be found by ClsId.
+         *
+         * @return True if the class was added.
+         */
+        bool Add(_In_ CONST Uuid & clsid, _In_ CONST String & name, _In_ PluginRef module, _In_ CONST uint32_t index);
+        /**
+         * Adds a class whose module has not been loaded, with the same rules as Add().
+         */
+        bool AddDeferred(_In_ CONST Uuid & clsid, _In_ CONST String & name, _In_ CONST String & path);
+        /**
+         * Removes any deferred classes from the given module.
+         */
+        void RemoveDeferred(_In_ CONST String & path);
+        /**
+         * Removes all classes provided by the given module.
+         */
+        void RemoveModule(_In_ CONST IPlugin * pModule);
+        void Clear();
+
+        /**
+         * Builds the lookup tables, if any classes have changed since they were last built.
+         */
+        void Freeze();
+
+        CONST ClassRecord * Find(_In_ CONST Uuid & clsid) CONST;
+        CONST ClassRecord * Find(_In_ CONST String & name) CONST;
+
+        uint32_t GetCount() CONST;
+        CONST ClassRecord * GetRecord(_In_ CONST uint32_t index) CONST;
+
+    private:
+        VSClassRegistry(CONST VSClassRegistry & other);
+        VSClassRegistry & operator=(CONST VSClassRegistry & other);
+
+        static uint32_t HashId(_In_ CONST Uuid & clsid);
+        static uint32_t HashName(_In_ CONST String & name);
+
+        bool Append(_In_ CONST ClassRecord & record);
+        void InsertId(_In_ uint32_t record);
+        void InsertName(_In_ uint32_t record);
+
+        std::vector<ClassRecord> m_Records;
+        /** Tables of record index + 1, with 0 marking an empty slot. */
+        std::vector<uint32_t> m_IdTable;
+        std::vector<uint32_t> m_NameTable;
+        uint32_t m_Mask;
+        bool m_Frozen;
+    };
+}
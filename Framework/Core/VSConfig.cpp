@@ -0,0 +1,554 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+#include "VSConfig.hpp"
+// System
+#pragma warning(push,3)
+#include <shlwapi.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#pragma warning(pop)
+
+namespace VoodooShader
+{
+    static bool NameIs(_In_ CONST pugi::xml_node & node, _In_z_ CONST wchar_t * name)
+    {
+        return wcscmp(node.name(), name) == 0;
+    }
+
+    static void ReadVariables(_In_ CONST pugi::xml_node & node, _Inout_ ConfigDesc * pDesc)
+    {
+        for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+        {
+            if (NameIs(child, L"Variable"))
+            {
+                pDesc->Variables[child.attribute(L"name").value()] = child.child_value();
+            }
+        }
+    }
+
+    static void ReadExpressions(_In_ CONST pugi::xml_node & node, _Inout_ ConfigDesc * pDesc)
+    {
+        for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+        {
+            if (NameIs(child, L"Expression"))
+            {
+                pDesc->Expressions[child.attribute(L"name").value()] = child.child_value();
+            }
+        }
+    }
+
+    static void DiffMap(_In_ CONST StringMap & from, _In_ CONST StringMap & to, _Inout_ StringMap & changed, _Inout_ StringList & removed)
+    {
+        StringMap::const_iterator iter = to.begin();
+        while (iter != to.end())
+        {
+            StringMap::const_iterator old = from.find(iter->first);
+            if (old == from.end() || old->second != iter->second)
+            {
+                changed.insert(*iter);
+            }
+            ++iter;
+        }
+
+        iter = from.begin();
+        while (iter != from.end())
+        {
+            if (to.find(iter->first) == to.end())
+            {
+                removed.push_back(iter->first);
+            }
+            ++iter;
+        }
+    }
+
+    static void ReadLog(_In_ CONST pugi::xml_node & node, _Inout_ ConfigDesc * pDesc)
+    {
+        for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+        {
+            if (NameIs(child, L"File"))
+            {
+                pDesc->LogFile = child.child_value();
+            }
+            else if (NameIs(child, L"Append"))
+            {
+                pDesc->LogAppend = child.child_value();
+            }
+            else if (NameIs(child, L"Level"))
+            {
+                pDesc->LogFilter = child.child_value();
+            }
+        }
+    }
+
+    static void ReadPlugins(_In_ CONST pugi::xml_node & node, _Inout_ ConfigDesc * pDesc)
+    {
+        pDesc->PluginThreads = node.attribute(L"threads").value();
+        pDesc->PluginManifest = node.attribute(L"manifest").value();
+        pDesc->PluginReload = node.attribute(L"reload").value();
+
+        for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+        {
+            if (NameIs(child, L"Path"))
+            {
+                pDesc->PluginPaths.push_back(StringPair(child.child_value(), child.attribute(L"filter").value()));
+            }
+            else if (NameIs(child, L"File"))
+            {
+                pDesc->PluginFiles.push_back(child.child_value());
+            }
+        }
+    }
+
+    static void ReadClasses(_In_ CONST pugi::xml_node & node, _Inout_ ConfigDesc * pDesc)
+    {
+        for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+        {
+            if (NameIs(child, L"FileSystem"))
+            {
+                pDesc->FileSystem = child.child_value();
+            }
+            else if (NameIs(child, L"HookManager"))
+            {
+                pDesc->HookManager = child.child_value();
+            }
+        }
+    }
+
+    static void ReadSection(_In_ CONST pugi::xml_node & node, _In_ CONST String & prefix, _Inout_ ConfigValues * pValues)
+    {
+        for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+        {
+            if (child.type() != pugi::node_element)
+            {
+                continue;
+            }
+
+            String path = prefix.IsEmpty() ? String(child.name()) : prefix + VSTR('/') + child.name();
+
+            CONST wchar_t * text = child.child_value();
+            if (text && *text)
+            {
+                pValues->insert(StringPair(path, text));
+            }
+
+            ReadSection(child, path, pValues);
+        }
+    }
+
+    bool LoadConfig(_In_ CONST String & path, _Inout_ pugi::xml_document * pDoc)
+    {
+        if (!path.EndsWith(VSTR(".vson"), false))
+        {
+            pugi::xml_parse_result result = pDoc->load_file(path.GetData());
+            return (result) ? true : false;
+        }
+
+        std::ifstream file(path.GetData(), std::ios::in | std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::vector<char> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+
+        // Translate the VSON document into the config tree. Objects become elements, with the object name as the name
+        // attribute. The value property and literal regions become the element text, while other properties become both
+        // an attribute and a child element, so existing queries find them either way.
+        pDoc->reset();
+        pugi::xml_node node = *pDoc;
+
+        VSONReader reader(buffer.empty() ? nullptr : &buffer[0], (uint32_t)buffer.size());
+        String type, name, value;
+
+        for (;;)
+        {
+            VSONToken token = reader.Next();
+            if (token == VSON_End)
+            {
+                // Next() reports unclosed objects as VSON_Error, so the end is always at depth 0
+                return true;
+            }
+            else if (token == VSON_Error)
+            {
+                Throw(VOODOO_CORE_NAME, StringFormat(VSTR("Error parsing config '%1%' (line %2%): %3%")) << path <<
+                    reader.GetLine() << reader.GetError(), nullptr);
+            }
+            else if (token == VSON_BeginObject)
+            {
+                reader.GetType(&type);
+                node = node.append_child(type.GetData());
+
+                if (reader.GetName().Length > 0)
+                {
+                    reader.GetName(&name);
+                    node.append_attribute(L"name").set_value(name.GetData());
+                }
+            }
+            else if (token == VSON_EndObject)
+            {
+                node = node.parent();
+            }
+            else
+            {
+                reader.GetString(&value);
+
+                VSONSlice propName = reader.GetName();
+                if (token == VSON_Literal || (propName.Length == 5 && memcmp(propName.Data, "value", 5) == 0))
+                {
+                    node.append_child(pugi::node_pcdata).set_value(value.GetData());
+                }
+                else
+                {
+                    reader.GetName(&name);
+                    node.append_attribute(name.GetData()).set_value(value.GetData());
+                    node.append_child(name.GetData()).append_child(pugi::node_pcdata).set_value(value.GetData());
+                }
+            }
+        }
+    }
+
+    bool ReadConfig(_In_ CONST pugi::xml_document * pDoc, _Out_ ConfigDesc * pDesc)
+    {
+        *pDesc = ConfigDesc();
+
+        if (!pDoc)
+        {
+            return false;
+        }
+
+        pugi::xml_node configNode = pDoc->child(L"VoodooConfig");
+        pugi::xml_node globalNode = configNode.child(L"Global");
+        if (!globalNode)
+        {
+            return false;
+        }
+
+        for (pugi::xml_node child = globalNode.first_child(); child; child = child.next_sibling())
+        {
+            if (NameIs(child, L"Variables"))
+            {
+                ReadVariables(child, pDesc);
+            }
+            else if (NameIs(child, L"Expressions"))
+            {
+                ReadExpressions(child, pDesc);
+            }
+            else if (NameIs(child, L"Log"))
+            {
+                ReadLog(child, pDesc);
+            }
+            else if (NameIs(child, L"Plugins"))
+            {
+                ReadPlugins(child, pDesc);
+            }
+            else if (NameIs(child, L"Classes"))
+            {
+                ReadClasses(child, pDesc);
+            }
+            else if (NameIs(child, L"AutoReload"))
+            {
+                pDesc->AutoReload = child.child_value();
+            }
+        }
+
+        // Class sections, named by the Name attribute (or name, when translated from VSON)
+        pugi::xml_node classesNode = configNode.child(L"Classes");
+        for (pugi::xml_node child = classesNode.first_child(); child; child = child.next_sibling())
+        {
+            if (!NameIs(child, L"Class"))
+            {
+                continue;
+            }
+
+            pugi::xml_attribute nameAttr = child.attribute(L"Name");
+            if (!nameAttr)
+            {
+                nameAttr = child.attribute(L"name");
+            }
+
+            if (nameAttr)
+            {
+                ReadSection(child, String(), &pDesc->Classes[nameAttr.value()]);
+            }
+        }
+
+        return true;
+    }
+
+    uint32_t DiffConfig(_In_ CONST ConfigDesc & from, _In_ CONST ConfigDesc & to, _Out_ ConfigDiff * pDiff)
+    {
+        *pDiff = ConfigDiff();
+        pDiff->Changes = VSConfig_None;
+
+        // Variables
+        DiffMap(from.Variables, to.Variables, pDiff->Variables, pDiff->RemovedVariables);
+        if (!pDiff->Variables.empty() || !pDiff->RemovedVariables.empty())
+        {
+            pDiff->Changes |= VSConfig_Variables;
+        }
+
+        // Expressions
+        DiffMap(from.Expressions, to.Expressions, pDiff->Expressions, pDiff->RemovedExpressions);
+        if (!pDiff->Expressions.empty() || !pDiff->RemovedExpressions.empty())
+        {
+            pDiff->Changes |= VSConfig_Expressions;
+        }
+
+        // Log
+        if (from.LogFile != to.LogFile || from.LogAppend != to.LogAppend || from.LogFilter != to.LogFilter)
+        {
+            pDiff->Changes |= VSConfig_Log;
+        }
+
+        // Plugins, only new entries can be applied
+        StringPairList::const_iterator pathIter = to.PluginPaths.begin();
+        while (pathIter != to.PluginPaths.end())
+        {
+            if (std::find(from.PluginPaths.begin(), from.PluginPaths.end(), *pathIter) == from.PluginPaths.end())
+            {
+                pDiff->PluginPaths.push_back(*pathIter);
+            }
+            ++pathIter;
+        }
+
+        StringList::const_iterator fileIter = to.PluginFiles.begin();
+        while (fileIter != to.PluginFiles.end())
+        {
+            if (std::find(from.PluginFiles.begin(), from.PluginFiles.end(), *fileIter) == from.PluginFiles.end())
+            {
+                pDiff->PluginFiles.push_back(*fileIter);
+            }
+            ++fileIter;
+        }
+
+        if (!pDiff->PluginPaths.empty() || !pDiff->PluginFiles.empty() ||
+            from.PluginPaths.size() + pDiff->PluginPaths.size() != to.PluginPaths.size() ||
+            from.PluginFiles.size() + pDiff->PluginFiles.size() != to.PluginFiles.size())
+        {
+            pDiff->Changes |= VSConfig_Plugins;
+        }
+
+        // Classes
+        if (from.Classes != to.Classes)
+        {
+            pDiff->Changes |= VSConfig_Classes;
+        }
+
+        if (from.FileSystem != to.FileSystem || from.HookManager != to.HookManager)
+        {
+            pDiff->Changes |= VSConfig_Core;
+        }
+
+        return pDiff->Changes;
+    }
+
+    VSConfigWatcher::VSConfigWatcher(_In_ CONST String & path, _In_ CONST ConfigDesc & current) :
+        m_Path(path), m_Thread(nullptr), m_StopEvent(nullptr), m_Current(current), m_HasPending(0), m_HasReload(false)
+    {
+        ZeroMemory(&m_LastWrite, sizeof(FILETIME));
+
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (GetFileAttributesEx(m_Path.GetData(), GetFileExInfoStandard, &data))
+        {
+            m_LastWrite = data.ftLastWriteTime;
+        }
+
+        InitializeCriticalSection(&m_Lock);
+    }
+
+    VSConfigWatcher::~VSConfigWatcher()
+    {
+        if (m_Thread)
+        {
+            SetEvent(m_StopEvent);
+            WaitForSingleObject(m_Thread, INFINITE);
+            CloseHandle(m_Thread);
+            m_Thread = nullptr;
+        }
+
+        if (m_StopEvent)
+        {
+            CloseHandle(m_StopEvent);
+            m_StopEvent = nullptr;
+        }
+
+        DeleteCriticalSection(&m_Lock);
+    }
+
+    bool VSConfigWatcher::Start()
+    {
+        if (m_Thread)
+        {
+            return true;
+        }
+
+        m_StopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        if (!m_StopEvent)
+        {
+            return false;
+        }
+
+        m_Thread = CreateThread(nullptr, 0, &VSConfigWatcher::WatchThread, this, 0, nullptr);
+        return (m_Thread != nullptr);
+    }
+
+    bool VSConfigWatcher::TakePending
+    (
+        _Inout_ pugi::xml_document * pDoc, 
+        _Out_ ConfigDesc * pDesc, 
+        _Out_ ConfigDiff * pDiff, 
+        _Out_ String * pError
+    )
+    {
+        // Checked without the lock, so the render thread never waits when nothing has changed
+        if (InterlockedCompareExchange(&m_HasPending, 0, 0) == 0)
+        {
+            return false;
+        }
+
+        EnterCriticalSection(&m_Lock);
+
+        pDiff->Changes = VSConfig_None;
+        if (m_HasReload)
+        {
+            pDoc->reset(m_PendingDoc);
+            *pDesc = m_PendingDesc;
+            *pDiff = m_PendingDiff;
+
+            m_Current = m_PendingDesc;
+            m_PendingDoc.reset();
+            m_HasReload = false;
+        }
+
+        *pError = m_PendingError;
+        m_PendingError.Clear();
+
+        InterlockedExchange(&m_HasPending, 0);
+
+        LeaveCriticalSection(&m_Lock);
+
+        return true;
+    }
+
+    DWORD WINAPI VSConfigWatcher::WatchThread(_In_ LPVOID pParam)
+    {
+        reinterpret_cast<VSConfigWatcher*>(pParam)->Watch();
+        return 0;
+    }
+
+    void VSConfigWatcher::Watch()
+    {
+        wchar_t dir[MAX_PATH];
+        wcsncpy_s(dir, m_Path.GetData(), _TRUNCATE);
+        PathRemoveFileSpec(dir);
+
+        HANDLE change = FindFirstChangeNotification(dir, FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+        if (change == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+
+        HANDLE handles[2] = { m_StopEvent, change };
+        for (;;)
+        {
+            DWORD wait = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+            if (wait != WAIT_OBJECT_0 + 1)
+            {
+                break;
+            }
+
+            // Editors often save in several steps, give them a moment to finish
+            if (WaitForSingleObject(m_StopEvent, 100) == WAIT_OBJECT_0)
+            {
+                break;
+            }
+
+            // Other files in the directory also trigger notifications
+            WIN32_FILE_ATTRIBUTE_DATA data;
+            if (GetFileAttributesEx(m_Path.GetData(), GetFileExInfoStandard, &data) &&
+                CompareFileTime(&data.ftLastWriteTime, &m_LastWrite) != 0)
+            {
+                m_LastWrite = data.ftLastWriteTime;
+                this->Reload();
+            }
+
+            if (!FindNextChangeNotification(change))
+            {
+                break;
+            }
+        }
+
+        FindCloseChangeNotification(change);
+    }
+
+    void VSConfigWatcher::Reload()
+    {
+        pugi::xml_document doc;
+        ConfigDesc desc;
+        String error;
+
+        try
+        {
+            if (!LoadConfig(m_Path, &doc))
+            {
+                error = StringFormat(VSTR("Unable to load changed config file '%1%'.")) << m_Path;
+            }
+            else if (!ReadConfig(&doc, &desc))
+            {
+                error = StringFormat(VSTR("Could not find global config node in changed config file '%1%'.")) << m_Path;
+            }
+        }
+        catch (const Exception & exc)
+        {
+            error = exc.strwhat();
+        }
+        catch (const std::exception & exc)
+        {
+            error = exc.what();
+        }
+
+        EnterCriticalSection(&m_Lock);
+
+        if (error.IsEmpty())
+        {
+            // Diff against the last config taken, so untaken reloads are merged
+            ConfigDiff diff;
+            if (DiffConfig(m_Current, desc, &diff) != VSConfig_None)
+            {
+                m_PendingDoc.reset(doc);
+                m_PendingDesc = desc;
+                m_PendingDiff = diff;
+                m_HasReload = true;
+                InterlockedExchange(&m_HasPending, 1);
+            }
+        }
+        else
+        {
+            m_PendingError = error;
+            InterlockedExchange(&m_HasPending, 1);
+        }
+
+        LeaveCriticalSection(&m_Lock);
+    }
+}
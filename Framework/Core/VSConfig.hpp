@@ -0,0 +1,122 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooInternal.hpp"
+
+namespace VoodooShader
+{
+    /**
+     * Loads a config document from the given path, translating VSON configs (by extension) into the same tree.
+     *
+     * @return True if the file was found and loaded.
+     * @throws Exception if a VSON config was found but is malformed.
+     */
+    bool LoadConfig(_In_ CONST String & path, _Inout_ pugi::xml_document * pDoc);
+    /**
+     * Reads the config document into a config description. The global node and class sections are each walked once,
+     * dispatching on element names, in place of evaluating a query per setting.
+     *
+     * @param pDoc The config document.
+     * @param pDesc The description to fill, which is cleared first.
+     * @return True if the document contains a global config node.
+     */
+    bool ReadConfig(_In_ CONST pugi::xml_document * pDoc, _Out_ ConfigDesc * pDesc);
+
+    /**
+     * Changes between two configs, limited to those which can be applied while running.
+     */
+    struct ConfigDiff
+    {
+        uint32_t        Changes;            /* !< ConfigChange flags. */
+        StringMap       Variables;          /* !< Variables added or changed. */
+        StringList      RemovedVariables;
+        StringMap       Expressions;        /* !< Expressions added or changed. */
+        StringList      RemovedExpressions;
+        StringPairList  PluginPaths;        /* !< Plugin paths newly listed. */
+        StringList      PluginFiles;        /* !< Plugin files newly listed. */
+    };
+
+    /**
+     * Compares two configs.
+     *
+     * @param from The config currently applied.
+     * @param to The new config.
+     * @param pDiff The diff to fill.
+     * @return The ConfigChange flags, also stored in the diff.
+     */
+    uint32_t DiffConfig(_In_ CONST ConfigDesc & from, _In_ CONST ConfigDesc & to, _Out_ ConfigDiff * pDiff);
+
+    /**
+     * Watches the config file for changes, reloading and diffing it on a background thread. Reloads are queued until
+     * taken by the core, so the config is never changed while in use. This uses Win32 change notifications on the
+     * directory containing the config file.
+     */
+    class VSConfigWatcher
+    {
+    public:
+        /**
+         * Creates a watcher for the given file. Diffs are computed against the given config, then against each reloaded
+         * config in turn.
+         */
+        VSConfigWatcher(_In_ CONST String & path, _In_ CONST ConfigDesc & current);
+        ~VSConfigWatcher();
+
+        /**
+         * Starts the watch thread.
+         *
+         * @return True if the thread was started.
+         */
+        bool Start();
+        /**
+         * Takes the most recent reload, if one is pending.
+         *
+         * @param pDoc Receives a copy of the reloaded document.
+         * @param pDesc Receives the reloaded config.
+         * @param pDiff Receives the changes since the last reload taken.
+         * @param pError Receives any error that occurred while reloading, in which case the other values are unchanged.
+         * @return True if a reload or error was pending.
+         */
+        bool TakePending(_Inout_ pugi::xml_document * pDoc, _Out_ ConfigDesc * pDesc, _Out_ ConfigDiff * pDiff, _Out_ String * pError);
+
+    private:
+        VSConfigWatcher(CONST VSConfigWatcher & other);
+        VSConfigWatcher & operator=(CONST VSConfigWatcher & other);
+
+        static DWORD WINAPI WatchThread(_In_ LPVOID pParam);
+        void Watch();
+        void Reload();
+
+        String m_Path;
+        FILETIME m_LastWrite;
+        HANDLE m_Thread;
+        HANDLE m_StopEvent;
+
+        CRITICAL_SECTION m_Lock;
+        /** Last config taken, which reloads are diffed against. */
+        ConfigDesc m_Current;
+        volatile LONG m_HasPending;
+        bool m_HasReload;
+        pugi::xml_document m_PendingDoc;
+        ConfigDesc m_PendingDesc;
+        ConfigDiff m_PendingDiff;
+        String m_PendingError;
+    };
+}
@@ -22,12 +22,14 @@
 // Voodoo Core
 #include "VSPluginServer.hpp"
 #include "VSParser.hpp"
+#include "VSProfiler.hpp"
 // Voodoo Utility
 #include "Support.inl"
 // System
 #pragma warning(push)
 #pragma warning(disable: 4668)
 #include <shellapi.h>
+#include <vector>
 #pragma warning(pop)
 
 namespace VoodooShader
@@ -35,6 +37,7 @@ namespace VoodooShader
     #define VOODOO_DEBUG_TYPE VSCore
     DeclareDebugCache();
     HMODULE gCoreHandle = nullptr;
+    volatile LONG gModuleObjects = 0;
 
     _Check_return_ ICore * VOODOO_CALLTYPE CreateCore(_In_ uint32_t version)
     {
@@ -59,7 +62,8 @@ namespace VoodooShader
     }
 
     VSCore::VSCore(uint32_t version) :
-        m_Refs(0), m_Version(version), m_ConfigFile(nullptr)
+        m_Refs(0), m_Version(version), m_ConfigFile(nullptr), m_ConfigWatcher(nullptr), m_PluginThread(nullptr),
+        m_EventQueue(nullptr), m_Expressions(nullptr)
     {
 #if defined(VOODOO_DEBUG_MEMORY)
         _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
@@ -73,6 +77,8 @@ namespace VoodooShader
         m_Logger = CreateLogger();
         m_Parser = CreateParser();
         m_Server = CreateServer();
+        m_EventQueue = new VSEventQueue(this);
+        m_Expressions = new VSExpressionEngine(this);
 
         AddThisToDebugCache();
     };
@@ -81,6 +87,43 @@ namespace VoodooShader
     {
         RemoveThisFromDebugCache();
 
+        if (m_ConfigWatcher)
+        {
+            delete m_ConfigWatcher;
+            m_ConfigWatcher = nullptr;
+        }
+
+        // Plugin sets not yet registered are released, waiting for the worker mapping one to finish
+        if (m_PluginThread)
+        {
+            WaitForSingleObject(m_PluginThread, INFINITE);
+            CloseHandle(m_PluginThread);
+            m_PluginThread = nullptr;
+        }
+
+        std::list<PluginMapSet *>::iterator setIter = m_PluginSets.begin();
+        while (setIter != m_PluginSets.end())
+        {
+            VSPluginServer::DropSet(*setIter);
+            delete (*setIter);
+            ++setIter;
+        }
+        m_PluginSets.clear();
+
+        // Stops the event thread, which may still be calling handlers
+        if (m_EventQueue)
+        {
+            delete m_EventQueue;
+            m_EventQueue = nullptr;
+        }
+
+        // Parameters may clear their expressions as they are destroyed, which is ignored from here on
+        if (m_Expressions)
+        {
+            delete m_Expressions;
+            m_Expressions = nullptr;
+        }
+
         m_Parameters.clear();
         m_Textures.clear();
 
@@ -125,33 +168,16 @@ namespace VoodooShader
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
 
-        if (!ppOut)
-        {
-            return VSFERR_INVALIDPARAMS;
-        }
-        else
+        static CONST InterfaceMapEntry map[] =
         {
-            if (refid == IID_IObject)
-            {
-                *ppOut = static_cast<IObject*>(this);
-            }
-            else if (refid == IID_ICore)
-            {
-                *ppOut = static_cast<ICore*>(this);
-            }
-            else if (refid == CLSID_VSCore)
-            {
-                *ppOut = static_cast<VSCore*>(this);
-            }
-            else
-            {
-                *ppOut = nullptr;
-                return VSFERR_INVALIDUUID;
-            }
-
-            (*ppOut)->AddRef();
-            return VSF_OK;
-        }
+            VOODOO_INTERFACE_ENTRY(VSCore, IObject),
+            VOODOO_INTERFACE_ENTRY(VSCore, ICore),
+            VOODOO_CLASS_ENTRY(VSCore),
+            VOODOO_INTERFACE_MAP_END
+        };
+        static volatile LONG hint = 0;
+
+        return QueryInterfaceMap(this, map, &hint, refid, ppOut);
     }
 
     String VOODOO_METHODTYPE VSCore::ToString() CONST
@@ -169,6 +195,46 @@ namespace VoodooShader
     }
 
     _Check_return_ VOODOO_METHODDEF(VSCore::Init)(_In_z_ CONST wchar_t * config)
+    {
+        // Profile startup if requested, this must be known before anything else is done
+        VSProfiler * pProfiler = nullptr;
+        wchar_t profile[8];
+        DWORD profileLen = GetEnvironmentVariable(VSTR("VOODOO_PROFILE"), profile, _countof(profile));
+        if (profileLen > 0 && !(profileLen == 1 && profile[0] == L'0'))
+        {
+            pProfiler = new VSProfiler();
+            gProfiler = pProfiler;
+        }
+
+        VoodooResult result = VSF_FAIL;
+        {
+            VOODOO_PROFILE_SCOPE(VSTR("VSCore::Init"));
+            result = this->InitCore(config);
+        }
+
+        if (pProfiler)
+        {
+            gProfiler = nullptr;
+
+            String tracePath = m_Parser->Parse(m_Config.LogFile, VSParse_PathCanon);
+            if (tracePath.IsEmpty())
+            {
+                tracePath = m_Parser->Parse(VSTR("$(local)\\VoodooShader.log"), VSParse_PathCanon);
+            }
+            tracePath += VSTR(".trace.json");
+
+            if (pProfiler->Write(tracePath) && m_Logger)
+            {
+                m_Logger->LogMessage(VSLog_CoreInfo, VOODOO_CORE_NAME, StringFormat(VSTR("Startup trace written to '%1%'.")) << tracePath);
+            }
+
+            delete pProfiler;
+        }
+
+        return result;
+    }
+
+    VoodooResult VSCore::InitCore(_In_z_ CONST wchar_t * config)
     {
         if (config)
         {
@@ -181,6 +247,8 @@ namespace VoodooShader
 
         // Load variables, built-in first
         {
+            VOODOO_PROFILE_SCOPE(VSTR("System variables"));
+
             wchar_t buffer[MAX_PATH];	ZeroMemory(buffer, MAX_PATH);
 
             // Global path
@@ -215,15 +283,19 @@ namespace VoodooShader
         }
 
         // Command line processing
-        LPWSTR cmdline = GetCommandLine();
-        m_Parser->Add(VSTR("args"), cmdline, VSVar_System);
-
-        int cmdargc = 0;
-        LPWSTR * cmdargv = CommandLineToArgvW(cmdline, &cmdargc);
-        m_Parser->Add(VSTR("argc"), StringFormat(VSTR("%d")) << cmdargc, VSVar_System);
-        for (int i = 0; i < cmdargc; ++i)
         {
-            m_Parser->Add(StringFormat(VSTR("argv_%d")) << i, cmdargv[i], VSVar_System);
+            VOODOO_PROFILE_SCOPE(VSTR("Command line"));
+
+            LPWSTR cmdline = GetCommandLine();
+            m_Parser->Add(VSTR("args"), cmdline, VSVar_System);
+
+            int cmdargc = 0;
+            LPWSTR * cmdargv = CommandLineToArgvW(cmdline, &cmdargc);
+            m_Parser->Add(VSTR("argc"), StringFormat(VSTR("%d")) << cmdargc, VSVar_System);
+            for (int i = 0; i < cmdargc; ++i)
+            {
+                m_Parser->Add(StringFormat(VSTR("argv_%d")) << i, cmdargv[i], VSVar_System);
+            }
         }
 
         // Load the config
@@ -231,84 +303,60 @@ namespace VoodooShader
         {
             m_ConfigFile = new pugi::xml_document();
 
-            // Try loading the config file from each major location
-            String configPath = m_Parser->Parse(VSTR("$(config)"), VSParse_PathCanon);
-            pugi::xml_parse_result result = m_ConfigFile->load_file(configPath.GetData());
+            // Try loading the config file from each major location, falling back to VSON if no config was given
+            CONST wchar_t * configLocations[] =
+            {
+                VSTR("$(config)"), VSTR("$(startup)\\$(config)"), VSTR("$(local)\\$(config)"), VSTR("$(path)\\$(config)")
+            };
 
-            if (!result)
+            String configPath;
+            bool loaded = false;
+            for (uint32_t pass = 0; pass < 2 && !loaded; ++pass)
             {
-                configPath = m_Parser->Parse(VSTR("$(startup)\\$(config)"), VSParse_PathCanon);
-                result = m_ConfigFile->load_file(configPath.GetData());
-                if (!result)
+                if (pass > 0)
+                {
+                    if (config) break;
+                    m_Parser->Add(VSTR("config"), VSTR("VoodooShader.vson"), VSVar_System);
+                }
+
+                for (uint32_t i = 0; i < _countof(configLocations) && !loaded; ++i)
                 {
-                    configPath = m_Parser->Parse(VSTR("$(local)\\$(config)"), VSParse_PathCanon);
-                    result = m_ConfigFile->load_file(configPath.GetData());
-                    if (!result)
-                    {
-                        configPath = m_Parser->Parse(VSTR("$(path)\\$(config)"), VSParse_PathCanon);
-                        result = m_ConfigFile->load_file(configPath.GetData());
-                        if (!result)
-                        {
-                            Throw(VOODOO_CORE_NAME, VSTR("Unable to find or parse config file."), nullptr);
-                        }
-                    }
+                    configPath = m_Parser->Parse(configLocations[i], VSParse_PathCanon);
+
+                    VOODOO_PROFILE_SCOPE(VSTR("Config probe"), configPath.GetData());
+                    loaded = LoadConfig(configPath, m_ConfigFile);
                 }
             }
 
-            // Start setting things up
-            pugi::xml_node configRoot = static_cast<pugi::xml_node>(*m_ConfigFile);
-            pugi::xml_node globalNode = configRoot.select_single_node(L"/VoodooConfig/Global").node();
-            if (!globalNode)
+            if (!loaded)
             {
-                Throw(VOODOO_CORE_NAME, VSTR("Could not find global config node."), nullptr);
+                Throw(VOODOO_CORE_NAME, VSTR("Unable to find or parse config file."), nullptr);
             }
 
-            // Create query for node text, used multiple times
-            pugi::xpath_query xpq_getName(L"./@name");
-            pugi::xpath_query xpq_getText(L"./text()");
-
-            // Load variables
+            // Start setting things up
             {
-                pugi::xpath_query xpq_getVariables(L"./Variables/Variable");
-                pugi::xpath_node_set nodes = xpq_getVariables.evaluate_node_set(globalNode);
-                pugi::xpath_node_set::const_iterator iter = nodes.begin();
+                VOODOO_PROFILE_SCOPE(VSTR("Read config"));
 
-                while (iter != nodes.end())
+                if (!ReadConfig(m_ConfigFile, &m_Config))
                 {
-                    String name = xpq_getName.evaluate_string(*iter).c_str();
-                    String value = xpq_getText.evaluate_string(*iter).c_str();
-
-                    m_Parser->Add(name, value);
+                    Throw(VOODOO_CORE_NAME, VSTR("Could not find global config node."), nullptr);
+                }
 
-                    ++iter;
+                // Load variables
+                StringMap::const_iterator varIter = m_Config.Variables.begin();
+                while (varIter != m_Config.Variables.end())
+                {
+                    m_Parser->Add(varIter->first, varIter->second);
+                    ++varIter;
                 }
             }
 
             // Open the logger as early as possible
-            pugi::xpath_query logfQuery(L"./Log/File/text()");
-            pugi::xpath_query logaQuery(L"./Log/Append/text()");
-            pugi::xpath_query loglQuery(L"./Log/Level/text()");
-
-            String logFile  = m_Parser->Parse(logfQuery.evaluate_string(globalNode));
-            String logLevelStr = m_Parser->Parse(loglQuery.evaluate_string(globalNode));
-            String logAppendStr = m_Parser->Parse(logaQuery.evaluate_string(globalNode));
-
-            LogLevel logLevel = VSLog_Default;
-            try
-            {
-                logLevel = (LogLevel)stoi(logLevelStr.ToString());
-            }
-            catch (const std::exception & exc)
             {
-                UNREFERENCED_PARAMETER(exc);
-                logLevel = VSLog_Default;
+                VOODOO_PROFILE_SCOPE(VSTR("Open log"));
+                this->ApplyLog(nullptr);
             }
 
-            bool logAppend = logAppendStr.Compare(VSTR("true"), false) || logAppendStr.StartsWith("1");
-
-            m_Logger->Open(logFile, logAppend);
-            m_Logger->SetFilter(logLevel);
-
             // Log extended build information
             String configMsg = m_Parser->Parse(VSTR("Config loaded from '$(config)'."));
             m_Logger->LogMessage(VSLog_CoreNotice, VOODOO_CORE_NAME, configMsg);
@@ -316,48 +364,38 @@ namespace VoodooShader
 
 
             // Load plugins, starting with the core
-            m_Server->LoadPlugin(this, VSTR("$(core)"));
-
             {
-                pugi::xpath_query xpq_getPluginPaths(L"./Plugins/Path");
-                pugi::xpath_query xpq_getFilter(L"./@filter");
-                pugi::xpath_node_set nodes = xpq_getPluginPaths.evaluate_node_set(globalNode);
-                pugi::xpath_node_set::const_iterator iter = nodes.begin();
+                VOODOO_PROFILE_SCOPE(VSTR("LoadPlugin"), VSTR("$(core)"));
+                m_Server->LoadPlugin(this, VSTR("$(core)"));
+            }
 
-                while (iter != nodes.end())
+            {
+                StringPairList::const_iterator iter = m_Config.PluginPaths.begin();
+                while (iter != m_Config.PluginPaths.end())
                 {
-                    String filter = xpq_getFilter.evaluate_string(*iter);
-                    String path = xpq_getText.evaluate_string(*iter);
-
-                    m_Server->LoadPath(this, path, filter);
-
+                    VOODOO_PROFILE_SCOPE(VSTR("LoadPath"), iter->first.GetData());
+                    m_Server->LoadPath(this, iter->first, iter->second);
                     ++iter;
                 }
             }
 
+            if (!m_Config.PluginFiles.empty())
             {
-                pugi::xpath_query xpq_getPluginFiles(L"./Plugins/File");
-                pugi::xpath_node_set nodes = xpq_getPluginFiles.evaluate_node_set(globalNode);
-                pugi::xpath_node_set::const_iterator iter = nodes.begin();
-
-                while (iter != nodes.end())
-                {
-                    String file = xpq_getText.evaluate_string(*iter);
-
-                    m_Server->LoadPlugin(this, file);
-
-                    ++iter;
-                }
+                VOODOO_PROFILE_SCOPE(VSTR("LoadPlugins"));
+                std::vector<String> files(m_Config.PluginFiles.begin(), m_Config.PluginFiles.end());
+                m_Server->LoadPlugins(this, static_cast<uint32_t>(files.size()), &files[0]);
             }
 
             // Lookup classes
-            pugi::xpath_query fsQuery(L"./Classes/FileSystem/text()");
-            pugi::xpath_query hookQuery(L"./Classes/HookManager/text()");
-            String fsClass = m_Parser->Parse(fsQuery.evaluate_string(globalNode).c_str());
-            String hookClass = m_Parser->Parse(hookQuery.evaluate_string(globalNode).c_str());
+            String fsClass = m_Parser->Parse(m_Config.FileSystem);
+            String hookClass = m_Parser->Parse(m_Config.HookManager);
 
             // Load less vital classes
-            ObjectRef coreplugin = m_Server->CreateObject(this, hookClass);
+            ObjectRef coreplugin;
+            {
+                VOODOO_PROFILE_SCOPE(VSTR("CreateObject"), hookClass.GetData());
+                coreplugin = m_Server->CreateObject(this, hookClass);
+            }
             IHookManager * phm = nullptr;
             if (coreplugin && SUCCEEDED(coreplugin->QueryInterface(IID_IHookManager, (IObject**)&phm)) && phm)
             {
@@ -370,7 +408,10 @@ namespace VoodooShader
                 Throw(VOODOO_CORE_NAME, fmt, this);
             }
 
-            coreplugin = m_Server->CreateObject(this, fsClass);
+            {
+                VOODOO_PROFILE_SCOPE(VSTR("CreateObject"), fsClass.GetData());
+                coreplugin = m_Server->CreateObject(this, fsClass);
+            }
             IFileSystem * pfs = nullptr;
             if (coreplugin && SUCCEEDED(coreplugin->QueryInterface(IID_IFileSystem, (IObject**)&pfs)) && pfs)
             {
@@ -387,7 +428,23 @@ namespace VoodooShader
             m_Logger->LogMessage(VSLog_CoreInfo, VOODOO_CORE_NAME, VSTR("Core initialization complete."));
 
             // Call finalization events
-            this->CallEvent(EventIds::Finalize, 0, nullptr);
+            {
+                VOODOO_PROFILE_SCOPE(VSTR("Finalize"));
+                this->CallEvent(EventIds::Finalize, 0, nullptr);
+            }
+
+            // Watch the config for changes, if enabled
+            String autoReload = m_Parser->Parse(m_Config.AutoReload);
+            if (autoReload.Compare(VSTR("true"), false) || autoReload.StartsWith("1"))
+            {
+                m_ConfigWatcher = new VSConfigWatcher(configPath, m_Config);
+                if (!m_ConfigWatcher->Start())
+                {
+                    m_Logger->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, VSTR("Unable to start watching the config file."));
+                    delete m_ConfigWatcher;
+                    m_ConfigWatcher = nullptr;
+                }
+            }
 
             // Return
             return VSF_OK;
@@ -460,7 +517,13 @@ namespace VoodooShader
         m_Binding = pBinding;
         pBinding->Release();
 
-        return m_Binding->Init(count, pParams);
+        VoodooResult result = m_Binding->Init(count, pParams);
+        if (SUCCEEDED(result))
+        {
+            this->ApplyExpressions(m_Config.Expressions);
+        }
+
+        return result;
     }
 
     _Check_return_ VOODOO_METHODDEF(VSCore::Reset)()
@@ -470,19 +533,230 @@ namespace VoodooShader
         return VSF_OK;
     }
 
-    VOODOO_METHODDEF(VSCore::OnEvent)(_In_ Uuid event, _In_ Functions::CallbackFunc func)
+    VOODOO_METHODDEF(VSCore::Update)()
     {
+        if (m_Server)
+        {
+            m_Server->ReloadChanged(this);
+        }
+
+        VoodooResult result = this->ApplyConfig();
+        this->UpdatePlugins();
+
+        m_Expressions->Evaluate(m_Parameters);
+
+        // Deliver events posted during the frame, including any posted by the changes above
+        if (m_EventQueue->Deliver() > 0 && result == VSFOK_REDUNDANT)
+        {
+            result = VSF_OK;
+        }
+
+        return result;
+    }
+
+    VoodooResult VSCore::ApplyConfig()
+    {
+        if (!m_ConfigWatcher)
+        {
+            return VSFOK_REDUNDANT;
+        }
+
+        ConfigDesc config;
+        ConfigDiff diff;
+        String error;
+        if (!m_ConfigWatcher->TakePending(m_ConfigFile, &config, &diff, &error))
+        {
+            return VSFOK_REDUNDANT;
+        }
+
+        if (!error.IsEmpty())
+        {
+            m_Logger->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, StringFormat(VSTR("Config reload failed: %1%")) << error);
+        }
+
+        if (diff.Changes == VSConfig_None)
+        {
+            return VSFOK_REDUNDANT;
+        }
+
+        ConfigDesc previous = m_Config;
+        m_Config = config;
+
+        if (diff.Changes & VSConfig_Variables)
+        {
+            StringMap::const_iterator varIter = diff.Variables.begin();
+            while (varIter != diff.Variables.end())
+            {
+                m_Parser->Add(varIter->first, varIter->second);
+                ++varIter;
+            }
+
+            StringList::const_iterator removeIter = diff.RemovedVariables.begin();
+            while (removeIter != diff.RemovedVariables.end())
+            {
+                m_Parser->Remove(*removeIter);
+                ++removeIter;
+            }
+        }
+
+        if (diff.Changes & VSConfig_Log)
+        {
+            this->ApplyLog(&previous);
+        }
+
+        if (diff.Changes & VSConfig_Plugins)
+        {
+            // Searching and mapping modules runs their loader code, so they are mapped on a worker and only registered
+            // here once that has finished
+            PluginMapSet * pSet = new PluginMapSet();
+            static_cast<VSPluginServer *>(m_Server.get())->PrepareSet(this, diff.PluginPaths, diff.PluginFiles, pSet);
+            m_PluginSets.push_back(pSet);
+        }
+
+        if (diff.Changes & VSConfig_Expressions)
+        {
+            this->ApplyExpressions(diff.Expressions);
+
+            StringList::const_iterator removeIter = diff.RemovedExpressions.begin();
+            while (removeIter != diff.RemovedExpressions.end())
+            {
+                ParameterMap::iterator param = m_Parameters.find(*removeIter);
+                if (param != m_Parameters.end())
+                {
+                    m_Expressions->Remove(param->second.get());
+                }
+                ++removeIter;
+            }
+        }
+
+        if (diff.Changes & VSConfig_Core)
+        {
+            m_Logger->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, 
+                VSTR("Core classes changed in config, these will not be used until restarted."));
+        }
+
+        m_Logger->LogMessage(VSLog_CoreNotice, VOODOO_CORE_NAME, 
+            StringFormat(VSTR("Config reloaded from '%1%' (changes %2%).")) << m_Parser->Parse(VSTR("$(config)")) << diff.Changes);
+
+        Variant changes = CreateVariant(diff.Changes);
+        this->PostEvent(EventIds::ConfigChanged, 1, &changes, VSPost_Default);
+
+        return VSF_OK;
+    }
+
+    void VSCore::UpdatePlugins()
+    {
+        if (m_PluginThread)
+        {
+            if (WaitForSingleObject(m_PluginThread, 0) != WAIT_OBJECT_0)
+            {
+                return;
+            }
+
+            CloseHandle(m_PluginThread);
+            m_PluginThread = nullptr;
+
+            PluginMapSet * pSet = m_PluginSets.front();
+            m_PluginSets.pop_front();
+
+            static_cast<VSPluginServer *>(m_Server.get())->RegisterSet(this, pSet);
+            delete pSet;
+        }
+
+        if (m_PluginSets.empty())
+        {
+            return;
+        }
+
+        m_PluginThread = CreateThread(nullptr, 0, &VSCore::MapPluginsThread, m_PluginSets.front(), 0, nullptr);
+        if (!m_PluginThread)
+        {
+            m_Logger->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, VSTR("Unable to start plugin worker, mapping plugins on this thread."));
+
+            PluginMapSet * pSet = m_PluginSets.front();
+            m_PluginSets.pop_front();
+
+            VSPluginServer::MapSet(pSet);
+            static_cast<VSPluginServer *>(m_Server.get())->RegisterSet(this, pSet);
+            delete pSet;
+        }
+    }
+
+    DWORD WINAPI VSCore::MapPluginsThread(_In_ LPVOID pParam)
+    {
+        VSPluginServer::MapSet(reinterpret_cast<PluginMapSet *>(pParam));
+        return 0;
+    }
+
+    void VSCore::ApplyExpressions(_In_ CONST StringMap & expressions)
+    {
+        // Parameters can only be created once bound, Bind() applies the config again
+        if (!m_Binding) return;
+
+        StringMap::const_iterator exprIter = expressions.begin();
+        while (exprIter != expressions.end())
+        {
+            String expression = m_Parser->Parse(exprIter->second);
+
+            IParameter * pParam = nullptr;
+            ParameterMap::iterator param = m_Parameters.find(exprIter->first);
+            if (param != m_Parameters.end())
+            {
+                pParam = param->second.get();
+            }
+            else
+            {
+                ParameterDesc desc = {VSPT_Float, 1, VSExpressionEngine::GetComponents(expression), 0};
+                pParam = this->CreateParameter(exprIter->first, desc, nullptr);
+            }
+
+            if (pParam)
+            {
+                this->SetExpression(pParam, expression);
+            }
+            ++exprIter;
+        }
+    }
+
+    void VSCore::ApplyLog(_In_opt_ CONST ConfigDesc * pPrevious)
+    {
+        String logLevelStr = m_Parser->Parse(m_Config.LogFilter);
+
+        LogLevel logLevel = VSLog_Default;
         try
         {
-            if (m_Events.find(event) == m_Events.end())
+            logLevel = (LogLevel)stoi(logLevelStr.ToString());
+        }
+        catch (const std::exception & exc)
+        {
+            UNREFERENCED_PARAMETER(exc);
+            logLevel = VSLog_Default;
+        }
+
+        // Only reopen the log if the file changed, as opening may truncate it
+        if (!pPrevious || pPrevious->LogFile != m_Config.LogFile || pPrevious->LogAppend != m_Config.LogAppend)
+        {
+            String logFile  = m_Parser->Parse(m_Config.LogFile);
+            String logAppendStr = m_Parser->Parse(m_Config.LogAppend);
+            bool logAppend = logAppendStr.Compare(VSTR("true"), false) || logAppendStr.StartsWith("1");
+
+            if (m_Logger->IsOpen())
             {
-                EventCallbacks set;
-                m_Events.insert(std::pair<Uuid, EventCallbacks>(event, set));
+                m_Logger->Close();
             }
+            m_Logger->Open(logFile, logAppend);
+        }
 
-            m_Events[event].insert(func);
+        m_Logger->SetFilter(logLevel);
+    }
 
-            return VSF_OK;
+    VOODOO_METHODDEF(VSCore::OnEvent)(_In_ Uuid event, _In_ Functions::CallbackFunc func)
+    {
+        EventHandler handler = {func, nullptr, nullptr, 0};
+
+        try
+        {
+            return m_Events.Add(m_Events.GetSlot(event), handler);
         }
         catch (const std::exception & exc)
         {
@@ -496,18 +770,13 @@ namespace VoodooShader
         }
     }
 
-    VOODOO_METHODDEF(VSCore::DropEvent)(_In_ Uuid event, _In_ Functions::CallbackFunc func)
+    VOODOO_METHODDEF(VSCore::OnEvent)(_In_ Uuid event, _In_ Functions::EventFunc func, _In_opt_ void * pUser, _In_ int32_t priority)
     {
+        EventHandler handler = {nullptr, func, pUser, priority};
+
         try
         {
-            if (m_Events.find(event) == m_Events.end())
-            {
-                return VSF_OK;
-            }
-
-            m_Events[event].erase(func);
-
-            return VSF_OK;
+            return m_Events.Add(m_Events.GetSlot(event), handler);
         }
         catch (const std::exception & exc)
         {
@@ -521,35 +790,68 @@ namespace VoodooShader
         }
     }
 
+    VOODOO_METHODDEF(VSCore::DropEvent)(_In_ Uuid event, _In_ Functions::CallbackFunc func)
+    {
+        EventHandler handler = {func, nullptr, nullptr, 0};
+
+        return m_Events.Remove(m_Events.FindSlot(event), handler);
+    }
+
+    VOODOO_METHODDEF(VSCore::DropEvent)(_In_ Uuid event, _In_ Functions::EventFunc func, _In_opt_ void * pUser)
+    {
+        EventHandler handler = {nullptr, func, pUser, 0};
+
+        return m_Events.Remove(m_Events.FindSlot(event), handler);
+    }
+
+    VOODOO_METHODDEF_(uint32_t, VSCore::GetEventSlot)(_In_ Uuid event)
+    {
+        try
+        {
+            return m_Events.GetSlot(event);
+        }
+        catch (const std::exception & exc)
+        {
+            UNREFERENCED_PARAMETER(exc);
+            return VSEventTable::InvalidSlot;
+        }
+    }
+
     VOODOO_METHODDEF(VSCore::CallEvent)(_In_ Uuid event, _In_ uint32_t count, _In_reads_opt_(count) Variant * pArgs)
+    {
+        return this->CallEvent(m_Events.FindSlot(event), count, pArgs);
+    }
+
+    VOODOO_METHODDEF(VSCore::CallEvent)(_In_ uint32_t slot, _In_ uint32_t count, _In_reads_opt_(count) Variant * pArgs)
     {
         try
         {
-            std::map<Uuid, EventCallbacks>::iterator eventMapIter = m_Events.find(event);
-            if (eventMapIter == m_Events.end())
+            return m_Events.Call(this, slot, count, pArgs);
+        }
+        catch (const std::exception & exc)
+        {
+            if (m_Logger)
             {
-                return VSFERR_INVALIDPARAMS;
+                m_Logger->LogMessage(VSLog_CoreError, VOODOO_CORE_NAME, 
+                    StringFormat("Unable to call event slot %1%, exception: %2%") << slot << exc.what());
             }
 
-            EventCallbacks::iterator eventCallIter = eventMapIter->second.begin();
-            while (eventCallIter != eventMapIter->second.end())
-            {
-                VoodooResult vr = (*eventCallIter)(this, count, pArgs);
-                if (FAILED(vr))
-                {
-                    return vr;
-                }
-                ++eventCallIter;
-            }
+            return VSF_FAIL;
+        }
+    }
 
-            return VSF_OK;
+    VOODOO_METHODDEF(VSCore::PostEvent)(_In_ Uuid event, _In_ uint32_t count, _In_reads_opt_(count) CONST Variant * pArgs, _In_ uint32_t flags)
+    {
+        try
+        {
+            return m_EventQueue->Post(event, count, pArgs, flags);
         }
         catch (const std::exception & exc)
         {
             if (m_Logger)
             {
                 m_Logger->LogMessage(VSLog_CoreError, VOODOO_CORE_NAME, 
-                    StringFormat("Unable to call event %1%, exception: %2%") << event << exc.what());
+                    StringFormat("Unable to post event %1%, exception: %2%") << event << exc.what());
             }
 
             return VSF_FAIL;
@@ -591,6 +893,13 @@ namespace VoodooShader
         return m_ConfigFile;
     }
 
+    CONST ConfigDesc * VOODOO_METHODTYPE VSCore::GetConfigDesc() CONST
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        return (m_ConfigFile) ? &m_Config : nullptr;
+    }
+
     IEffect * VOODOO_METHODTYPE VSCore::CreateEffect(_In_ IFile * pFile)
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
@@ -626,10 +935,11 @@ namespace VoodooShader
         return effect;
     }
 
-    IParameter * VOODOO_METHODTYPE VSCore::CreateParameter(_In_ CONST String & name, _In_ CONST ParameterDesc desc)
+    IParameter * VOODOO_METHODTYPE VSCore::CreateParameter(_In_ CONST String & name, _In_ CONST ParameterDesc desc, _Out_opt_ ParameterHandle * pHandle)
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
 
+        if (pHandle) *pHandle = 0;
         if (!m_Binding) return nullptr;
 
         ParameterMap::iterator paramEntry = m_Parameters.find(name);
@@ -647,8 +957,17 @@ namespace VoodooShader
             try
             {
                 parameter = m_Binding->CreateParameter(name, desc);
+                if (!parameter)
+                {
+                    m_Logger->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, StringFormat(VSTR("Unable to create parameter %1%.")) << name);
+                    return nullptr;
+                }
 
                 m_Parameters[name] = parameter;
+                m_Expressions->Invalidate();
+
+                ParameterHandle handle = m_ParameterHandles.Add(parameter);
+                if (pHandle) *pHandle = handle;
 
                 m_Logger->LogMessage
                 (
@@ -669,10 +988,11 @@ namespace VoodooShader
         }
     }
 
-    ITexture * VOODOO_METHODTYPE VSCore::CreateTexture(_In_ CONST String & name, _In_ CONST TextureDesc pDesc)
+    ITexture * VOODOO_METHODTYPE VSCore::CreateTexture(_In_ CONST String & name, _In_ CONST TextureDesc pDesc, _Out_opt_ TextureHandle * pHandle)
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
 
+        if (pHandle) *pHandle = 0;
         if (!m_Binding) return nullptr;
 
         TextureMap::iterator textureEntry = m_Textures.find(name);
@@ -681,24 +1001,34 @@ namespace VoodooShader
         {
             m_Logger->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, 
                 StringFormat(VSTR("Trying to create texture with a duplicate name: %1%.")) << name);
+            if (pHandle) *pHandle = m_TextureHandles.Find(textureEntry->second.get());
             return textureEntry->second.get();
         }
         else
         {
             ITexture * texture = m_Binding->CreateTexture(name, pDesc);
+            if (!texture)
+            {
+                m_Logger->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, StringFormat(VSTR("Unable to create texture %1%.")) << name);
+                return nullptr;
+            }
 
             m_Textures[name] = texture;
 
+            TextureHandle handle = m_TextureHandles.Add(texture);
+            if (pHandle) *pHandle = handle;
+
             m_Logger->LogMessage(VSLog_CoreDebug, VOODOO_CORE_NAME, StringFormat(VSTR("Created texture %1%.")) << name);
 
             return texture;
         }
     }
 
-    ITexture * VOODOO_METHODTYPE VSCore::LoadTexture(_In_ CONST String & name, _In_ IFile * pFile)
+    ITexture * VOODOO_METHODTYPE VSCore::LoadTexture(_In_ CONST String & name, _In_ IFile * pFile, _Out_opt_ TextureHandle * pHandle)
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
         
+        if (pHandle) *pHandle = 0;
         if (!m_Binding) return nullptr;
         if (!pFile) return nullptr;
 
@@ -708,14 +1038,23 @@ namespace VoodooShader
         {
             m_Logger->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, 
                 StringFormat(VSTR("Trying to create texture with a duplicate name: %1%.")) << name);
+            if (pHandle) *pHandle = m_TextureHandles.Find(textureEntry->second.get());
             return textureEntry->second.get();
         }
         else
         {
             ITexture * texture = m_Binding->CreateTextureFromFile(name, pFile);
+            if (!texture)
+            {
+                m_Logger->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, StringFormat(VSTR("Unable to create texture %1%.")) << name);
+                return nullptr;
+            }
 
             m_Textures[name] = texture;
 
+            TextureHandle handle = m_TextureHandles.Add(texture);
+            if (pHandle) *pHandle = handle;
+
             m_Logger->LogMessage(VSLog_CoreDebug, VOODOO_CORE_NAME, StringFormat(VSTR("Created texture %1%.")) << name);
 
             return texture;
@@ -774,6 +1113,44 @@ namespace VoodooShader
         }
     }
 
+    ParameterHandle VOODOO_METHODTYPE VSCore::GetParameterHandle(_In_ CONST String & name) CONST
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        ParameterMap::const_iterator paramIter = m_Parameters.find(name);
+        if (paramIter == m_Parameters.end())
+        {
+            m_Logger->LogMessage(VSLog_CoreDebug, VOODOO_CORE_NAME, StringFormat(VSTR("Unable to find parameter %1%.")) << name);
+            return 0;
+        }
+
+        return m_ParameterHandles.Find(paramIter->second.get());
+    }
+
+    TextureHandle VOODOO_METHODTYPE VSCore::GetTextureHandle(_In_ CONST String & name) CONST
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        TextureMap::const_iterator textureEntry = m_Textures.find(name);
+        if (textureEntry == m_Textures.end())
+        {
+            m_Logger->LogMessage(VSLog_CoreDebug, VOODOO_CORE_NAME, StringFormat(VSTR("Unable to find texture %1%.")) << name);
+            return 0;
+        }
+
+        return m_TextureHandles.Find(textureEntry->second.get());
+    }
+
+    IParameter * VOODOO_METHODTYPE VSCore::ResolveParameter(_In_ CONST ParameterHandle handle) CONST
+    {
+        return m_ParameterHandles.Resolve(handle);
+    }
+
+    ITexture * VOODOO_METHODTYPE VSCore::ResolveTexture(_In_ CONST TextureHandle handle) CONST
+    {
+        return m_TextureHandles.Resolve(handle);
+    }
+
     VoodooResult VOODOO_METHODTYPE VSCore::RemoveParameter(_In_ CONST String & name)
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
@@ -783,6 +1160,9 @@ namespace VoodooShader
         ParameterMap::iterator parameter = m_Parameters.find(name);
         if (parameter != m_Parameters.end())
         {
+            m_Expressions->Remove(parameter->second.get());
+            m_Expressions->Invalidate();
+            m_ParameterHandles.Remove(m_ParameterHandles.Find(parameter->second.get()));
             m_Parameters.erase(parameter);
             m_Logger->LogMessage(VSLog_CoreDebug, VOODOO_CORE_NAME, StringFormat(VSTR("Removed parameter %1%.")) << name);
             return VSF_OK;
@@ -803,6 +1183,7 @@ namespace VoodooShader
         TextureMap::iterator texture = m_Textures.find(name);
         if (texture != m_Textures.end())
         {
+            m_TextureHandles.Remove(m_TextureHandles.Find(texture->second.get()));
             m_Textures.erase(texture);
             m_Logger->LogMessage(VSLog_CoreDebug, VOODOO_CORE_NAME, StringFormat(VSTR("Removed texture %1%.")) << name);
             return VSF_OK;
@@ -813,4 +1194,56 @@ namespace VoodooShader
             return VSFERR_INVALIDPARAMS;
         }
     }
+
+    VoodooResult VOODOO_METHODTYPE VSCore::SetExpression(_In_ IParameter * pParam, _In_ CONST String & expression)
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        if (!m_Expressions) return VSFERR_INVALIDCALL;
+        if (!pParam) return VSFERR_INVALIDPARAMS;
+
+        // Only global parameters can be read by other expressions
+        String name;
+        ParameterMap::const_iterator param = m_Parameters.find(pParam->GetName());
+        if (param != m_Parameters.end() && param->second.get() == pParam)
+        {
+            name = param->first;
+        }
+
+        VoodooResult result = m_Expressions->Set(pParam, name, expression);
+        if (SUCCEEDED(result) && !expression.IsEmpty())
+        {
+            m_Logger->LogMessage(VSLog_CoreDebug, VOODOO_CORE_NAME,
+                StringFormat(VSTR("Set expression for parameter %1% to '%2%'.")) << pParam << expression);
+        }
+
+        return result;
+    }
+
+    VoodooResult VOODOO_METHODTYPE VSCore::GetObjectStats(_In_ CONST uint32_t index, _Out_ ObjectStats * pStats) CONST
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        if (!pStats) return VSFERR_INVALIDPARAMS;
+
+        return ObjectTracker::GetStats(index, pStats) ? VSF_OK : VSFERR_INVALIDPARAMS;
+    }
+
+    VoodooResult VOODOO_METHODTYPE VSCore::SetObjectSampling(_In_ CONST uint32_t rate)
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        ObjectTracker::SetSampleRate(rate);
+        return VSF_OK;
+    }
+
+    VoodooResult VOODOO_METHODTYPE VSCore::LogObjects() CONST
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        if (!m_Logger) return VSFERR_INVALIDCALL;
+
+        ObjectTracker::Log(m_Logger.get());
+        return VSF_OK;
+    }
 }
@@ -20,11 +20,11 @@
 #pragma once
 
 #include "VoodooInternal.hpp"
-
-#pragma warning(push,3)
-#include <map>
-#include <set>
-#pragma warning(pop)
+#include "VSConfig.hpp"
+#include "VSEventQueue.hpp"
+#include "VSEventTable.hpp"
+#include "VSExpressionEngine.hpp"
+#include "VSHandleTable.hpp"
 
 namespace VoodooShader
 {
@@ -33,6 +33,8 @@ namespace VoodooShader
      */
     extern HMODULE gCoreHandle;
 
+    struct PluginMapSet;
+
     /**
      * ICore engine class for the Voodoo Shader Framework. Provides centralized management and handling for
      * shaders, textures, plugins and variable/configuration mechanics.
@@ -41,9 +43,6 @@ namespace VoodooShader
      */
     VOODOO_CLASS(VSCore, ICore, ({0x9B, 0x12, 0xF3, 0xE6, 0xAF, 0x05, 0xE1, 0x11, 0x9E, 0x05, 0x00, 0x50, 0x56, 0xC0, 0x00, 0x08}))
     {
-        typedef std::set<Functions::CallbackFunc> EventCallbacks;
-        typedef std::map<Uuid, EventCallbacks> EventRegistry;
-
     public:
         VSCore(uint32_t version);
 
@@ -58,25 +57,41 @@ namespace VoodooShader
         _Check_return_ VOODOO_METHOD(Init)(_In_z_ CONST wchar_t * config);
         _Check_return_ VOODOO_METHOD(Bind)(_In_ CONST CompilerProfile profile, _In_ CONST uint32_t count, _In_reads_(count) Variant * pParams);
         _Check_return_ VOODOO_METHOD(Reset)();
+        VOODOO_METHOD(Update)();
 
         VOODOO_METHOD(OnEvent)(_In_ CONST Uuid event, _In_ Functions::CallbackFunc func);
+        VOODOO_METHOD(OnEvent)(_In_ CONST Uuid event, _In_ Functions::EventFunc func, _In_opt_ void * pUser, _In_ CONST int32_t priority);
         VOODOO_METHOD(DropEvent)(_In_ CONST Uuid event, _In_ Functions::CallbackFunc func);
+        VOODOO_METHOD(DropEvent)(_In_ CONST Uuid event, _In_ Functions::EventFunc func, _In_opt_ void * pUser);
+        VOODOO_METHOD_(uint32_t, GetEventSlot)(_In_ CONST Uuid event);
         VOODOO_METHOD(CallEvent)(_In_ CONST Uuid event, _In_ CONST uint32_t count, _In_reads_opt_(count) Variant * pArgs);
+        VOODOO_METHOD(CallEvent)(_In_ CONST uint32_t slot, _In_ CONST uint32_t count, _In_reads_opt_(count) Variant * pArgs);
+        VOODOO_METHOD(PostEvent)(_In_ CONST Uuid event, _In_ CONST uint32_t count, _In_reads_opt_(count) CONST Variant * pArgs, _In_ CONST uint32_t flags);
 
         VOODOO_METHOD_(XmlDocument, GetConfig)() CONST;
+        VOODOO_METHOD_(CONST ConfigDesc *, GetConfigDesc)() CONST;
         VOODOO_METHOD_(IFileSystem *, GetFileSystem)() CONST;
         VOODOO_METHOD_(IHookManager *, GetHookManager)() CONST;
         VOODOO_METHOD_(ILogger *, GetLogger)() CONST;
         VOODOO_METHOD_(IParser *, GetParser)() CONST;
 
         VOODOO_METHOD_(IEffect *, CreateEffect)(_In_ IFile * pFile); 
-        VOODOO_METHOD_(IParameter *, CreateParameter)(_In_ CONST String & name, _In_ CONST ParameterDesc desc);
-        VOODOO_METHOD_(ITexture *, CreateTexture)(_In_ CONST String & name, _In_ CONST TextureDesc desc);
-        VOODOO_METHOD_(ITexture *, LoadTexture)(_In_ CONST String & name, _In_ IFile * pFile);
+        VOODOO_METHOD_(IParameter *, CreateParameter)(_In_ CONST String & name, _In_ CONST ParameterDesc desc, _Out_opt_ ParameterHandle * pHandle);
+        VOODOO_METHOD_(ITexture *, CreateTexture)(_In_ CONST String & name, _In_ CONST TextureDesc desc, _Out_opt_ TextureHandle * pHandle);
+        VOODOO_METHOD_(ITexture *, LoadTexture)(_In_ CONST String & name, _In_ IFile * pFile, _Out_opt_ TextureHandle * pHandle);
         VOODOO_METHOD_(IParameter *, GetParameter)(_In_ CONST String & name, _In_ CONST ParameterDesc desc) CONST;
         VOODOO_METHOD_(ITexture *, GetTexture)(_In_ CONST String & name) CONST;
+        VOODOO_METHOD_(ParameterHandle, GetParameterHandle)(_In_ CONST String & name) CONST;
+        VOODOO_METHOD_(TextureHandle, GetTextureHandle)(_In_ CONST String & name) CONST;
+        VOODOO_METHOD_(IParameter *, ResolveParameter)(_In_ CONST ParameterHandle handle) CONST;
+        VOODOO_METHOD_(ITexture *, ResolveTexture)(_In_ CONST TextureHandle handle) CONST;
         VOODOO_METHOD(RemoveParameter)(_In_ CONST String & name);
         VOODOO_METHOD(RemoveTexture)(_In_ CONST String & name);
+        VOODOO_METHOD(SetExpression)(_In_ IParameter * pParam, _In_ CONST String & expression);
+
+        VOODOO_METHOD(GetObjectStats)(_In_ CONST uint32_t index, _Out_ ObjectStats * pStats) CONST;
+        VOODOO_METHOD(SetObjectSampling)(_In_ CONST uint32_t rate);
+        VOODOO_METHOD(LogObjects)() CONST;
 
     private:
         // Private these to prevent copying internally (external libs never will).
@@ -84,6 +99,32 @@ namespace VoodooShader
         VSCore & operator=(CONST VSCore & other);
         ~VSCore();
 
+        /**
+         * Opens the log and sets the filter from the current config. The log is only reopened if there is no previous
+         * config or the file settings have changed from it.
+         */
+        void ApplyLog(_In_opt_ CONST ConfigDesc * pPrevious);
+        /**
+         * Applies a pending config reload, if the config is being watched.
+         */
+        VoodooResult ApplyConfig();
+        /**
+         * Drives each global parameter named in the config expressions, creating those that do not exist yet.
+         *
+         * @param expressions The expressions to apply, by parameter name.
+         */
+        void ApplyExpressions(_In_ CONST StringMap & expressions);
+        /**
+         * Registers the plugin set being mapped once its worker has finished, then starts mapping the next. Never waits
+         * for the worker.
+         */
+        void UpdatePlugins();
+        static DWORD WINAPI MapPluginsThread(_In_ LPVOID pParam);
+        /**
+         * Performs init, with Init() wrapping it to profile startup.
+         */
+        VoodooResult InitCore(_In_z_ CONST wchar_t * config);
+
         mutable uint32_t m_Refs;
         const uint32_t m_Version;
 
@@ -96,6 +137,17 @@ namespace VoodooShader
         /** Config file. */
         XmlDocument m_ConfigFile;
 
+        /** Pre-parsed config, read from the config file. */
+        ConfigDesc m_Config;
+
+        /** Config file watcher, if auto-reload is enabled. */
+        VSConfigWatcher * m_ConfigWatcher;
+
+        /** Plugin sets listed by config reloads, mapped on a worker one at a time and registered in order. */
+        std::list<PluginMapSet *> m_PluginSets;
+        /** Worker mapping the first plugin set, if any. */
+        HANDLE m_PluginThread;
+
         /** The current IAdapter implementation. */
         BindingRef m_Binding;
 
@@ -117,7 +169,17 @@ namespace VoodooShader
         /** Collection of all virtual parameters created by this pCore. */ 
         ParameterMap m_Parameters;
 
-        /** Event registry for core callbacks. */
-        EventRegistry m_Events;
+        /** Handle slots for the parameters and textures, owned by the maps above. */
+        VSHandleTable<IParameter> m_ParameterHandles;
+        VSHandleTable<ITexture> m_TextureHandles;
+
+        /** Event callbacks, by slot. */
+        VSEventTable m_Events;
+
+        /** Posted events waiting to be delivered. */
+        VSEventQueue * m_EventQueue;
+
+        /** Parameter expressions, evaluated by Update(). */
+        VSExpressionEngine * m_Expressions;
     };
 }
@@ -0,0 +1,256 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+#include "VSEventQueue.hpp"
+
+namespace VoodooShader
+{
+    VSEventQueue::VSEventQueue(_In_ ICore * pCore) :
+        m_Core(pCore), m_HasFrame(0), m_Thread(nullptr), m_WakeEvent(nullptr), m_StopEvent(nullptr)
+    {
+        InitializeCriticalSection(&m_Lock);
+    }
+
+    VSEventQueue::~VSEventQueue()
+    {
+        if (m_Thread)
+        {
+            SetEvent(m_StopEvent);
+            WaitForSingleObject(m_Thread, INFINITE);
+            CloseHandle(m_Thread);
+            m_Thread = nullptr;
+        }
+
+        if (m_WakeEvent)
+        {
+            CloseHandle(m_WakeEvent);
+            m_WakeEvent = nullptr;
+        }
+
+        if (m_StopEvent)
+        {
+            CloseHandle(m_StopEvent);
+            m_StopEvent = nullptr;
+        }
+
+        Clear(m_Frame);
+        Clear(m_Worker);
+
+        DeleteCriticalSection(&m_Lock);
+    }
+
+    VoodooResult VSEventQueue::Post(_In_ CONST Uuid & event, _In_ CONST uint32_t count, _In_reads_opt_(count) CONST Variant * pArgs, _In_ CONST uint32_t flags)
+    {
+        if (count > 0 && !pArgs)
+        {
+            return VSFERR_INVALIDPARAMS;
+        }
+
+        // Copy outside the lock, posting threads only contend for the queue itself
+        QueuedEvent * pEvent = Capture(event, count, pArgs, flags);
+        bool worker = (flags & VSPost_Worker) != 0;
+
+        EnterCriticalSection(&m_Lock);
+
+        if (worker && !this->StartWorker())
+        {
+            LeaveCriticalSection(&m_Lock);
+            delete pEvent;
+            return VSF_FAIL;
+        }
+
+        QueuedEventList & queue = (worker) ? m_Worker : m_Frame;
+        VoodooResult result = VSF_OK;
+
+        if (flags & VSPost_Coalesce)
+        {
+            // Replace the arguments of a pending post, keeping its place in the queue
+            QueuedEventList::iterator iter = queue.begin();
+            while (iter != queue.end() && result == VSF_OK)
+            {
+                if (((*iter)->Flags & VSPost_Coalesce) && (*iter)->Event == event)
+                {
+                    delete (*iter);
+                    (*iter) = pEvent;
+                    result = VSFOK_REDUNDANT;
+                }
+                ++iter;
+            }
+        }
+
+        if (result == VSF_OK)
+        {
+            queue.push_back(pEvent);
+        }
+
+        if (worker)
+        {
+            SetEvent(m_WakeEvent);
+        }
+        else
+        {
+            InterlockedExchange(&m_HasFrame, 1);
+        }
+
+        LeaveCriticalSection(&m_Lock);
+
+        return result;
+    }
+
+    uint32_t VSEventQueue::Deliver()
+    {
+        // Checked without the lock, so the render thread never waits when nothing has been posted
+        if (InterlockedCompareExchange(&m_HasFrame, 0, 0) == 0)
+        {
+            return 0;
+        }
+
+        QueuedEventList events;
+
+        EnterCriticalSection(&m_Lock);
+        events.swap(m_Frame);
+        InterlockedExchange(&m_HasFrame, 0);
+        LeaveCriticalSection(&m_Lock);
+
+        return this->Dispatch(events);
+    }
+
+    VSEventQueue::QueuedEvent * VSEventQueue::Capture(_In_ CONST Uuid & event, _In_ CONST uint32_t count, _In_reads_opt_(count) CONST Variant * pArgs, _In_ CONST uint32_t flags)
+    {
+        QueuedEvent * pEvent = new QueuedEvent();
+        pEvent->Event = event;
+        pEvent->Flags = flags;
+        pEvent->Args.assign(pArgs, pArgs + count);
+
+        std::vector<Variant>::iterator iter = pEvent->Args.begin();
+        while (iter != pEvent->Args.end())
+        {
+            if (iter->Type == VSUT_String && iter->VPString)
+            {
+                pEvent->Strings.push_back(*iter->VPString);
+                iter->VPString = &pEvent->Strings.back();
+            }
+            else if (iter->Type == VSUT_Uuid && iter->VPUuid)
+            {
+                pEvent->Uuids.push_back(*iter->VPUuid);
+                iter->VPUuid = &pEvent->Uuids.back();
+            }
+            else if (iter->Type == VSUT_IObject && iter->VPIObject)
+            {
+                pEvent->Objects.push_back(iter->VPIObject);
+            }
+            else if (iter->Type == VSUT_Array && iter->VArray.Data && iter->VArray.Count > 0)
+            {
+                uint8_t * pData = reinterpret_cast<uint8_t *>(iter->VArray.Data);
+                pEvent->Arrays.push_back(std::vector<uint8_t>(pData, pData + iter->VArray.Count * GetArrayStride(*iter)));
+                iter->VArray.Data = &pEvent->Arrays.back()[0];
+            }
+            ++iter;
+        }
+
+        return pEvent;
+    }
+
+    void VSEventQueue::Clear(_Inout_ QueuedEventList & events)
+    {
+        QueuedEventList::iterator iter = events.begin();
+        while (iter != events.end())
+        {
+            delete (*iter);
+            ++iter;
+        }
+
+        events.clear();
+    }
+
+    uint32_t VSEventQueue::Dispatch(_Inout_ QueuedEventList & events)
+    {
+        uint32_t delivered = 0;
+
+        QueuedEventList::iterator iter = events.begin();
+        while (iter != events.end())
+        {
+            QueuedEvent * pEvent = (*iter);
+            uint32_t count = static_cast<uint32_t>(pEvent->Args.size());
+
+            m_Core->CallEvent(pEvent->Event, count, (count > 0) ? &pEvent->Args[0] : nullptr);
+
+            ++delivered;
+            ++iter;
+        }
+
+        Clear(events);
+
+        return delivered;
+    }
+
+    bool VSEventQueue::StartWorker()
+    {
+        if (m_Thread)
+        {
+            return true;
+        }
+
+        if (!m_WakeEvent)
+        {
+            m_WakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        }
+
+        if (!m_StopEvent)
+        {
+            m_StopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        }
+
+        if (!m_WakeEvent || !m_StopEvent)
+        {
+            return false;
+        }
+
+        m_Thread = CreateThread(nullptr, 0, &VSEventQueue::WorkerThread, this, 0, nullptr);
+        return (m_Thread != nullptr);
+    }
+
+    DWORD WINAPI VSEventQueue::WorkerThread(_In_ LPVOID pParam)
+    {
+        reinterpret_cast<VSEventQueue*>(pParam)->Work();
+        return 0;
+    }
+
+    void VSEventQueue::Work()
+    {
+        HANDLE handles[2] = { m_StopEvent, m_WakeEvent };
+        for (;;)
+        {
+            DWORD wait = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+            if (wait != WAIT_OBJECT_0 + 1)
+            {
+                break;
+            }
+
+            QueuedEventList events;
+
+            EnterCriticalSection(&m_Lock);
+            events.swap(m_Worker);
+            LeaveCriticalSection(&m_Lock);
+
+            this->Dispatch(events);
+        }
+    }
+}
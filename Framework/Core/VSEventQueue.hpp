@@ -0,0 +1,99 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooInternal.hpp"
+
+#pragma warning(push,3)
+#include <list>
+#pragma warning(pop)
+
+namespace VoodooShader
+{
+    /**
+     * Queue of posted events, delivered in batches. Events posted for the frame are delivered by Deliver(), which the core
+     * calls from ICore::Update(); events posted for the worker are delivered on the queue's own thread, which is started
+     * the first time one is posted.
+     *
+     * Arguments are copied when posted. Strings and Uuids pointed to by the arguments, and the packed data of
+     * VSUT_Array arguments, are copied into the queue and objects are held until the event has been delivered; other
+     * pointers (including pointers stored in arrays) are copied as they are.
+     */
+    class VSEventQueue
+    {
+    public:
+        VSEventQueue(_In_ ICore * pCore);
+        /**
+         * Stops the worker thread. Events not yet delivered are dropped.
+         */
+        ~VSEventQueue();
+
+        /**
+         * Adds an event to the queue.
+         *
+         * @param flags Delivery flags, see @ref EventPostFlags.
+         */
+        VoodooResult Post(_In_ CONST Uuid & event, _In_ CONST uint32_t count, _In_reads_opt_(count) CONST Variant * pArgs, _In_ CONST uint32_t flags);
+        /**
+         * Delivers the events posted for the frame, in the order they were posted. Events posted by the callbacks are
+         * delivered by the next call.
+         *
+         * @return The number of events delivered.
+         */
+        uint32_t Deliver();
+
+    private:
+        VSEventQueue(CONST VSEventQueue & other);
+        VSEventQueue & operator=(CONST VSEventQueue & other);
+
+        struct QueuedEvent
+        {
+            Uuid Event;
+            uint32_t Flags;
+            std::vector<Variant> Args;
+            /** Copies of pointed-to values, lists so the arguments can point into them. */
+            std::list<String> Strings;
+            std::list<Uuid> Uuids;
+            std::list< std::vector<uint8_t> > Arrays;
+            std::vector<ObjectRef> Objects;
+        };
+        typedef std::vector<QueuedEvent*> QueuedEventList;
+
+        static QueuedEvent * Capture(_In_ CONST Uuid & event, _In_ CONST uint32_t count, _In_reads_opt_(count) CONST Variant * pArgs, _In_ CONST uint32_t flags);
+        static void Clear(_Inout_ QueuedEventList & events);
+        uint32_t Dispatch(_Inout_ QueuedEventList & events);
+
+        bool StartWorker();
+        static DWORD WINAPI WorkerThread(_In_ LPVOID pParam);
+        void Work();
+
+        ICore * m_Core;
+
+        CRITICAL_SECTION m_Lock;
+        QueuedEventList m_Frame;
+        QueuedEventList m_Worker;
+        /** Set when frame events are pending, so Deliver() need not lock when there are none. */
+        volatile LONG m_HasFrame;
+
+        HANDLE m_Thread;
+        HANDLE m_WakeEvent;
+        HANDLE m_StopEvent;
+    };
+}
@@ -0,0 +1,289 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+#include "VSEventTable.hpp"
+
+namespace VoodooShader
+{
+    VSEventTable::VSEventTable() :
+        m_Count(0)
+    {
+        InitializeCriticalSection(&m_Lock);
+        ZeroMemory(const_cast<EventSlot**>(m_Chunks), sizeof(m_Chunks));
+    }
+
+    VSEventTable::~VSEventTable()
+    {
+        uint32_t count = static_cast<uint32_t>(m_Count);
+        for (uint32_t slot = 0; slot < count; ++slot)
+        {
+            free(this->GetEntry(slot)->pList);
+        }
+
+        for (uint32_t chunk = 0; chunk < ChunkCount; ++chunk)
+        {
+            delete[] m_Chunks[chunk];
+        }
+
+        std::vector<EventList*>::iterator iter = m_Retired.begin();
+        while (iter != m_Retired.end())
+        {
+            free(*iter);
+            ++iter;
+        }
+
+        DeleteCriticalSection(&m_Lock);
+    }
+
+    uint32_t VSEventTable::GetSlot(_In_ CONST Uuid & event)
+    {
+        uint32_t slot = this->FindSlot(event);
+        if (slot != InvalidSlot)
+        {
+            return slot;
+        }
+
+        EnterCriticalSection(&m_Lock);
+
+        // Another thread may have assigned the slot while this one waited
+        slot = this->FindSlot(event);
+        if (slot == InvalidSlot)
+        {
+            uint32_t count = static_cast<uint32_t>(m_Count);
+            uint32_t chunk = count >> ChunkShift;
+
+            if (chunk < ChunkCount)
+            {
+                if (!m_Chunks[chunk])
+                {
+                    EventSlot * pChunk = new EventSlot[ChunkSize];
+                    ZeroMemory(pChunk, sizeof(EventSlot) * ChunkSize);
+                    InterlockedExchangePointer(reinterpret_cast<PVOID volatile *>(&m_Chunks[chunk]), pChunk);
+                }
+
+                EventSlot * pEntry = this->GetEntry(count);
+                pEntry->Event = event;
+                pEntry->pList = nullptr;
+
+                // The count is published last, so readers never see a slot before it is filled
+                InterlockedExchange(&m_Count, static_cast<LONG>(count + 1));
+                slot = count;
+            }
+        }
+
+        LeaveCriticalSection(&m_Lock);
+
+        return slot;
+    }
+
+    uint32_t VSEventTable::FindSlot(_In_ CONST Uuid & event) CONST
+    {
+        // Few events are ever used, so a scan is as fast as a hash and needs no lock
+        uint32_t count = static_cast<uint32_t>(m_Count);
+        for (uint32_t slot = 0; slot < count; ++slot)
+        {
+            if (this->GetEntry(slot)->Event == event)
+            {
+                return slot;
+            }
+        }
+
+        return InvalidSlot;
+    }
+
+    VoodooResult VSEventTable::Add(_In_ CONST uint32_t slot, _In_ CONST EventHandler & handler)
+    {
+        if (slot >= static_cast<uint32_t>(m_Count) || (!handler.Callback && !handler.Func))
+        {
+            return VSFERR_INVALIDPARAMS;
+        }
+
+        EnterCriticalSection(&m_Lock);
+
+        EventSlot * pEntry = this->GetEntry(slot);
+        CONST EventList * pOld = pEntry->pList;
+        uint32_t oldCount = (pOld) ? pOld->Count : 0;
+
+        for (uint32_t index = 0; index < oldCount; ++index)
+        {
+            if (IsSame(pOld->Handlers[index], handler))
+            {
+                LeaveCriticalSection(&m_Lock);
+                return VSFOK_REDUNDANT;
+            }
+        }
+
+        EventList * pList = CreateList(oldCount + 1);
+        if (!pList)
+        {
+            LeaveCriticalSection(&m_Lock);
+            return VSF_FAIL;
+        }
+
+        // Higher priorities are called first, equal priorities in the order they were added
+        uint32_t insert = 0;
+        while (insert < oldCount && pOld->Handlers[insert].Priority >= handler.Priority)
+        {
+            ++insert;
+        }
+
+        uint32_t target = 0;
+        for (uint32_t index = 0; index < oldCount; ++index)
+        {
+            if (index == insert)
+            {
+                pList->Handlers[target++] = handler;
+            }
+            pList->Handlers[target++] = pOld->Handlers[index];
+        }
+
+        if (insert == oldCount)
+        {
+            pList->Handlers[target] = handler;
+        }
+
+        this->Publish(pEntry, pList);
+
+        LeaveCriticalSection(&m_Lock);
+
+        return VSF_OK;
+    }
+
+    VoodooResult VSEventTable::Remove(_In_ CONST uint32_t slot, _In_ CONST EventHandler & handler)
+    {
+        if (slot >= static_cast<uint32_t>(m_Count))
+        {
+            return VSF_OK;
+        }
+
+        EnterCriticalSection(&m_Lock);
+
+        EventSlot * pEntry = this->GetEntry(slot);
+        CONST EventList * pOld = pEntry->pList;
+        uint32_t oldCount = (pOld) ? pOld->Count : 0;
+
+        uint32_t found = oldCount;
+        for (uint32_t index = 0; index < oldCount && found == oldCount; ++index)
+        {
+            if (IsSame(pOld->Handlers[index], handler))
+            {
+                found = index;
+            }
+        }
+
+        if (found == oldCount)
+        {
+            LeaveCriticalSection(&m_Lock);
+            return VSF_OK;
+        }
+
+        EventList * pList = nullptr;
+        if (oldCount > 1)
+        {
+            pList = CreateList(oldCount - 1);
+            if (!pList)
+            {
+                LeaveCriticalSection(&m_Lock);
+                return VSF_FAIL;
+            }
+
+            uint32_t target = 0;
+            for (uint32_t index = 0; index < oldCount; ++index)
+            {
+                if (index != found)
+                {
+                    pList->Handlers[target++] = pOld->Handlers[index];
+                }
+            }
+        }
+
+        this->Publish(pEntry, pList);
+
+        LeaveCriticalSection(&m_Lock);
+
+        return VSF_OK;
+    }
+
+    VoodooResult VSEventTable::Call(_In_ ICore * pCore, _In_ CONST uint32_t slot, _In_ CONST uint32_t count, _In_reads_opt_(count) Variant * pArgs) CONST
+    {
+        if (slot >= static_cast<uint32_t>(m_Count))
+        {
+            return VSFERR_INVALIDPARAMS;
+        }
+
+        CONST EventList * pList = this->GetEntry(slot)->pList;
+        if (!pList)
+        {
+            return VSF_OK;
+        }
+
+        CONST EventHandler * pHandler = pList->Handlers;
+        CONST EventHandler * pEnd = pHandler + pList->Count;
+        while (pHandler != pEnd)
+        {
+            VoodooResult vr = (pHandler->Func) ?
+                pHandler->Func(pCore, pHandler->pUser, count, pArgs) :
+                pHandler->Callback(pCore, count, pArgs);
+
+            if (FAILED(vr))
+            {
+                return vr;
+            }
+
+            ++pHandler;
+        }
+
+        return VSF_OK;
+    }
+
+    VSEventTable::EventSlot * VSEventTable::GetEntry(_In_ CONST uint32_t slot) CONST
+    {
+        return &m_Chunks[slot >> ChunkShift][slot & (ChunkSize - 1)];
+    }
+
+    void VSEventTable::Publish(_In_ EventSlot * pEntry, _In_opt_ EventList * pList)
+    {
+        EventList * pOld = reinterpret_cast<EventList*>
+        (
+            InterlockedExchangePointer(reinterpret_cast<PVOID volatile *>(&pEntry->pList), pList)
+        );
+
+        if (pOld)
+        {
+            m_Retired.push_back(pOld);
+        }
+    }
+
+    EventList * VSEventTable::CreateList(_In_ CONST uint32_t count)
+    {
+        EventList * pList = reinterpret_cast<EventList*>(malloc(sizeof(EventList) + sizeof(EventHandler) * (count - 1)));
+        if (pList)
+        {
+            pList->Count = count;
+        }
+
+        return pList;
+    }
+
+    bool VSEventTable::IsSame(_In_ CONST EventHandler & a, _In_ CONST EventHandler & b)
+    {
+        return (a.Callback == b.Callback && a.Func == b.Func && a.pUser == b.pUser);
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooInternal.hpp"
+
+namespace VoodooShader
+{
+    /**
+     * A registered event callback. Callbacks registered without user data use the older prototype.
+     */
+    struct EventHandler
+    {
+        Functions::CallbackFunc Callback;
+        Functions::EventFunc    Func;
+        void *                  pUser;
+        int32_t                 Priority;
+    };
+
+    /**
+     * The callbacks for one event, in call order. Lists are never changed once published; registering or removing a
+     * callback builds a new list and swaps it in.
+     */
+    struct EventList
+    {
+        uint32_t        Count;
+        EventHandler    Handlers[1];
+    };
+
+    /**
+     * Event callback table. Each event is given a dense slot the first time it is used, and the callbacks for a slot are
+     * kept in an immutable list, so calling an event is an indexed load and a loop over the list, with no locks.
+     *
+     * Calls may be made from any thread and callbacks may register or remove callbacks (for any event) while being called;
+     * a call in progress finishes with the list it started with. Changes are serialized by a lock. Replaced lists are kept
+     * until the table is destroyed, since a call on another thread may still be using them; callbacks are normally only
+     * changed while plugins load and unload, so few lists are replaced.
+     */
+    class VSEventTable
+    {
+    public:
+        VSEventTable();
+        ~VSEventTable();
+
+        static CONST uint32_t InvalidSlot = 0xFFFFFFFF;
+
+        /**
+         * Retrieves the slot for an event, assigning one if the event has not been used before.
+         *
+         * @return The slot, or InvalidSlot if the table is full.
+         */
+        uint32_t GetSlot(_In_ CONST Uuid & event);
+        /**
+         * Retrieves the slot for an event without assigning one.
+         *
+         * @return The slot, or InvalidSlot if the event has not been used.
+         */
+        uint32_t FindSlot(_In_ CONST Uuid & event) CONST;
+
+        /**
+         * Adds a callback to the given slot, after any callbacks of the same or higher priority.
+         *
+         * @return VSFOK_REDUNDANT if the callback and user data were already registered for the slot.
+         */
+        VoodooResult Add(_In_ CONST uint32_t slot, _In_ CONST EventHandler & handler);
+        /**
+         * Removes a callback from the given slot. The callback is matched by function and user data.
+         */
+        VoodooResult Remove(_In_ CONST uint32_t slot, _In_ CONST EventHandler & handler);
+
+        /**
+         * Calls each callback in the given slot, stopping at the first failure.
+         *
+         * @return The failure, if any callback failed, VSFERR_INVALIDPARAMS if the slot has not been assigned, or VSF_OK.
+         */
+        VoodooResult Call(_In_ ICore * pCore, _In_ CONST uint32_t slot, _In_ CONST uint32_t count, _In_reads_opt_(count) Variant * pArgs) CONST;
+
+    private:
+        VSEventTable(CONST VSEventTable & other);
+        VSEventTable & operator=(CONST VSEventTable & other);
+
+        struct EventSlot
+        {
+            Uuid Event;
+            EventList * volatile pList;
+        };
+
+        static CONST uint32_t ChunkShift = 6;
+        static CONST uint32_t ChunkSize = 1 << ChunkShift;
+        static CONST uint32_t ChunkCount = 64;
+
+        EventSlot * GetEntry(_In_ CONST uint32_t slot) CONST;
+        void Publish(_In_ EventSlot * pEntry, _In_opt_ EventList * pList);
+
+        static EventList * CreateList(_In_ CONST uint32_t count);
+        static bool IsSame(_In_ CONST EventHandler & a, _In_ CONST EventHandler & b);
+
+        mutable CRITICAL_SECTION m_Lock;
+        /** Slots are allocated in chunks so published slots never move. */
+        EventSlot * volatile m_Chunks[ChunkCount];
+        volatile LONG m_Count;
+        std::vector<EventList*> m_Retired;
+    };
+}
@@ -0,0 +1,872 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+#include "VSExpressionEngine.hpp"
+// System
+#pragma warning(push,3)
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cwctype>
+#pragma warning(pop)
+
+namespace VoodooShader
+{
+    static CONST uint32_t NoSource = 0xFFFFFFFF;
+    static CONST uint32_t MaxRegister = 0xFFFF;
+
+    static bool IsNameStart(_In_ CONST wchar_t ch)
+    {
+        return iswalpha(ch) || ch == L'_' || ch == L':';
+    }
+
+    static bool IsNameChar(_In_ CONST wchar_t ch)
+    {
+        return iswalnum(ch) || ch == L'_' || ch == L':';
+    }
+
+    /**
+     * Recursive descent compiler for a single expression, emitting three-address code into the expression and allocating
+     * its constants, temporaries and symbols from the engine.
+     */
+    class VSExpressionEngine::Parser
+    {
+    public:
+        Parser(_In_ VSExpressionEngine * pEngine, _Inout_ Expression * pExpr) :
+            m_Engine(pEngine), m_Expr(pExpr), m_Pos(pExpr->Text.GetData())
+        { }
+
+        bool Run()
+        {
+            m_Expr->Code.clear();
+            m_Expr->Reads.clear();
+            m_Expr->Components = 0;
+
+            do
+            {
+                if (m_Expr->Components == 4)
+                {
+                    return this->Fail(VSTR("more than four components"));
+                }
+
+                uint32_t value = 0;
+                if (!this->ParseSum(&value) || !this->Emit(Op_Move, m_Expr->Output + m_Expr->Components, value))
+                {
+                    return false;
+                }
+
+                ++m_Expr->Components;
+            } while (this->Accept(L','));
+
+            this->SkipSpace();
+            if (*m_Pos)
+            {
+                return this->Fail(VSTR("unexpected character"));
+            }
+
+            return true;
+        }
+
+        CONST String & GetError() CONST
+        {
+            return m_Error;
+        }
+
+        uint32_t GetOffset() CONST
+        {
+            return static_cast<uint32_t>(m_Pos - m_Expr->Text.GetData());
+        }
+
+    private:
+        struct Function
+        {
+            CONST wchar_t * Name;
+            uint32_t Arity;
+            Opcode Op;
+        };
+
+        static CONST Function * FindFunction(_In_ CONST String & name)
+        {
+            static CONST Function functions[] =
+            {
+                { L"sin",   1, Op_Sin   },
+                { L"cos",   1, Op_Cos   },
+                { L"tan",   1, Op_Tan   },
+                { L"abs",   1, Op_Abs   },
+                { L"floor", 1, Op_Floor },
+                { L"frac",  1, Op_Frac  },
+                { L"sqrt",  1, Op_Sqrt  },
+                { L"hash",  1, Op_Hash  },
+                { L"min",   2, Op_Min   },
+                { L"max",   2, Op_Max   },
+                { L"pow",   2, Op_Pow   },
+                { L"step",  2, Op_Step  },
+                { L"clamp", 3, Op_Clamp },
+                { L"lerp",  3, Op_Lerp  },
+            };
+
+            for (uint32_t i = 0; i < sizeof(functions) / sizeof(functions[0]); ++i)
+            {
+                if (name == functions[i].Name)
+                {
+                    return &functions[i];
+                }
+            }
+
+            return nullptr;
+        }
+
+        bool Fail(_In_z_ CONST wchar_t * msg)
+        {
+            if (m_Error.IsEmpty())
+            {
+                m_Error = msg;
+            }
+            return false;
+        }
+
+        void SkipSpace()
+        {
+            while (iswspace(*m_Pos))
+            {
+                ++m_Pos;
+            }
+        }
+
+        bool Accept(_In_ CONST wchar_t ch)
+        {
+            this->SkipSpace();
+            if (*m_Pos == ch)
+            {
+                ++m_Pos;
+                return true;
+            }
+            return false;
+        }
+
+        bool Emit(_In_ CONST Opcode op, _In_ CONST uint32_t dest, _In_ CONST uint32_t a, _In_ CONST uint32_t b = 0, _In_ CONST uint32_t c = 0)
+        {
+            if (dest > MaxRegister || a > MaxRegister || b > MaxRegister || c > MaxRegister)
+            {
+                return this->Fail(VSTR("too many registers"));
+            }
+
+            Instruction ins = { op, static_cast<uint16_t>(dest), static_cast<uint16_t>(a), static_cast<uint16_t>(b), static_cast<uint16_t>(c) };
+            m_Expr->Code.push_back(ins);
+            return true;
+        }
+
+        bool EmitTemp(_In_ CONST Opcode op, _Out_ uint32_t * pReg, _In_ CONST uint32_t a, _In_ CONST uint32_t b = 0, _In_ CONST uint32_t c = 0)
+        {
+            *pReg = m_Engine->AddRegisters(1);
+            return this->Emit(op, *pReg, a, b, c);
+        }
+
+        bool ParseSum(_Out_ uint32_t * pReg)
+        {
+            uint32_t lhs = 0;
+            if (!this->ParseProduct(&lhs))
+            {
+                return false;
+            }
+
+            for (;;)
+            {
+                Opcode op;
+                if (this->Accept(L'+'))
+                {
+                    op = Op_Add;
+                }
+                else if (this->Accept(L'-'))
+                {
+                    op = Op_Sub;
+                }
+                else
+                {
+                    break;
+                }
+
+                uint32_t rhs = 0;
+                if (!this->ParseProduct(&rhs) || !this->EmitTemp(op, &lhs, lhs, rhs))
+                {
+                    return false;
+                }
+            }
+
+            *pReg = lhs;
+            return true;
+        }
+
+        bool ParseProduct(_Out_ uint32_t * pReg)
+        {
+            uint32_t lhs = 0;
+            if (!this->ParseUnary(&lhs))
+            {
+                return false;
+            }
+
+            for (;;)
+            {
+                Opcode op;
+                if (this->Accept(L'*'))
+                {
+                    op = Op_Mul;
+                }
+                else if (this->Accept(L'/'))
+                {
+                    op = Op_Div;
+                }
+                else if (this->Accept(L'%'))
+                {
+                    op = Op_Mod;
+                }
+                else
+                {
+                    break;
+                }
+
+                uint32_t rhs = 0;
+                if (!this->ParseUnary(&rhs) || !this->EmitTemp(op, &lhs, lhs, rhs))
+                {
+                    return false;
+                }
+            }
+
+            *pReg = lhs;
+            return true;
+        }
+
+        bool ParseUnary(_Out_ uint32_t * pReg)
+        {
+            if (this->Accept(L'-'))
+            {
+                uint32_t value = 0;
+                return this->ParseUnary(&value) && this->EmitTemp(Op_Neg, pReg, value);
+            }
+            else if (this->Accept(L'+'))
+            {
+                return this->ParseUnary(pReg);
+            }
+
+            // Exponents bind tighter than negation and are right-associative, so -a^-b is -(a^(-b))
+            uint32_t base = 0;
+            if (!this->ParsePrimary(&base))
+            {
+                return false;
+            }
+
+            if (this->Accept(L'^'))
+            {
+                uint32_t exponent = 0;
+                return this->ParseUnary(&exponent) && this->EmitTemp(Op_Pow, pReg, base, exponent);
+            }
+
+            *pReg = base;
+            return true;
+        }
+
+        bool ParsePrimary(_Out_ uint32_t * pReg)
+        {
+            if (this->Accept(L'('))
+            {
+                if (!this->ParseSum(pReg))
+                {
+                    return false;
+                }
+                return this->Accept(L')') || this->Fail(VSTR("expected ')'"));
+            }
+
+            if (iswdigit(*m_Pos) || *m_Pos == L'.')
+            {
+                wchar_t * pEnd = nullptr;
+                double value = _wcstod_l(m_Pos, &pEnd, m_Engine->m_Locale);
+                if (pEnd == m_Pos)
+                {
+                    return this->Fail(VSTR("invalid number"));
+                }
+
+                m_Pos = pEnd;
+                *pReg = m_Engine->AddConstant(static_cast<float>(value));
+                return true;
+            }
+
+            if (!IsNameStart(*m_Pos))
+            {
+                return this->Fail(VSTR("expected a value"));
+            }
+
+            CONST wchar_t * pName = m_Pos;
+            while (IsNameChar(*m_Pos))
+            {
+                ++m_Pos;
+            }
+            String name(static_cast<uint32_t>(m_Pos - pName), pName);
+
+            if (this->Accept(L'('))
+            {
+                return this->ParseCall(name, pReg);
+            }
+
+            return this->ParseName(name, pReg);
+        }
+
+        bool ParseCall(_In_ CONST String & name, _Out_ uint32_t * pReg)
+        {
+            CONST Function * pFunc = FindFunction(name);
+            if (!pFunc)
+            {
+                return this->Fail(VSTR("unknown function"));
+            }
+
+            uint32_t args[3] = {0, 0, 0};
+            uint32_t count = 0;
+            if (!this->Accept(L')'))
+            {
+                do
+                {
+                    if (count == pFunc->Arity)
+                    {
+                        return this->Fail(VSTR("too many arguments"));
+                    }
+
+                    if (!this->ParseSum(&args[count]))
+                    {
+                        return false;
+                    }
+                    ++count;
+                } while (this->Accept(L','));
+
+                if (!this->Accept(L')'))
+                {
+                    return this->Fail(VSTR("expected ')'"));
+                }
+            }
+
+            if (count != pFunc->Arity)
+            {
+                return this->Fail(VSTR("too few arguments"));
+            }
+
+            return this->EmitTemp(pFunc->Op, pReg, args[0], args[1], args[2]);
+        }
+
+        bool ParseName(_In_ CONST String & name, _Out_ uint32_t * pReg)
+        {
+            if (name == VSTR("time"))
+            {
+                *pReg = Builtin_Time;
+                return true;
+            }
+            else if (name == VSTR("delta"))
+            {
+                *pReg = Builtin_Delta;
+                return true;
+            }
+            else if (name == VSTR("frame"))
+            {
+                *pReg = Builtin_Frame;
+                return true;
+            }
+            else if (name == VSTR("random"))
+            {
+                *pReg = Builtin_Random;
+                return true;
+            }
+
+            uint32_t symbol = m_Engine->AddSymbol(name);
+            if (std::find(m_Expr->Reads.begin(), m_Expr->Reads.end(), symbol) == m_Expr->Reads.end())
+            {
+                m_Expr->Reads.push_back(symbol);
+            }
+
+            uint32_t component = 0;
+            if (*m_Pos == L'.')
+            {
+                switch (m_Pos[1])
+                {
+                case L'x': case L'r': component = 0; break;
+                case L'y': case L'g': component = 1; break;
+                case L'z': case L'b': component = 2; break;
+                case L'w': case L'a': component = 3; break;
+                default:
+                    return this->Fail(VSTR("invalid component"));
+                }
+
+                if (IsNameChar(m_Pos[2]))
+                {
+                    return this->Fail(VSTR("invalid component"));
+                }
+
+                m_Pos += 2;
+            }
+
+            *pReg = m_Engine->m_Symbols[symbol].Register + component;
+            return true;
+        }
+
+        VSExpressionEngine * m_Engine;
+        Expression * m_Expr;
+        CONST wchar_t * m_Pos;
+        String m_Error;
+    };
+
+    VSExpressionEngine::VSExpressionEngine(_In_ ICore * pCore) :
+        m_Core(pCore), m_Resolve(false), m_Frame(0)
+    {
+        QueryPerformanceFrequency(&m_Frequency);
+        QueryPerformanceCounter(&m_Start);
+        m_Previous = m_Start;
+        m_Seed = m_Start.LowPart | 1;
+
+        m_Registers.assign(Builtin_Count, 0.0f);
+        m_Locale = _create_locale(LC_NUMERIC, "C");
+    }
+
+    VSExpressionEngine::~VSExpressionEngine()
+    {
+        if (m_Locale)
+        {
+            _free_locale(m_Locale);
+        }
+    }
+
+    VoodooResult VSExpressionEngine::Set(_In_ IParameter * pParam, _In_ CONST String & name, _In_ CONST String & expression)
+    {
+        if (!pParam)
+        {
+            return VSFERR_INVALIDPARAMS;
+        }
+
+        if (expression.IsEmpty())
+        {
+            this->Remove(pParam);
+            return VSF_OK;
+        }
+
+        ParameterType type = pParam->GetDesc().Type;
+        if (type != VSPT_Float && type != VSPT_Int && type != VSPT_Bool)
+        {
+            m_Core->GetLogger()->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, 
+                StringFormat(VSTR("Parameter %1% cannot be driven by an expression, only numeric parameters can.")) << pParam);
+            return VSFERR_INVALIDPARAMS;
+        }
+
+        Expression expr;
+        expr.pParam = pParam;
+        expr.Type = type;
+        expr.Name = name;
+        expr.Text = expression;
+        expr.Components = 0;
+        expr.Output = 0;
+        ZeroMemory(&expr.Last, sizeof(Float4));
+        expr.Written = false;
+
+        ExpressionVector::iterator existing = m_Expressions.begin();
+        while (existing != m_Expressions.end() && existing->pParam != pParam)
+        {
+            ++existing;
+        }
+
+        // Keep the previous expression, so a bad replacement leaves the parameter as it was
+        Expression previous;
+        bool replaced = (existing != m_Expressions.end());
+        size_t index = existing - m_Expressions.begin();
+        if (replaced)
+        {
+            previous = *existing;
+            *existing = expr;
+        }
+        else
+        {
+            m_Expressions.push_back(expr);
+        }
+
+        if (!this->Rebuild())
+        {
+            if (replaced)
+            {
+                m_Expressions[index] = previous;
+            }
+            else
+            {
+                m_Expressions.pop_back();
+            }
+
+            this->Rebuild();
+            return VSFERR_INVALIDPARAMS;
+        }
+
+        return VSF_OK;
+    }
+
+    void VSExpressionEngine::Remove(_In_ IParameter * pParam)
+    {
+        ExpressionVector::iterator expr = m_Expressions.begin();
+        while (expr != m_Expressions.end())
+        {
+            if (expr->pParam == pParam)
+            {
+                m_Expressions.erase(expr);
+                this->Rebuild();
+                return;
+            }
+            ++expr;
+        }
+    }
+
+    void VSExpressionEngine::Invalidate()
+    {
+        m_Resolve = true;
+    }
+
+    uint32_t VSExpressionEngine::Evaluate(_In_ CONST ParameterMap & parameters)
+    {
+        if (m_Expressions.empty())
+        {
+            return 0;
+        }
+
+        if (m_Resolve)
+        {
+            this->Resolve(parameters);
+        }
+
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+
+        double frequency = static_cast<double>(m_Frequency.QuadPart);
+        m_Registers[Builtin_Time] = static_cast<float>((now.QuadPart - m_Start.QuadPart) / frequency);
+        m_Registers[Builtin_Delta] = m_Frame ? static_cast<float>((now.QuadPart - m_Previous.QuadPart) / frequency) : 0.0f;
+        m_Registers[Builtin_Frame] = static_cast<float>(m_Frame);
+        m_Previous = now;
+        ++m_Frame;
+
+        // Xorshift, keeping the top 24 bits so every value is exactly representable
+        m_Seed ^= m_Seed << 13;
+        m_Seed ^= m_Seed >> 17;
+        m_Seed ^= m_Seed << 5;
+        m_Registers[Builtin_Random] = static_cast<float>(m_Seed >> 8) * (1.0f / 16777216.0f);
+
+        std::vector<uint32_t>::const_iterator input = m_Inputs.begin();
+        while (input != m_Inputs.end())
+        {
+            CONST Symbol & symbol = m_Symbols[*input];
+            float * pRegisters = &m_Registers[symbol.Register];
+            if (symbol.InputType == VSPT_Float)
+            {
+                Float4 value;
+                if (SUCCEEDED(symbol.pInput->GetVector(&value)))
+                {
+                    memcpy(pRegisters, &value, sizeof(Float4));
+                }
+            }
+            else if (symbol.InputType == VSPT_Int)
+            {
+                int32_t value = 0;
+                if (SUCCEEDED(symbol.pInput->GetInt(&value)))
+                {
+                    pRegisters[0] = static_cast<float>(value);
+                }
+            }
+            else if (symbol.InputType == VSPT_Bool)
+            {
+                bool value = false;
+                if (SUCCEEDED(symbol.pInput->GetBool(&value)))
+                {
+                    pRegisters[0] = value ? 1.0f : 0.0f;
+                }
+            }
+            ++input;
+        }
+
+        this->Run();
+
+        uint32_t count = 0;
+        std::vector<uint32_t>::const_iterator order = m_Order.begin();
+        while (order != m_Order.end())
+        {
+            if (this->Write(m_Expressions[*order]))
+            {
+                ++count;
+            }
+            ++order;
+        }
+
+        return count;
+    }
+
+    uint32_t VSExpressionEngine::GetComponents(_In_ CONST String & expression)
+    {
+        if (expression.IsEmpty())
+        {
+            return 0;
+        }
+
+        uint32_t components = 1;
+        uint32_t depth = 0;
+        for (CONST wchar_t * pChar = expression.GetData(); *pChar; ++pChar)
+        {
+            if (*pChar == L'(')
+            {
+                ++depth;
+            }
+            else if (*pChar == L')' && depth > 0)
+            {
+                --depth;
+            }
+            else if (*pChar == L',' && depth == 0)
+            {
+                ++components;
+            }
+        }
+
+        return (std::min)(components, 4U);
+    }
+
+    bool VSExpressionEngine::Rebuild()
+    {
+        m_Registers.assign(Builtin_Count, 0.0f);
+        m_Symbols.clear();
+        m_Program.clear();
+        m_Order.clear();
+        m_Inputs.clear();
+        m_Resolve = true;
+
+        // Named expressions claim their symbols first, so expressions reading them compile against the same registers
+        uint32_t count = static_cast<uint32_t>(m_Expressions.size());
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Expression & expr = m_Expressions[i];
+            if (expr.Name.IsEmpty())
+            {
+                expr.Output = this->AddRegisters(4);
+            }
+            else
+            {
+                Symbol & symbol = m_Symbols[this->AddSymbol(expr.Name)];
+                symbol.Source = i;
+                expr.Output = symbol.Register;
+            }
+        }
+
+        bool result = true;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Parser parser(this, &m_Expressions[i]);
+            if (!parser.Run())
+            {
+                m_Core->GetLogger()->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, 
+                    StringFormat(VSTR("Unable to compile expression for %1%: %2% at offset %3% of '%4%'.")) << 
+                    m_Expressions[i].pParam << parser.GetError() << parser.GetOffset() << m_Expressions[i].Text);
+                result = false;
+            }
+        }
+
+        if (!result)
+        {
+            return false;
+        }
+
+        std::vector<uint8_t> state(count, 0);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (!this->Order(i, state))
+            {
+                return false;
+            }
+        }
+
+        for (uint32_t i = 0; i < m_Symbols.size(); ++i)
+        {
+            if (m_Symbols[i].Source == NoSource)
+            {
+                m_Inputs.push_back(i);
+            }
+        }
+
+        return true;
+    }
+
+    bool VSExpressionEngine::Order(_In_ CONST uint32_t index, _Inout_ std::vector<uint8_t> & state)
+    {
+        if (state[index] == 2)
+        {
+            return true;
+        }
+        else if (state[index] == 1)
+        {
+            m_Core->GetLogger()->LogMessage(VSLog_CoreWarning, VOODOO_CORE_NAME, 
+                StringFormat(VSTR("Expression for %1% depends on itself.")) << m_Expressions[index].pParam);
+            return false;
+        }
+
+        state[index] = 1;
+
+        CONST Expression & expr = m_Expressions[index];
+        std::vector<uint32_t>::const_iterator read = expr.Reads.begin();
+        while (read != expr.Reads.end())
+        {
+            uint32_t source = m_Symbols[*read].Source;
+            if (source != NoSource && !this->Order(source, state))
+            {
+                return false;
+            }
+            ++read;
+        }
+
+        state[index] = 2;
+
+        m_Program.insert(m_Program.end(), expr.Code.begin(), expr.Code.end());
+        m_Order.push_back(index);
+        return true;
+    }
+
+    void VSExpressionEngine::Resolve(_In_ CONST ParameterMap & parameters)
+    {
+        std::vector<uint32_t>::const_iterator input = m_Inputs.begin();
+        while (input != m_Inputs.end())
+        {
+            Symbol & symbol = m_Symbols[*input];
+
+            ParameterMap::const_iterator param = parameters.find(symbol.Name);
+            symbol.pInput = (param != parameters.end()) ? param->second.get() : nullptr;
+            symbol.InputType = symbol.pInput ? symbol.pInput->GetDesc().Type : VSPT_Unknown;
+
+            // Missing parameters read as zero, and int and bool parameters only fill the first component
+            std::fill_n(m_Registers.begin() + symbol.Register, 4, 0.0f);
+            ++input;
+        }
+
+        m_Resolve = false;
+    }
+
+    void VSExpressionEngine::Run()
+    {
+        if (m_Program.empty())
+        {
+            return;
+        }
+
+        float * r = &m_Registers[0];
+        CONST Instruction * pIns = &m_Program[0];
+        CONST Instruction * pEnd = pIns + m_Program.size();
+
+        for (; pIns != pEnd; ++pIns)
+        {
+            CONST float a = r[pIns->A];
+            CONST float b = r[pIns->B];
+            float value;
+
+            switch (pIns->Op)
+            {
+            case Op_Move:   value = a; break;
+            case Op_Add:    value = a + b; break;
+            case Op_Sub:    value = a - b; break;
+            case Op_Mul:    value = a * b; break;
+            case Op_Div:    value = a / b; break;
+            case Op_Mod:    value = fmodf(a, b); break;
+            case Op_Neg:    value = -a; break;
+            case Op_Pow:    value = powf(a, b); break;
+            case Op_Min:    value = (a < b) ? a : b; break;
+            case Op_Max:    value = (a > b) ? a : b; break;
+            case Op_Step:   value = (b >= a) ? 1.0f : 0.0f; break;
+            case Op_Sin:    value = sinf(a); break;
+            case Op_Cos:    value = cosf(a); break;
+            case Op_Tan:    value = tanf(a); break;
+            case Op_Abs:    value = fabsf(a); break;
+            case Op_Floor:  value = floorf(a); break;
+            case Op_Frac:   value = a - floorf(a); break;
+            case Op_Sqrt:   value = sqrtf(a); break;
+            case Op_Hash:
+                value = sinf(a * 12.9898f) * 43758.5453f;
+                value = value - floorf(value);
+                break;
+            case Op_Clamp:
+                value = (a < b) ? b : a;
+                value = (value > r[pIns->C]) ? r[pIns->C] : value;
+                break;
+            case Op_Lerp:   value = a + (b - a) * r[pIns->C]; break;
+            default:        value = 0.0f; break;
+            }
+
+            r[pIns->Dest] = value;
+        }
+    }
+
+    bool VSExpressionEngine::Write(_Inout_ Expression & expr)
+    {
+        Float4 value = {0.0f, 0.0f, 0.0f, 0.0f};
+        memcpy(&value, &m_Registers[expr.Output], expr.Components * sizeof(float));
+
+        if (expr.Written && memcmp(&value, &expr.Last, sizeof(Float4)) == 0)
+        {
+            return false;
+        }
+
+        expr.Last = value;
+        expr.Written = true;
+
+        switch (expr.Type)
+        {
+        case VSPT_Float:
+            expr.pParam->SetVector(value);
+            break;
+        case VSPT_Int:
+            expr.pParam->SetInt(static_cast<int32_t>(value.X));
+            break;
+        case VSPT_Bool:
+            expr.pParam->SetBool(value.X != 0.0f);
+            break;
+        default:
+            return false;
+        }
+
+        return true;
+    }
+
+    uint32_t VSExpressionEngine::AddRegisters(_In_ CONST uint32_t count)
+    {
+        uint32_t index = static_cast<uint32_t>(m_Registers.size());
+        m_Registers.resize(index + count, 0.0f);
+        return index;
+    }
+
+    uint32_t VSExpressionEngine::AddConstant(_In_ CONST float value)
+    {
+        uint32_t index = this->AddRegisters(1);
+        m_Registers[index] = value;
+        return index;
+    }
+
+    uint32_t VSExpressionEngine::AddSymbol(_In_ CONST String & name)
+    {
+        for (uint32_t i = 0; i < m_Symbols.size(); ++i)
+        {
+            if (m_Symbols[i].Name == name)
+            {
+                return i;
+            }
+        }
+
+        Symbol symbol = { name, this->AddRegisters(4), NoSource, nullptr, VSPT_Unknown };
+        m_Symbols.push_back(symbol);
+        return static_cast<uint32_t>(m_Symbols.size() - 1);
+    }
+}
@@ -0,0 +1,203 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooInternal.hpp"
+// System
+#pragma warning(push,3)
+#include <locale.h>
+#pragma warning(pop)
+
+namespace VoodooShader
+{
+    /**
+     * Drives parameters from expressions, evaluated together once per frame by ICore::Update(). Expressions are compiled
+     * into a single flat program over one register file, ordered so each runs after the expressions it reads, and the
+     * results are set on their parameters once the whole program has run. Parameters are only set when their value
+     * changes.
+     *
+     * An expression is a list of up to four comma-separated components, each built from numbers, the operators
+     * <code>+ - * / % ^</code>, parentheses, the functions <code>sin cos tan abs floor frac sqrt hash</code> (one argument),
+     * <code>min max pow step</code> (two) and <code>clamp lerp</code> (three), the built-ins <code>time</code>,
+     * <code>delta</code>, <code>frame</code> and <code>random</code>, and the names of core parameters with an optional
+     * component (<code>resolution.y</code>). Parameters driven by another expression are read from the same frame; others
+     * are read from the parameter before the program runs.
+     *
+     * Parameters are not referenced by the engine, so they must be removed before they are destroyed.
+     */
+    class VSExpressionEngine
+    {
+    public:
+        VSExpressionEngine(_In_ ICore * pCore);
+        ~VSExpressionEngine();
+
+        /**
+         * Compiles an expression and drives a parameter with it, replacing any previous expression for the parameter.
+         *
+         * @param pParam The parameter to drive, which must be a float, int or bool parameter.
+         * @param name The name other expressions use to read the parameter, or empty if they cannot.
+         * @param expression The expression, or empty to stop driving the parameter.
+         * @return VSFERR_INVALIDPARAMS if the expression could not be compiled or depends on itself; the reason is logged.
+         */
+        VoodooResult Set(_In_ IParameter * pParam, _In_ CONST String & name, _In_ CONST String & expression);
+        /**
+         * Stops driving a parameter, if it has an expression.
+         */
+        void Remove(_In_ IParameter * pParam);
+        /**
+         * Looks up the parameters read by expressions again before the next evaluation, after core parameters have been
+         * created or removed.
+         */
+        void Invalidate();
+        /**
+         * Evaluates every expression and sets the parameters they drive.
+         *
+         * @param parameters The core's parameters, used to find parameters read but not driven by an expression.
+         * @return The number of parameters set.
+         */
+        uint32_t Evaluate(_In_ CONST ParameterMap & parameters);
+
+        /**
+         * Counts the components of an expression, without compiling it.
+         */
+        static uint32_t GetComponents(_In_ CONST String & expression);
+
+    private:
+        VSExpressionEngine(CONST VSExpressionEngine & other);
+        VSExpressionEngine & operator=(CONST VSExpressionEngine & other);
+
+        class Parser;
+
+        enum Builtin : uint16_t
+        {
+            Builtin_Time    = 0x00,
+            Builtin_Delta   = 0x01,
+            Builtin_Frame   = 0x02,
+            Builtin_Random  = 0x03,
+            Builtin_Count   = 0x04,
+        };
+
+        enum Opcode : uint16_t
+        {
+            Op_Move,
+            Op_Add,
+            Op_Sub,
+            Op_Mul,
+            Op_Div,
+            Op_Mod,
+            Op_Neg,
+            Op_Pow,
+            Op_Min,
+            Op_Max,
+            Op_Step,
+            Op_Sin,
+            Op_Cos,
+            Op_Tan,
+            Op_Abs,
+            Op_Floor,
+            Op_Frac,
+            Op_Sqrt,
+            Op_Hash,
+            Op_Clamp,
+            Op_Lerp,
+        };
+
+        /**
+         * Three-address instruction, reading registers A to C (as used by the opcode) and writing Dest.
+         */
+        struct Instruction
+        {
+            Opcode Op;
+            uint16_t Dest;
+            uint16_t A;
+            uint16_t B;
+            uint16_t C;
+        };
+        typedef std::vector<Instruction> InstructionVector;
+
+        struct Expression
+        {
+            IParameter * pParam;
+            ParameterType Type;
+            String Name;
+            String Text;
+            uint32_t Components;
+            /** First of the four registers holding the result. */
+            uint32_t Output;
+            InstructionVector Code;
+            /** Symbols read by the code. */
+            std::vector<uint32_t> Reads;
+            /** The value last set on the parameter. */
+            Float4 Last;
+            bool Written;
+        };
+        typedef std::vector<Expression> ExpressionVector;
+
+        /**
+         * Named value read by expressions, stored in four registers. Symbols are either driven by an expression, or read
+         * from the core parameter of the same name.
+         */
+        struct Symbol
+        {
+            String Name;
+            uint32_t Register;
+            uint32_t Source;
+            IParameter * pInput;
+            ParameterType InputType;
+        };
+        typedef std::vector<Symbol> SymbolVector;
+
+        /**
+         * Recompiles every expression into a new register file and program, logging any that fail.
+         *
+         * @return True if every expression was compiled and none depend on themselves.
+         */
+        bool Rebuild();
+        bool Order(_In_ CONST uint32_t index, _Inout_ std::vector<uint8_t> & state);
+        void Resolve(_In_ CONST ParameterMap & parameters);
+        void Run();
+        bool Write(_Inout_ Expression & expr);
+
+        uint32_t AddRegisters(_In_ CONST uint32_t count);
+        uint32_t AddConstant(_In_ CONST float value);
+        uint32_t AddSymbol(_In_ CONST String & name);
+
+        ICore * m_Core;
+
+        ExpressionVector m_Expressions;
+        SymbolVector m_Symbols;
+        std::vector<float> m_Registers;
+        /** The code of every expression, in dependency order. */
+        InstructionVector m_Program;
+        /** Expressions in the order they are run. */
+        std::vector<uint32_t> m_Order;
+        /** Symbols read from core parameters. */
+        std::vector<uint32_t> m_Inputs;
+        bool m_Resolve;
+
+        LARGE_INTEGER m_Frequency;
+        LARGE_INTEGER m_Start;
+        LARGE_INTEGER m_Previous;
+        uint32_t m_Frame;
+        uint32_t m_Seed;
+        /** C locale for parsing numbers, so a decimal point is accepted whatever the process locale. */
+        _locale_t m_Locale;
+    };
+}
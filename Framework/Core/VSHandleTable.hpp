@@ -0,0 +1,148 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooInternal.hpp"
+
+namespace VoodooShader
+{
+    /**
+     * Slot table resolving generation-checked handles to objects, without hashing or comparing names. Each handle packs a
+     * slot index in its low 16 bits and the slot's generation in the high 16; the generation changes whenever a slot is
+     * emptied, so handles to removed objects resolve to nothing rather than to the slot's next object. Freed slots are
+     * reused, keeping the table as small as the number of live objects.
+     *
+     * The table does not reference the objects it holds; the core's named indices own them.
+     */
+    template<typename T>
+    class VSHandleTable
+    {
+    public:
+        VSHandleTable()
+        { }
+
+        /**
+         * Adds an object to the table.
+         *
+         * @return The handle, or 0 if the table is full.
+         */
+        uint32_t Add(_In_ T * pObject)
+        {
+            uint32_t index;
+            if (!m_Free.empty())
+            {
+                index = m_Free.back();
+                m_Free.pop_back();
+            }
+            else if (m_Slots.size() <= IndexMask)
+            {
+                index = static_cast<uint32_t>(m_Slots.size());
+                Slot slot = { nullptr, 1 };
+                m_Slots.push_back(slot);
+            }
+            else
+            {
+                return 0;
+            }
+
+            m_Slots[index].pObject = pObject;
+            return (static_cast<uint32_t>(m_Slots[index].Generation) << 16) | index;
+        }
+
+        /**
+         * Removes the object with the given handle, if the handle is still valid.
+         */
+        void Remove(_In_ CONST uint32_t handle)
+        {
+            uint32_t index = handle & IndexMask;
+            if (!this->Resolve(handle))
+            {
+                return;
+            }
+
+            Slot & slot = m_Slots[index];
+            slot.pObject = nullptr;
+
+            // Skip generation 0 on wrap, so no handle is ever 0
+            if (++slot.Generation == 0)
+            {
+                slot.Generation = 1;
+            }
+
+            m_Free.push_back(index);
+        }
+
+        /**
+         * Retrieves the object with the given handle.
+         *
+         * @return The object, or nullptr if the handle is invalid or the object has been removed.
+         */
+        T * Resolve(_In_ CONST uint32_t handle) CONST
+        {
+            uint32_t index = handle & IndexMask;
+            if (index >= m_Slots.size())
+            {
+                return nullptr;
+            }
+
+            CONST Slot & slot = m_Slots[index];
+            return (slot.Generation == (handle >> 16)) ? slot.pObject : nullptr;
+        }
+
+        /**
+         * Retrieves the handle of an object, by searching the table. This is meant for setup code, handles are also
+         * returned when objects are added.
+         *
+         * @return The handle, or 0 if the object is not in the table.
+         */
+        uint32_t Find(_In_ CONST T * pObject) CONST
+        {
+            if (!pObject)
+            {
+                return 0;
+            }
+
+            for (uint32_t index = 0; index < m_Slots.size(); ++index)
+            {
+                if (m_Slots[index].pObject == pObject)
+                {
+                    return (static_cast<uint32_t>(m_Slots[index].Generation) << 16) | index;
+                }
+            }
+
+            return 0;
+        }
+
+    private:
+        VSHandleTable(CONST VSHandleTable & other);
+        VSHandleTable & operator=(CONST VSHandleTable & other);
+
+        static CONST uint32_t IndexMask = 0xFFFF;
+
+        struct Slot
+        {
+            T * pObject;
+            uint16_t Generation;
+        };
+
+        std::vector<Slot> m_Slots;
+        std::vector<uint32_t> m_Free;
+    };
+}
@@ -68,46 +68,26 @@ namespace VoodooShader
 
     uint32_t VOODOO_METHODTYPE VSLogger::Release() CONST
     {
-        if (SAFE_DECREMENT(m_Refs) == 0)
+        uint32_t count = SAFE_DECREMENT(m_Refs);
+        if (count == 0)
         {
             delete this;
-            return 0;
-        }
-        else
-        {
-            return m_Refs;
         }
+        return count;
     }
 
     VoodooResult VOODOO_METHODTYPE VSLogger::QueryInterface(_In_ Uuid refid, _Outptr_result_maybenull_ IObject ** ppOut)
     {
-        if (!ppOut)
+        static CONST InterfaceMapEntry map[] =
         {
-            return VSFERR_INVALIDPARAMS;
-        }
-        else
-        {
-            if (refid == IID_IObject)
-            {
-                *ppOut = static_cast<IObject*>(this);
-            }
-            else if (refid == IID_ILogger)
-            {
-                *ppOut = static_cast<ILogger*>(this);
-            }
-            else if (refid == CLSID_VSLogger)
-            {
-                *ppOut = static_cast<VSLogger*>(this);
-            }
-            else
-            {
-                *ppOut = nullptr;
-                return VSFERR_INVALIDUUID;
-            }
-
-            (*ppOut)->AddRef();
-            return VSF_OK;
-        }
+            VOODOO_INTERFACE_ENTRY(VSLogger, IObject),
+            VOODOO_INTERFACE_ENTRY(VSLogger, ILogger),
+            VOODOO_CLASS_ENTRY(VSLogger),
+            VOODOO_INTERFACE_MAP_END
+        };
+        static volatile LONG hint = 0;
+
+        return QueryInterfaceMap(this, map, &hint, refid, ppOut);
     }
 
     String VOODOO_METHODTYPE VSLogger::ToString() CONST
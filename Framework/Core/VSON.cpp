@@ -0,0 +1,1277 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+#include "VoodooFramework.hpp"
+// System
+#pragma warning(push,3)
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#pragma warning(pop)
+
+namespace VoodooShader
+{
+    static const VSONSlice EmptySlice = { nullptr, 0 };
+
+    inline bool IsSpace(char c)         { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+    inline bool IsDigit(char c)         { return c >= '0' && c <= '9'; }
+    inline bool IsIdentStart(char c)    { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+    inline bool IsIdentChar(char c)     { return IsIdentStart(c) || IsDigit(c) || c == '_'; }
+
+    inline bool SliceEquals(CONST VSONSlice & slice, CONST char * str)
+    {
+        size_t len = strlen(str);
+        return slice.Length == len && (len == 0 || memcmp(slice.Data, str, len) == 0);
+    }
+
+    inline bool SliceStartsWith(CONST VSONSlice & slice, CONST char * str)
+    {
+        size_t len = strlen(str);
+        return slice.Length >= len && memcmp(slice.Data, str, len) == 0;
+    }
+
+    /**
+     * Parses an integer from a slice, as <code>[-+]?[0-9]+(\.[0-9]*)?</code>. Any fractional part is truncated and the
+     * result is clamped to the range of int64_t.
+     */
+    static bool ParseInteger(CONST VSONSlice & slice, int64_t * pValue)
+    {
+        CONST char * pos = slice.Data;
+        CONST char * end = slice.Data + slice.Length;
+        if (pos == end) return false;
+
+        bool negative = (*pos == '-');
+        if (*pos == '-' || *pos == '+') ++pos;
+        if (pos == end || !IsDigit(*pos)) return false;
+
+        uint64_t value = 0;
+        bool clamped = false;
+        while (pos != end && IsDigit(*pos))
+        {
+            uint32_t digit = (uint32_t)(*pos - '0');
+            if (value > (UINT64_MAX - digit) / 10)
+            {
+                clamped = true;
+            }
+            else
+            {
+                value = value * 10 + digit;
+            }
+            ++pos;
+        }
+
+        if (pos != end && *pos == '.')
+        {
+            ++pos;
+            while (pos != end && IsDigit(*pos)) ++pos;
+        }
+
+        if (pos != end) return false;
+
+        if (negative)
+        {
+            *pValue = (clamped || value > (uint64_t)INT64_MAX + 1) ? INT64_MIN : (int64_t)(0 - value);
+        }
+        else
+        {
+            *pValue = (clamped || value > (uint64_t)INT64_MAX) ? INT64_MAX : (int64_t)value;
+        }
+        return true;
+    }
+
+    /**
+     * Parses a decimal from a slice, as <code>[-+]?[0-9]+(\.[0-9]*)?([eE][-+]?[0-9]+)?</code>. This does not depend on
+     * the C locale, unlike strtod.
+     */
+    static bool ParseDecimal(CONST VSONSlice & slice, double * pValue)
+    {
+        CONST char * pos = slice.Data;
+        CONST char * end = slice.Data + slice.Length;
+        if (pos == end) return false;
+
+        bool negative = (*pos == '-');
+        if (*pos == '-' || *pos == '+') ++pos;
+        if (pos == end || !IsDigit(*pos)) return false;
+
+        double value = 0.0;
+        while (pos != end && IsDigit(*pos))
+        {
+            value = value * 10.0 + (*pos - '0');
+            ++pos;
+        }
+
+        if (pos != end && *pos == '.')
+        {
+            ++pos;
+            double scale = 0.1;
+            while (pos != end && IsDigit(*pos))
+            {
+                value += (*pos - '0') * scale;
+                scale *= 0.1;
+                ++pos;
+            }
+        }
+
+        if (pos != end && (*pos == 'e' || *pos == 'E'))
+        {
+            ++pos;
+            bool negexp = (pos != end && *pos == '-');
+            if (pos != end && (*pos == '-' || *pos == '+')) ++pos;
+            if (pos == end || !IsDigit(*pos)) return false;
+
+            int exponent = 0;
+            while (pos != end && IsDigit(*pos))
+            {
+                if (exponent < 1000) exponent = exponent * 10 + (*pos - '0');
+                ++pos;
+            }
+
+            double factor = 1.0, base = 10.0;
+            while (exponent)
+            {
+                if (exponent & 1) factor *= base;
+                base *= base;
+                exponent >>= 1;
+            }
+            value = negexp ? value / factor : value * factor;
+        }
+
+        if (pos != end) return false;
+
+        *pValue = negative ? -value : value;
+        return true;
+    }
+
+    /**
+     * Infers the type of an unquoted value, testing boolean, decimal, integer and string in that order.
+     */
+    static VSONType InferType(CONST VSONSlice & value)
+    {
+        if (SliceEquals(value, "true") || SliceEquals(value, "false"))
+        {
+            return VSONT_Boolean;
+        }
+
+        bool digits = false, point = false;
+        for (uint32_t i = 0; i < value.Length; ++i)
+        {
+            char c = value.Data[i];
+            if (IsDigit(c))
+            {
+                digits = true;
+            }
+            else if (c == '.' && digits && !point)
+            {
+                point = true;
+            }
+            else if (i == 0 && (c == '-' || c == '+'))
+            {
+                continue;
+            }
+            else
+            {
+                return VSONT_String;
+            }
+        }
+
+        if (!digits)
+        {
+            return VSONT_String;
+        }
+        return point ? VSONT_Decimal : VSONT_Integer;
+    }
+
+    static bool ExplicitType(CONST VSONSlice & type, VSONType * pType)
+    {
+        if (SliceEquals(type, "boolean") || SliceEquals(type, "bool"))
+        {
+            *pType = VSONT_Boolean;
+        }
+        else if (SliceEquals(type, "integer") || SliceEquals(type, "int"))
+        {
+            *pType = VSONT_Integer;
+        }
+        else if (SliceEquals(type, "decimal") || SliceEquals(type, "dec"))
+        {
+            *pType = VSONT_Decimal;
+        }
+        else if (SliceEquals(type, "string"))
+        {
+            *pType = VSONT_String;
+        }
+        else if (SliceEquals(type, "parsed"))
+        {
+            *pType = VSONT_Parsed;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Retrieves a slice as a string, processing escape sequences if requested. Escapes are all ASCII, so they are
+     * resolved on the raw bytes and the result is then decoded as UTF-8 with its explicit length.
+     */
+    static void Unescape(CONST VSONSlice & slice, bool escaped, String * pValue)
+    {
+        pValue->Clear();
+        if (slice.Length == 0) return;
+
+        std::string bytes;
+        CONST char * pBytes = slice.Data;
+        int length = (int)slice.Length;
+
+        if (escaped && memchr(slice.Data, '\\', slice.Length))
+        {
+            bytes.reserve(slice.Length);
+            for (uint32_t i = 0; i < slice.Length; ++i)
+            {
+                char c = slice.Data[i];
+                if (c == '\\' && i + 1 < slice.Length)
+                {
+                    c = slice.Data[++i];
+                    switch (c)
+                    {
+                    case 'n': c = '\n'; break;
+                    case 'r': c = '\r'; break;
+                    case 't': c = '\t'; break;
+                    default: break;
+                    }
+                }
+                bytes.push_back(c);
+            }
+
+            pBytes = bytes.data();
+            length = (int)bytes.size();
+        }
+
+        int wideLength = MultiByteToWideChar(CP_UTF8, 0, pBytes, length, nullptr, 0);
+        if (wideLength <= 0) return;
+
+        std::vector<wchar_t> wide((uint32_t)wideLength);
+        MultiByteToWideChar(CP_UTF8, 0, pBytes, length, &wide[0], wideLength);
+        *pValue = String((uint32_t)wideLength, &wide[0]);
+    }
+
+    VSONReader::VSONReader(_In_reads_(size) CONST char * pBuffer, _In_ CONST uint32_t size) :
+        m_Begin(pBuffer), m_End(pBuffer + size), m_Pos(pBuffer), m_Line(1), m_Depth(0), m_Regions(0),
+        m_Started(false), m_Tagged(false), m_Literal(true), m_Escaped(false), m_Error(nullptr),
+        m_Version(EmptySlice), m_Type(EmptySlice), m_Name(EmptySlice), m_Value(EmptySlice),
+        m_ValueType(VSONT_Unknown), m_ElementLine(0)
+    {
+        if (size >= 3 && (unsigned char)pBuffer[0] == 0xEF && (unsigned char)pBuffer[1] == 0xBB &&
+            (unsigned char)pBuffer[2] == 0xBF)
+        {
+            m_Pos += 3;
+        }
+    }
+
+    VSONReader::~VSONReader()
+    { }
+
+    VSONToken VSONReader::Next()
+    {
+        if (m_Error)
+        {
+            return VSON_Error;
+        }
+
+        m_Type = m_Name = m_Value = EmptySlice;
+        m_ValueType = VSONT_Unknown;
+        m_Escaped = false;
+
+        if (!m_Started)
+        {
+            m_Started = true;
+            this->ReadLanguageTag();
+        }
+
+        for (;;)
+        {
+            if (m_Literal)
+            {
+                VSONToken token = this->ReadLiteral();
+                if (token == VSON_Literal || m_Pos >= m_End || m_Error)
+                {
+                    return token;
+                }
+                continue;
+            }
+
+            this->SkipSpace();
+            m_ElementLine = m_Line;
+
+            if (m_Pos >= m_End)
+            {
+                if (m_Depth > 0)
+                {
+                    return this->Fail("Unexpected end of document within an object.");
+                }
+                else if (m_Regions > 0 || !m_Tagged)
+                {
+                    return this->Fail("Unexpected end of document within a parsed region.");
+                }
+                return VSON_End;
+            }
+
+            if (this->AtDirective())
+            {
+                VSONSlice directive;
+                if (!this->ReadDirective(&directive))
+                {
+                    return VSON_Error;
+                }
+
+                if (SliceEquals(directive, "{{"))
+                {
+                    ++m_Regions;
+                }
+                else if (SliceEquals(directive, "}}"))
+                {
+                    if (m_Depth > 0)
+                    {
+                        return this->Fail("Parsed region closed within an object.");
+                    }
+                    else if (m_Regions > 0)
+                    {
+                        --m_Regions;
+                    }
+                    else if (!m_Tagged)
+                    {
+                        m_Literal = true;
+                    }
+                    else
+                    {
+                        return this->Fail("Unbalanced parsed region directive.");
+                    }
+                }
+                else if (SliceEquals(directive, "[["))
+                {
+                    return this->ReadLiteralRegion();
+                }
+                else if (SliceStartsWith(directive, "VSON"))
+                {
+                    return this->Fail("Language tag must be on the first content line.");
+                }
+                else
+                {
+                    return this->Fail("Unknown directive.");
+                }
+                continue;
+            }
+
+            char c = *m_Pos;
+            if (c == '}')
+            {
+                if (m_Depth == 0)
+                {
+                    return this->Fail("Unbalanced closing brace.");
+                }
+
+                --m_Depth;
+                ++m_Pos;
+
+                // Objects may have a trailing semicolon
+                CONST char * mark = m_Pos;
+                uint32_t line = m_Line;
+                this->SkipSpace();
+                if (m_Pos < m_End && *m_Pos == ';')
+                {
+                    ++m_Pos;
+                }
+                else
+                {
+                    m_Pos = mark;
+                    m_Line = line;
+                }
+
+                return VSON_EndObject;
+            }
+            else if (c == ';')
+            {
+                ++m_Pos;
+                continue;
+            }
+            else if (IsIdentStart(c))
+            {
+                return this->ReadElement();
+            }
+
+            return this->Fail("Unexpected character, expected an identifier.");
+        }
+    }
+
+    bool VSONReader::Skip()
+    {
+        uint32_t depth = m_Depth;
+        if (depth == 0)
+        {
+            return false;
+        }
+
+        for (;;)
+        {
+            VSONToken token = this->Next();
+            if (token == VSON_End || token == VSON_Error)
+            {
+                return false;
+            }
+            else if (token == VSON_EndObject && m_Depth < depth)
+            {
+                return true;
+            }
+        }
+    }
+
+    uint32_t VSONReader::GetDepth() CONST
+    {
+        return m_Depth;
+    }
+
+    uint32_t VSONReader::GetLine() CONST
+    {
+        return m_ElementLine;
+    }
+
+    CONST char * VSONReader::GetError() CONST
+    {
+        return m_Error;
+    }
+
+    VSONSlice VSONReader::GetVersion() CONST
+    {
+        return m_Version;
+    }
+
+    VSONSlice VSONReader::GetType() CONST
+    {
+        return m_Type;
+    }
+
+    VSONSlice VSONReader::GetName() CONST
+    {
+        return m_Name;
+    }
+
+    VSONSlice VSONReader::GetValue() CONST
+    {
+        return m_Value;
+    }
+
+    VSONType VSONReader::GetValueType() CONST
+    {
+        return m_ValueType;
+    }
+
+    bool VSONReader::GetBool(_Out_ bool * pValue) CONST
+    {
+        if (!pValue || m_ValueType == VSONT_Unknown) return false;
+
+        if (m_ValueType == VSONT_String || m_ValueType == VSONT_Parsed)
+        {
+            *pValue = (m_Value.Length > 0);
+            return true;
+        }
+        else if (SliceEquals(m_Value, "true"))
+        {
+            *pValue = true;
+            return true;
+        }
+        else if (SliceEquals(m_Value, "false"))
+        {
+            *pValue = false;
+            return true;
+        }
+
+        double value = 0.0;
+        if (ParseDecimal(m_Value, &value))
+        {
+            *pValue = (value > 0.0);
+            return true;
+        }
+        return false;
+    }
+
+    bool VSONReader::GetInteger(_Out_ int64_t * pValue) CONST
+    {
+        if (!pValue) return false;
+
+        switch (m_ValueType)
+        {
+        case VSONT_Boolean:
+            {
+                bool value = false;
+                if (!this->GetBool(&value)) return false;
+                *pValue = value ? 1 : 0;
+                return true;
+            }
+        case VSONT_Integer:
+        case VSONT_Decimal:
+            {
+                if (ParseInteger(m_Value, pValue)) return true;
+
+                // Exponent forms, clamped to the integer range
+                double value = 0.0;
+                if (!ParseDecimal(m_Value, &value)) return false;
+                if (value >= 9223372036854775807.0)
+                {
+                    *pValue = INT64_MAX;
+                }
+                else if (value <= -9223372036854775808.0)
+                {
+                    *pValue = INT64_MIN;
+                }
+                else
+                {
+                    *pValue = (int64_t)value;
+                }
+                return true;
+            }
+        default:
+            return false;
+        }
+    }
+
+    bool VSONReader::GetDecimal(_Out_ double * pValue) CONST
+    {
+        if (!pValue) return false;
+
+        switch (m_ValueType)
+        {
+        case VSONT_Boolean:
+            {
+                bool value = false;
+                if (!this->GetBool(&value)) return false;
+                *pValue = value ? 1.0 : 0.0;
+                return true;
+            }
+        case VSONT_Integer:
+            {
+                int64_t value = 0;
+                if (!this->GetInteger(&value)) return false;
+                *pValue = (double)value;
+                return true;
+            }
+        case VSONT_Decimal:
+            return ParseDecimal(m_Value, pValue);
+        default:
+            return false;
+        }
+    }
+
+    bool VSONReader::GetString(_Out_ String * pValue) CONST
+    {
+        if (!pValue) return false;
+
+        Unescape(m_Value, m_Escaped, pValue);
+        return true;
+    }
+
+    bool VSONReader::GetType(_Out_ String * pValue) CONST
+    {
+        if (!pValue) return false;
+
+        Unescape(m_Type, false, pValue);
+        return true;
+    }
+
+    bool VSONReader::GetName(_Out_ String * pValue) CONST
+    {
+        if (!pValue) return false;
+
+        Unescape(m_Name, true, pValue);
+        return true;
+    }
+
+    bool VSONReader::GetVariant(_Out_ Variant * pValue, _Inout_opt_ String * pStorage) CONST
+    {
+        if (!pValue) return false;
+
+        switch (m_ValueType)
+        {
+        case VSONT_Boolean:
+            {
+                bool value = false;
+                if (!this->GetBool(&value)) return false;
+                *pValue = CreateVariant(value);
+                return true;
+            }
+        case VSONT_Integer:
+            {
+                int64_t value = 0;
+                if (!this->GetInteger(&value)) return false;
+                if (value >= INT32_MIN && value <= INT32_MAX)
+                {
+                    *pValue = CreateVariant((int32_t)value);
+                }
+                else
+                {
+                    *pValue = CreateVariant((double)value);
+                }
+                return true;
+            }
+        case VSONT_Decimal:
+            {
+                double value = 0.0;
+                if (!this->GetDecimal(&value)) return false;
+                *pValue = CreateVariant(value);
+                return true;
+            }
+        case VSONT_String:
+        case VSONT_Parsed:
+            {
+                if (!pStorage) return false;
+                this->GetString(pStorage);
+                *pValue = CreateVariant(VSUT_String);
+                pValue->VPString = pStorage;
+                return true;
+            }
+        default:
+            return false;
+        }
+    }
+
+    VSONToken VSONReader::Fail(_In_z_ CONST char * msg)
+    {
+        m_Error = msg;
+        m_ElementLine = m_Line;
+        return VSON_Error;
+    }
+
+    VSONToken VSONReader::ReadElement()
+    {
+        VSONSlice first = this->ReadIdentifier();
+        this->SkipSpace();
+
+        if (m_Pos < m_End && *m_Pos == '=')
+        {
+            m_Name = first;
+            return this->ReadValue();
+        }
+        else if (m_Pos < m_End && IsIdentStart(*m_Pos))
+        {
+            m_Type = first;
+            m_Name = this->ReadIdentifier();
+            this->SkipSpace();
+
+            if (m_Pos >= m_End || *m_Pos != '=')
+            {
+                return this->Fail("Expected '=' after property name.");
+            }
+            return this->ReadValue();
+        }
+
+        // Object declaration
+        m_Type = first;
+        if (m_Pos < m_End && *m_Pos == '"')
+        {
+            if (!this->ReadQuoted(&m_Name))
+            {
+                return this->Fail("Unterminated object name.");
+            }
+            this->SkipSpace();
+        }
+
+        if (m_Pos >= m_End || *m_Pos != '{')
+        {
+            return this->Fail("Expected '{' after object declaration.");
+        }
+
+        ++m_Pos;
+        ++m_Depth;
+        return VSON_BeginObject;
+    }
+
+    VSONToken VSONReader::ReadValue()
+    {
+        // Skip the '='
+        ++m_Pos;
+        this->SkipSpace();
+
+        if (m_Pos >= m_End)
+        {
+            return this->Fail("Expected a value.");
+        }
+
+        bool quoted = (*m_Pos == '"');
+        if (quoted)
+        {
+            if (!this->ReadQuoted(&m_Value))
+            {
+                return this->Fail("Unterminated string value.");
+            }
+            this->SkipSpace();
+            if (m_Pos >= m_End || *m_Pos != ';')
+            {
+                return this->Fail("Expected ';' after property value.");
+            }
+        }
+        else
+        {
+            // Unquoted values run to the semicolon, trimmed of trailing space and comments
+            CONST char * start = m_Pos;
+            CONST char * last = m_Pos;
+            while (m_Pos < m_End && *m_Pos != ';')
+            {
+                char c = *m_Pos;
+                if (c == '/' && m_Pos + 1 < m_End && (m_Pos[1] == '/' || m_Pos[1] == '*'))
+                {
+                    this->SkipSpace();
+                    continue;
+                }
+                else if (c == '"')
+                {
+                    VSONSlice inner;
+                    if (!this->ReadQuoted(&inner))
+                    {
+                        return this->Fail("Unterminated string within property value.");
+                    }
+                    last = m_Pos;
+                    continue;
+                }
+                else if (c == '\n')
+                {
+                    ++m_Line;
+                }
+                else if (!IsSpace(c))
+                {
+                    last = m_Pos + 1;
+                }
+                ++m_Pos;
+            }
+
+            if (m_Pos >= m_End)
+            {
+                return this->Fail("Expected ';' after property value.");
+            }
+
+            m_Value.Data = start;
+            m_Value.Length = (uint32_t)(last - start);
+            m_Escaped = false;
+        }
+
+        // Skip the ';'
+        ++m_Pos;
+
+        if (m_Type.Length > 0)
+        {
+            if (!ExplicitType(m_Type, &m_ValueType))
+            {
+                return this->Fail("Unknown property type.");
+            }
+        }
+        else
+        {
+            m_ValueType = quoted ? VSONT_String : InferType(m_Value);
+        }
+
+        return VSON_Property;
+    }
+
+    VSONToken VSONReader::ReadLiteral()
+    {
+        // Literal text runs until a parsed region directive or the end of the document
+        CONST char * start = m_Pos;
+        m_ElementLine = m_Line;
+
+        while (m_Pos < m_End)
+        {
+            CONST char * lineStart = m_Pos;
+            uint32_t line = m_Line;
+
+            while (m_Pos < m_End && (*m_Pos == ' ' || *m_Pos == '\t')) ++m_Pos;
+
+            if (this->AtDirective())
+            {
+                VSONSlice directive;
+                CONST char * mark = m_Pos;
+                if (!this->ReadDirective(&directive))
+                {
+                    return VSON_Error;
+                }
+
+                if (SliceEquals(directive, "{{"))
+                {
+                    m_Literal = false;
+                    if (lineStart > start)
+                    {
+                        m_Value.Data = start;
+                        m_Value.Length = (uint32_t)(lineStart - start);
+                        m_ValueType = VSONT_String;
+                        return VSON_Literal;
+                    }
+                    return VSON_End;
+                }
+
+                // Other directives are part of the literal text
+                m_Pos = mark;
+                m_Line = line;
+            }
+
+            while (m_Pos < m_End && *m_Pos != '\n') ++m_Pos;
+            if (m_Pos < m_End)
+            {
+                ++m_Pos;
+                ++m_Line;
+            }
+        }
+
+        if (m_Pos > start)
+        {
+            m_Value.Data = start;
+            m_Value.Length = (uint32_t)(m_Pos - start);
+            m_ValueType = VSONT_String;
+            return VSON_Literal;
+        }
+
+        if (m_Depth > 0)
+        {
+            return this->Fail("Unexpected end of document within an object.");
+        }
+        return VSON_End;
+    }
+
+    VSONToken VSONReader::ReadLiteralRegion()
+    {
+        CONST char * start = m_Pos;
+        m_ElementLine = m_Line;
+
+        while (m_Pos < m_End)
+        {
+            CONST char * lineStart = m_Pos;
+
+            while (m_Pos < m_End && (*m_Pos == ' ' || *m_Pos == '\t')) ++m_Pos;
+
+            if (this->AtDirective())
+            {
+                VSONSlice directive;
+                if (!this->ReadDirective(&directive))
+                {
+                    return VSON_Error;
+                }
+
+                if (SliceEquals(directive, "]]"))
+                {
+                    m_Value.Data = start;
+                    m_Value.Length = (uint32_t)(lineStart - start);
+                    m_ValueType = VSONT_String;
+                    return VSON_Literal;
+                }
+                continue;
+            }
+
+            while (m_Pos < m_End && *m_Pos != '\n') ++m_Pos;
+            if (m_Pos < m_End)
+            {
+                ++m_Pos;
+                ++m_Line;
+            }
+        }
+
+        return this->Fail("Unterminated literal region.");
+    }
+
+    bool VSONReader::ReadDirective(_Out_ VSONSlice * pDirective)
+    {
+        // Skip the "//#" and any leading space
+        m_Pos += 3;
+        while (m_Pos < m_End && (*m_Pos == ' ' || *m_Pos == '\t')) ++m_Pos;
+
+        CONST char * start = m_Pos;
+        CONST char * last = m_Pos;
+        while (m_Pos < m_End && *m_Pos != '\n')
+        {
+            if (*m_Pos == '/' && m_Pos + 1 < m_End && m_Pos[1] == '/')
+            {
+                // Trailing comment
+                while (m_Pos < m_End && *m_Pos != '\n') ++m_Pos;
+                break;
+            }
+            else if (!IsSpace(*m_Pos))
+            {
+                last = m_Pos + 1;
+            }
+            ++m_Pos;
+        }
+
+        if (m_Pos < m_End)
+        {
+            ++m_Pos;
+            ++m_Line;
+        }
+
+        pDirective->Data = start;
+        pDirective->Length = (uint32_t)(last - start);
+
+        if (pDirective->Length == 0)
+        {
+            this->Fail("Empty directive.");
+            return false;
+        }
+        return true;
+    }
+
+    bool VSONReader::ReadQuoted(_Out_ VSONSlice * pSlice)
+    {
+        // Skip the opening quote
+        ++m_Pos;
+
+        CONST char * start = m_Pos;
+        while (m_Pos < m_End && *m_Pos != '"')
+        {
+            if (*m_Pos == '\\')
+            {
+                m_Escaped = true;
+                ++m_Pos;
+                if (m_Pos >= m_End) break;
+            }
+
+            if (*m_Pos == '\n') ++m_Line;
+            ++m_Pos;
+        }
+
+        if (m_Pos >= m_End)
+        {
+            return false;
+        }
+
+        pSlice->Data = start;
+        pSlice->Length = (uint32_t)(m_Pos - start);
+
+        // Skip the closing quote
+        ++m_Pos;
+        return true;
+    }
+
+    VSONSlice VSONReader::ReadIdentifier()
+    {
+        VSONSlice ident;
+        ident.Data = m_Pos;
+        while (m_Pos < m_End && IsIdentChar(*m_Pos)) ++m_Pos;
+        ident.Length = (uint32_t)(m_Pos - ident.Data);
+        return ident;
+    }
+
+    void VSONReader::ReadLanguageTag()
+    {
+        CONST char * mark = m_Pos;
+        uint32_t line = m_Line;
+
+        this->SkipSpace();
+
+        if (this->AtDirective())
+        {
+            VSONSlice directive;
+            if (this->ReadDirective(&directive) && SliceStartsWith(directive, "VSON"))
+            {
+                if (directive.Length == 4)
+                {
+                    m_Tagged = true;
+                }
+                else if (directive.Data[4] == '-')
+                {
+                    m_Tagged = true;
+                    m_Version.Data = directive.Data + 5;
+                    m_Version.Length = directive.Length - 5;
+                }
+            }
+
+            if (m_Tagged)
+            {
+                m_Literal = false;
+                return;
+            }
+
+            // Not a language tag, the directive will be read again as part of the literal document
+            m_Error = nullptr;
+        }
+
+        m_Pos = mark;
+        m_Line = line;
+    }
+
+    void VSONReader::SkipSpace()
+    {
+        while (m_Pos < m_End)
+        {
+            char c = *m_Pos;
+            if (c == '\n')
+            {
+                ++m_Line;
+                ++m_Pos;
+            }
+            else if (IsSpace(c))
+            {
+                ++m_Pos;
+            }
+            else if (c == '/' && m_Pos + 1 < m_End && m_Pos[1] == '/')
+            {
+                if (this->AtDirective())
+                {
+                    return;
+                }
+
+                while (m_Pos < m_End && *m_Pos != '\n') ++m_Pos;
+            }
+            else if (c == '/' && m_Pos + 1 < m_End && m_Pos[1] == '*')
+            {
+                m_Pos += 2;
+                while (m_Pos < m_End && !(*m_Pos == '*' && m_Pos + 1 < m_End && m_Pos[1] == '/'))
+                {
+                    if (*m_Pos == '\n') ++m_Line;
+                    ++m_Pos;
+                }
+                m_Pos = (m_Pos < m_End) ? m_Pos + 2 : m_End;
+            }
+            else
+            {
+                return;
+            }
+        }
+    }
+
+    bool VSONReader::AtDirective() CONST
+    {
+        if (m_End - m_Pos < 3 || m_Pos[0] != '/' || m_Pos[1] != '/' || m_Pos[2] != '#')
+        {
+            return false;
+        }
+
+        // Directives must be alone on their line
+        CONST char * pos = m_Pos;
+        while (pos > m_Begin)
+        {
+            char c = *(pos - 1);
+            if (c == '\n')
+            {
+                break;
+            }
+            else if (c != ' ' && c != '\t')
+            {
+                return false;
+            }
+            --pos;
+        }
+        return true;
+    }
+
+    class VSONWriter::VSONWriterImpl
+    {
+    public:
+        VSONWriterImpl() :
+            m_Depth(0)
+        { };
+
+        void Indent()
+        {
+            m_Buffer.append(m_Depth * 4, ' ');
+        }
+
+        void AppendQuoted(CONST String & str)
+        {
+            std::string value = str.ToStringA();
+            m_Buffer += '"';
+            for (std::string::const_iterator iter = value.begin(); iter != value.end(); ++iter)
+            {
+                switch (*iter)
+                {
+                case '"':  m_Buffer += "\\\""; break;
+                case '\\': m_Buffer += "\\\\"; break;
+                case '\n': m_Buffer += "\\n"; break;
+                case '\r': m_Buffer += "\\r"; break;
+                case '\t': m_Buffer += "\\t"; break;
+                default:   m_Buffer += *iter; break;
+                }
+            }
+            m_Buffer += '"';
+        }
+
+        void AppendDecimal(double value)
+        {
+            char buffer[32];
+            sprintf_s(buffer, "%.17g", value);
+
+            // Decimals must contain a point to be inferred as such
+            std::string text = buffer;
+            if (text.find_first_of(".ni") == std::string::npos)
+            {
+                size_t exp = text.find('e');
+                text.insert((exp == std::string::npos) ? text.length() : exp, ".0");
+            }
+            m_Buffer += text;
+        }
+
+    public:
+        std::string m_Buffer;
+        uint32_t m_Depth;
+    };
+
+    VSONWriter::VSONWriter(_In_ CONST bool tag)
+    {
+        m_Impl = new VSONWriterImpl();
+        if (tag)
+        {
+            m_Impl->m_Buffer = "//# VSON-0.1\n";
+        }
+    }
+
+    VSONWriter::~VSONWriter()
+    {
+        delete m_Impl;
+        m_Impl = nullptr;
+    }
+
+    bool VSONWriter::BeginObject(_In_ CONST String & type, _In_ CONST String & name)
+    {
+        VOODOO_CHECK_IMPL;
+
+        if (type.IsEmpty()) return false;
+
+        m_Impl->Indent();
+        m_Impl->m_Buffer += type.ToStringA();
+        if (!name.IsEmpty())
+        {
+            m_Impl->m_Buffer += ' ';
+            m_Impl->AppendQuoted(name);
+        }
+        m_Impl->m_Buffer += '\n';
+        m_Impl->Indent();
+        m_Impl->m_Buffer += "{\n";
+        ++m_Impl->m_Depth;
+        return true;
+    }
+
+    bool VSONWriter::EndObject()
+    {
+        VOODOO_CHECK_IMPL;
+
+        if (m_Impl->m_Depth == 0) return false;
+
+        --m_Impl->m_Depth;
+        m_Impl->Indent();
+        m_Impl->m_Buffer += "}\n";
+        return true;
+    }
+
+    bool VSONWriter::WriteProperty(_In_ CONST String & name, _In_ CONST Variant & value)
+    {
+        VOODOO_CHECK_IMPL;
+
+        if (name.IsEmpty() || value.Components > 1) return false;
+
+        char buffer[32];
+        switch (value.Type)
+        {
+        case VSUT_Bool:
+            strcpy_s(buffer, value.VBool ? "true" : "false");
+            break;
+        case VSUT_Int8:
+            sprintf_s(buffer, "%d", (int32_t)value.VInt8.X);
+            break;
+        case VSUT_UInt8:
+            sprintf_s(buffer, "%u", (uint32_t)value.VUInt8.X);
+            break;
+        case VSUT_Int16:
+            sprintf_s(buffer, "%d", (int32_t)value.VInt16.X);
+            break;
+        case VSUT_UInt16:
+            sprintf_s(buffer, "%u", (uint32_t)value.VUInt16.X);
+            break;
+        case VSUT_Int32:
+            sprintf_s(buffer, "%d", value.VInt32.X);
+            break;
+        case VSUT_UInt32:
+            sprintf_s(buffer, "%u", value.VUInt32.X);
+            break;
+        case VSUT_Float:
+        case VSUT_Double:
+            {
+                m_Impl->Indent();
+                m_Impl->m_Buffer += name.ToStringA();
+                m_Impl->m_Buffer += " = ";
+                m_Impl->AppendDecimal((value.Type == VSUT_Float) ? value.VFloat.X : value.VDouble.X);
+                m_Impl->m_Buffer += ";\n";
+                return true;
+            }
+        case VSUT_String:
+            return value.VPString && this->WriteProperty(name, *value.VPString);
+        default:
+            return false;
+        }
+
+        m_Impl->Indent();
+        m_Impl->m_Buffer += name.ToStringA();
+        m_Impl->m_Buffer += " = ";
+        m_Impl->m_Buffer += buffer;
+        m_Impl->m_Buffer += ";\n";
+        return true;
+    }
+
+    bool VSONWriter::WriteProperty(_In_ CONST String & name, _In_ CONST String & value, _In_ CONST bool parsed)
+    {
+        VOODOO_CHECK_IMPL;
+
+        if (name.IsEmpty()) return false;
+
+        m_Impl->Indent();
+        if (parsed)
+        {
+            m_Impl->m_Buffer += "parsed ";
+        }
+        m_Impl->m_Buffer += name.ToStringA();
+        m_Impl->m_Buffer += " = ";
+        m_Impl->AppendQuoted(value);
+        m_Impl->m_Buffer += ";\n";
+        return true;
+    }
+
+    bool VSONWriter::WriteLiteral(_In_ CONST String & text)
+    {
+        VOODOO_CHECK_IMPL;
+
+        m_Impl->Indent();
+        m_Impl->m_Buffer += "//# [[\n";
+        m_Impl->m_Buffer += text.ToStringA();
+        if (!text.IsEmpty() && !text.EndsWith(VSTR('\n')))
+        {
+            m_Impl->m_Buffer += '\n';
+        }
+        m_Impl->Indent();
+        m_Impl->m_Buffer += "//# ]]\n";
+        return true;
+    }
+
+    CONST char * VSONWriter::GetData() CONST
+    {
+        VOODOO_CHECK_IMPL;
+
+        return m_Impl->m_Buffer.c_str();
+    }
+
+    uint32_t VSONWriter::GetLength() CONST
+    {
+        VOODOO_CHECK_IMPL;
+
+        return (uint32_t)m_Impl->m_Buffer.length();
+    }
+}
@@ -0,0 +1,249 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooFramework.hpp"
+#include "String.hpp"
+
+namespace VoodooShader
+{
+    /**
+     * @ingroup voodoo_utility
+     * Elements produced by @ref VSONReader::Next().
+     */
+    enum VSONToken : uint32_t
+    {
+        VSON_End            = 0x00,     /* !< End of the document, no further elements will be read. */
+        VSON_Error          = 0x01,     /* !< The document is malformed, see VSONReader::GetError(). */
+        VSON_BeginObject    = 0x02,     /* !< Object declaration, type and name are available. */
+        VSON_EndObject      = 0x03,     /* !< Closing brace of the innermost object. */
+        VSON_Property       = 0x04,     /* !< Property, type, name and value are available. */
+        VSON_Literal        = 0x05,     /* !< Literal region, value holds the raw text. */
+    };
+
+    /**
+     * @ingroup voodoo_utility
+     * Value types defined by the VSON specification (see @ref voodoo_vson_types).
+     */
+    enum VSONType : uint32_t
+    {
+        VSONT_Unknown       = 0x00,
+        VSONT_Boolean       = 0x01,
+        VSONT_Integer       = 0x02,
+        VSONT_Decimal       = 0x03,
+        VSONT_String        = 0x04,
+        VSONT_Parsed        = 0x05,
+    };
+
+    /**
+     * @ingroup voodoo_utility
+     * A view into a VSON buffer. Slices are never null-terminated and are only valid while the source buffer is.
+     */
+    struct VSONSlice
+    {
+        CONST char * Data;
+        uint32_t Length;
+    };
+
+    /**
+     * @ingroup voodoo_utility
+     * Streaming VSON reader. This tokenizes a buffer in place, without building a document or copying any text, and
+     * exposes the current element through a cursor. Values are converted on request, following the conversion rules in
+     * the @ref voodoo_vson "VSON specification".
+     *
+     * @note The reader does not take ownership of the buffer, which must remain valid and unchanged while any slices
+     *      retrieved from the reader are in use.
+     */
+    class VOODOO_API VSONReader
+    {
+    public:
+        /**
+         * Creates a reader for the given buffer. A leading UTF-8 byte order mark is skipped.
+         *
+         * @param pBuffer The document text, need not be null-terminated.
+         * @param size The size of the document, in bytes.
+         */
+        VSONReader(_In_reads_(size) CONST char * pBuffer, _In_ CONST uint32_t size);
+        ~VSONReader();
+
+        /**
+         * @name Cursor
+         * @{
+         */
+        /**
+         * Advances to the next element in the document.
+         *
+         * @return The element type. Once VSON_End or VSON_Error has been returned, all further calls return the same.
+         */
+        VSONToken Next();
+        /**
+         * Skips the remainder of the innermost open object, including its closing brace.
+         *
+         * @return True if the object was closed, false if the document ended or was malformed first.
+         */
+        bool Skip();
+        /**
+         * Retrieves the number of objects currently open.
+         */
+        uint32_t GetDepth() CONST;
+        /**
+         * Retrieves the line of the current element, starting at 1.
+         */
+        uint32_t GetLine() CONST;
+        /**
+         * Retrieves the error message, if the document was malformed.
+         *
+         * @return A static message, or nullptr if no error has occurred.
+         */
+        CONST char * GetError() CONST;
+        /**
+         * Retrieves the version given in the language tag, if one was present.
+         */
+        VSONSlice GetVersion() CONST;
+        /**
+         * @}
+         * @name Current Element
+         * @{
+         */
+        /**
+         * Retrieves the type identifier of the current object, or the explicit type of the current property (empty if the
+         * type was inferred).
+         */
+        VSONSlice GetType() CONST;
+        /**
+         * Retrieves the name of the current object or property. Object names are returned without quotes and with any
+         * escape sequences intact.
+         */
+        VSONSlice GetName() CONST;
+        /**
+         * Retrieves the raw value of the current property or literal region. Quoted values are returned without quotes and
+         * with any escape sequences intact.
+         */
+        VSONSlice GetValue() CONST;
+        /**
+         * Retrieves the type of the current property, either as given or as inferred from the value.
+         */
+        VSONType GetValueType() CONST;
+        /**
+         * @}
+         * @name Value Access
+         * @{
+         */
+        bool GetBool(_Out_ bool * pValue) CONST;
+        bool GetInteger(_Out_ int64_t * pValue) CONST;
+        bool GetDecimal(_Out_ double * pValue) CONST;
+        /**
+         * Retrieves the current value as a string, processing any escape sequences. This is the only value accessor that
+         * allocates. Names and types are retrieved the same way, through GetName(String*) and GetType(String*).
+         */
+        bool GetString(_Out_ String * pValue) CONST;
+        bool GetName(_Out_ String * pValue) CONST;
+        bool GetType(_Out_ String * pValue) CONST;
+        /**
+         * Retrieves the current value as a variant. Booleans become VSUT_Bool, integers become VSUT_Int32 (or VSUT_Double
+         * if they are out of range) and decimals become VSUT_Double.
+         *
+         * @param pValue The variant to fill.
+         * @param pStorage Storage for string values; if given, string and parsed values are retrieved into it and the
+         *      variant points to it as VSUT_String.
+         * @return False if the value cannot be represented (including strings when @p pStorage is null).
+         */
+        bool GetVariant(_Out_ Variant * pValue, _Inout_opt_ String * pStorage = nullptr) CONST;
+        /**
+         * @}
+         */
+
+    private:
+        VSONReader(CONST VSONReader & other);
+        VSONReader & operator=(CONST VSONReader & other);
+
+        VSONToken Fail(_In_z_ CONST char * msg);
+        VSONToken ReadElement();
+        VSONToken ReadValue();
+        VSONToken ReadLiteral();
+        VSONToken ReadLiteralRegion();
+        bool ReadDirective(_Out_ VSONSlice * pDirective);
+        bool ReadQuoted(_Out_ VSONSlice * pSlice);
+        VSONSlice ReadIdentifier();
+        void ReadLanguageTag();
+        void SkipSpace();
+        bool AtDirective() CONST;
+
+        CONST char * m_Begin;
+        CONST char * m_End;
+        CONST char * m_Pos;
+        uint32_t m_Line;
+        uint32_t m_Depth;
+        uint32_t m_Regions;
+        bool m_Started;
+        bool m_Tagged;
+        bool m_Literal;
+        bool m_Escaped;
+        CONST char * m_Error;
+
+        VSONSlice m_Version;
+        VSONSlice m_Type;
+        VSONSlice m_Name;
+        VSONSlice m_Value;
+        VSONType m_ValueType;
+        uint32_t m_ElementLine;
+    };
+
+    /**
+     * @ingroup voodoo_utility
+     * VSON writer, producing a tagged document in the format read by @ref VSONReader. Values are written in their
+     * canonical representation, with explicit types only where the type could not be inferred.
+     */
+    class VOODOO_API VSONWriter
+    {
+        class VSONWriterImpl;
+
+    public:
+        /**
+         * Creates a writer, optionally starting the document with a language tag.
+         */
+        VSONWriter(_In_ CONST bool tag = true);
+        ~VSONWriter();
+
+        bool BeginObject(_In_ CONST String & type, _In_ CONST String & name = String());
+        bool EndObject();
+        /**
+         * Writes a property from a variant. Only single-component numeric, boolean and string variants can be written.
+         */
+        bool WriteProperty(_In_ CONST String & name, _In_ CONST Variant & value);
+        bool WriteProperty(_In_ CONST String & name, _In_ CONST String & value, _In_ CONST bool parsed = false);
+        /**
+         * Writes a literal region containing the given text.
+         */
+        bool WriteLiteral(_In_ CONST String & text);
+
+        /**
+         * Retrieves the document written so far. The buffer is valid until the writer is next modified.
+         */
+        CONST char * GetData() CONST;
+        uint32_t GetLength() CONST;
+
+    private:
+        VSONWriter(CONST VSONWriter & other);
+        VSONWriter & operator=(CONST VSONWriter & other);
+
+        VSONWriterImpl * m_Impl;
+    };
+}
@@ -81,48 +81,28 @@ namespace VoodooShader
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
 
-        if (SAFE_DECREMENT(m_Refs) == 0)
+        uint32_t count = SAFE_DECREMENT(m_Refs);
+        if (count == 0)
         {
             delete this;
-            return 0;
-        }
-        else
-        {
-            return m_Refs;
         }
+        return count;
     }
 
     VoodooResult VOODOO_METHODTYPE VSParser::QueryInterface(_In_ Uuid refid, _Outptr_result_maybenull_ IObject ** ppOut)
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
 
-        if (!ppOut)
+        static CONST InterfaceMapEntry map[] =
         {
-            return VSFERR_INVALIDPARAMS;
-        }
-        else
-        {
-            if (refid == IID_IObject)
-            {
-                *ppOut = static_cast<IObject*>(this);
-            }
-            else if (refid == IID_IParser)
-            {
-                *ppOut = static_cast<IParser*>(this);
-            }
-            else if (refid == CLSID_VSParser)
-            {
-                *ppOut = static_cast<VSParser*>(this);
-            }
-            else
-            {
-                *ppOut = nullptr;
-                return VSFERR_INVALIDUUID;
-            }
-
-            (*ppOut)->AddRef();
-            return VSF_OK;
-        }
+            VOODOO_INTERFACE_ENTRY(VSParser, IObject),
+            VOODOO_INTERFACE_ENTRY(VSParser, IParser),
+            VOODOO_CLASS_ENTRY(VSParser),
+            VOODOO_INTERFACE_MAP_END
+        };
+        static volatile LONG hint = 0;
+
+        return QueryInterfaceMap(this, map, &hint, refid, ppOut);
     }
 
     String VOODOO_METHODTYPE VSParser::ToString() CONST
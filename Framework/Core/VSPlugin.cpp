@@ -25,42 +25,95 @@ namespace VoodooShader
     #define VOODOO_DEBUG_TYPE VSPlugin
     DeclareDebugCache();
 
-    VSPlugin * VSPlugin::Load(_In_ IPluginServer * pServer, _In_ CONST String & path)
+    bool VSPlugin::Resolve(_In_ CONST String & path, _Out_ Exports * pExports)
     {
+        ZeroMemory(pExports, sizeof(Exports));
+
         // Load the module
         HMODULE hmodule = LoadLibraryEx(path.GetData(), nullptr, LOAD_WITH_ALTERED_SEARCH_PATH);
 
-        // First set of error checks
-        if (hmodule != nullptr)
+        if (hmodule == nullptr)
         {
-            VSPlugin * module = new VSPlugin(pServer, hmodule);
+            return false;
+        }
 
-            // Disable conversion warnings, since GetProcAddress always returns FARPROC
+        // Disable conversion warnings, since GetProcAddress always returns FARPROC
 #pragma warning(push)
 #pragma warning(disable: 4191)
-            module->m_PluginInit  = reinterpret_cast<Functions::PluginInitFunc>(GetProcAddress(hmodule, "PluginInit"));
-            module->m_PluginReset = reinterpret_cast<Functions::PluginResetFunc>(GetProcAddress(hmodule, "PluginReset"));
-            module->m_ClassCount  = reinterpret_cast<Functions::ClassCountFunc>(GetProcAddress(hmodule, "ClassCount"));
-            module->m_ClassInfo   = reinterpret_cast<Functions::ClassInfoFunc>(GetProcAddress(hmodule, "ClassInfo"));
-            module->m_ClassCreate = reinterpret_cast<Functions::ClassCreateFunc>(GetProcAddress(hmodule, "ClassCreate"));
+        Functions::PluginDescFunc descFunc = reinterpret_cast<Functions::PluginDescFunc>(GetProcAddress(hmodule, "PluginDesc"));
 #pragma warning(pop)
 
-            if
-            (
-                module->m_PluginInit  == nullptr ||
-                module->m_PluginReset == nullptr ||
-                module->m_ClassCount  == nullptr ||
-                module->m_ClassInfo   == nullptr ||
-                module->m_ClassCreate == nullptr
-            )
-            {
-                delete module;
-                return nullptr;
-            }
-            else
-            {
-                return module;
-            }
+        // A descriptor replaces the other exports, so a single lookup binds the whole module
+        CONST PluginDesc * pDesc = (descFunc) ? descFunc() : nullptr;
+        if
+        (
+            pDesc &&
+            pDesc->AbiVersion == VOODOO_PLUGIN_ABI &&
+            pDesc->Size >= sizeof(PluginDesc) &&
+            pDesc->PluginInit != nullptr &&
+            (pDesc->ClassCount == 0 || (pDesc->Classes != nullptr && pDesc->ClassCreate != nullptr))
+        )
+        {
+            pExports->Handle      = hmodule;
+            pExports->Desc        = pDesc;
+            pExports->PluginInit  = pDesc->PluginInit;
+            pExports->PluginReset = pDesc->PluginReset;
+            pExports->ClassCreate = pDesc->ClassCreate;
+            pExports->PluginCanUnload = pDesc->CanUnload;
+            return true;
+        }
+
+#pragma warning(push)
+#pragma warning(disable: 4191)
+        pExports->PluginInit    = reinterpret_cast<Functions::PluginInitFunc>(GetProcAddress(hmodule, "PluginInit"));
+        pExports->PluginReset   = reinterpret_cast<Functions::PluginResetFunc>(GetProcAddress(hmodule, "PluginReset"));
+        pExports->ClassCount    = reinterpret_cast<Functions::ClassCountFunc>(GetProcAddress(hmodule, "ClassCount"));
+        pExports->ClassInfo     = reinterpret_cast<Functions::ClassInfoFunc>(GetProcAddress(hmodule, "ClassInfo"));
+        pExports->ClassCreate   = reinterpret_cast<Functions::ClassCreateFunc>(GetProcAddress(hmodule, "ClassCreate"));
+        pExports->PluginDepends = reinterpret_cast<Functions::PluginDependsFunc>(GetProcAddress(hmodule, "PluginDepends"));
+        pExports->PluginCanUnload = reinterpret_cast<Functions::PluginCanUnloadFunc>(GetProcAddress(hmodule, "PluginCanUnload"));
+#pragma warning(pop)
+
+        if
+        (
+            pExports->PluginInit  == nullptr ||
+            pExports->PluginReset == nullptr ||
+            pExports->ClassCount  == nullptr ||
+            pExports->ClassInfo   == nullptr ||
+            pExports->ClassCreate == nullptr
+        )
+        {
+            FreeLibrary(hmodule);
+            ZeroMemory(pExports, sizeof(Exports));
+            return false;
+        }
+
+        pExports->Handle = hmodule;
+        return true;
+    }
+
+    VSPlugin * VSPlugin::Create(_In_ IPluginServer * pServer, _In_ CONST Exports & exports)
+    {
+        VSPlugin * module = new VSPlugin(pServer, exports.Handle);
+
+        module->m_Desc          = exports.Desc;
+        module->m_PluginInit    = exports.PluginInit;
+        module->m_PluginReset   = exports.PluginReset;
+        module->m_ClassCount    = exports.ClassCount;
+        module->m_ClassInfo     = exports.ClassInfo;
+        module->m_ClassCreate   = exports.ClassCreate;
+        module->m_PluginDepends = exports.PluginDepends;
+        module->m_PluginCanUnload = exports.PluginCanUnload;
+
+        return module;
+    }
+
+    VSPlugin * VSPlugin::Load(_In_ IPluginServer * pServer, _In_ CONST String & path)
+    {
+        Exports exports;
+        if (VSPlugin::Resolve(path, &exports))
+        {
+            return VSPlugin::Create(pServer, exports);
         }
         else
         {
@@ -69,7 +122,9 @@ namespace VoodooShader
     }
 
     VOODOO_METHODTYPE VSPlugin::VSPlugin(_In_ IPluginServer * pServer, _In_ HMODULE hmodule) :
-        m_Refs(0), m_Server(pServer), m_Handle(hmodule)
+        m_Refs(0), m_Server(pServer), m_Handle(hmodule), m_Desc(nullptr), m_PluginInit(nullptr), m_PluginReset(nullptr), m_ClassCount(nullptr),
+        m_ClassInfo(nullptr), m_ClassCreate(nullptr), m_PluginDepends(nullptr),
+        m_PluginCanUnload(nullptr)
     {
         AddThisToDebugCache();
     }
@@ -108,33 +163,16 @@ namespace VoodooShader
     {
         //VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
-        if (!ppOut)
+        static CONST InterfaceMapEntry map[] =
         {
-            return VSFERR_INVALIDPARAMS;
-        }
-        else
-        {
-            if (refid == IID_IObject)
-            {
-                *ppOut = static_cast<IObject*>(this);
-            }
-            else if (refid == IID_IPlugin)
-            {
-                *ppOut = static_cast<IPlugin*>(this);
-            }
-            else if (refid == CLSID_VSPlugin)
-            {
-                *ppOut = static_cast<VSPlugin*>(this);
-            }
-            else
-            {
-                *ppOut = nullptr;
-                return VSFERR_INVALIDUUID;
-            }
+            VOODOO_INTERFACE_ENTRY(VSPlugin, IObject),
+            VOODOO_INTERFACE_ENTRY(VSPlugin, IPlugin),
+            VOODOO_CLASS_ENTRY(VSPlugin),
+            VOODOO_INTERFACE_MAP_END
+        };
+        static volatile LONG hint = 0;
 
-            (*ppOut)->AddRef();
-            return VSF_OK;
-        }
+        return QueryInterfaceMap(this, map, &hint, refid, ppOut);
     }
 
     String VOODOO_METHODTYPE VSPlugin::ToString() CONST
@@ -162,13 +200,21 @@ namespace VoodooShader
     {
         //VOODOO_DEBUG_FUNCLOG(m_Server->)
 
-        return m_PluginReset(pCore);
+        if (m_PluginReset)
+        {
+            m_PluginReset(pCore);
+        }
     }
 
     uint32_t VOODOO_METHODTYPE VSPlugin::ClassCount() CONST
     {
         //VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
+        if (m_Desc)
+        {
+            return m_Desc->ClassCount;
+        }
+
         return m_ClassCount();
     }
 
@@ -176,6 +222,24 @@ namespace VoodooShader
     {
         //VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
+        if (m_Desc)
+        {
+            if (number >= m_Desc->ClassCount)
+            {
+                if (pUuid)
+                {
+                    *pUuid = NilUuid;
+                }
+                return nullptr;
+            }
+
+            if (pUuid)
+            {
+                *pUuid = m_Desc->Classes[number].ClsId;
+            }
+            return m_Desc->Classes[number].Name;
+        }
+
         return m_ClassInfo(number, pUuid);
     }
 
@@ -185,4 +249,30 @@ namespace VoodooShader
 
         return m_ClassCreate(number, pCore);
     }
+
+    CONST wchar_t * CONST * VSPlugin::GetDependencies() CONST
+    {
+        if (m_Desc)
+        {
+            return m_Desc->Depends;
+        }
+        else if (m_PluginDepends)
+        {
+            return m_PluginDepends();
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    CONST PluginDesc * VSPlugin::GetDesc() CONST
+    {
+        return m_Desc;
+    }
+
+    bool VSPlugin::CanUnload() CONST
+    {
+        return (m_Refs == 1 && m_PluginCanUnload && m_PluginCanUnload());
+    }
 }
@@ -29,6 +29,30 @@ namespace VoodooShader
     VOODOO_CLASS(VSPlugin, IPlugin, ({0x9F, 0x12, 0xF3, 0xE6, 0xAF, 0x05, 0xE1, 0x11, 0x9E, 0x05, 0x00, 0x50, 0x56, 0xC0, 0x00, 0x08}))
     {
     public:
+        /**
+         * Module handle and entry points, resolved without creating a plugin object. Modules exporting a descriptor have
+         * it set, along with the entry points it gives; ClassCount, ClassInfo and PluginDepends are then unused.
+         */
+        struct Exports
+        {
+            HMODULE Handle;
+            CONST PluginDesc * Desc;
+            Functions::PluginInitFunc PluginInit;
+            Functions::PluginResetFunc PluginReset;
+            Functions::ClassCountFunc ClassCount;
+            Functions::ClassInfoFunc ClassInfo;
+            Functions::ClassCreateFunc ClassCreate;
+            Functions::PluginDependsFunc PluginDepends;
+            Functions::PluginCanUnloadFunc PluginCanUnload;
+        };
+
+        /**
+         * Maps a module and resolves its exports. This does not touch any Voodoo objects and is safe to call from worker
+         * threads. The @p PluginDesc export is used if present and valid, otherwise the separate entry points are
+         * resolved. The module is freed if any required export is missing.
+         */
+        static bool Resolve(_In_ CONST String & path, _Out_ Exports * pExports);
+        static VSPlugin * Create(_In_ IPluginServer * pServer, _In_ CONST Exports & exports);
         static VSPlugin * Load(_In_ IPluginServer * pServer, _In_ CONST String & path);
 
         VSPlugin(_In_ IPluginServer * pServer, _In_ HMODULE hmodule);
@@ -45,6 +69,22 @@ namespace VoodooShader
         VOODOO_METHOD_(CONST wchar_t *, ClassInfo)(_In_ CONST uint32_t number, _Out_ Uuid * pUuid) CONST;
         VOODOO_METHOD_(IObject *, CreateClass)(_In_ CONST uint32_t number, _In_ ICore * pCore) CONST;
 
+        /**
+         * Retrieves the names of the modules this plugin must be initialized after, if the plugin declares any.
+         *
+         * @return A null-terminated list of module names, or nullptr.
+         */
+        CONST wchar_t * CONST * GetDependencies() CONST;
+        /**
+         * Retrieves the plugin's descriptor, if it exports one.
+         */
+        CONST PluginDesc * GetDesc() CONST;
+        /**
+         * Tests if the module can be freed: no references are held besides the caller's one and the plugin reports that
+         * it has no live objects. Plugins that do not export @p PluginCanUnload are never freed early.
+         */
+        bool CanUnload() CONST;
+
     private:
         // Private these to prevent copying internally (external libs never will).
         VSPlugin(CONST VSPlugin & other);
@@ -55,10 +95,13 @@ namespace VoodooShader
         IPluginServer * m_Server;
 
         HMODULE m_Handle;
+        CONST PluginDesc * m_Desc;
         Functions::PluginInitFunc m_PluginInit;
         Functions::PluginResetFunc m_PluginReset;
         Functions::ClassCountFunc m_ClassCount;
         Functions::ClassInfoFunc m_ClassInfo;
         Functions::ClassCreateFunc m_ClassCreate;
+        Functions::PluginDependsFunc m_PluginDepends;
+        Functions::PluginCanUnloadFunc m_PluginCanUnload;
     };
 }
@@ -0,0 +1,236 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+#include "VSPluginManifest.hpp"
+// System
+#pragma warning(push,3)
+#include <fstream>
+#include <iterator>
+#pragma warning(pop)
+
+namespace VoodooShader
+{
+    static bool SliceIs(_In_ CONST VSONSlice & slice, _In_z_ CONST char * str)
+    {
+        size_t length = strlen(str);
+        return (slice.Length == length && memcmp(slice.Data, str, length) == 0);
+    }
+
+    VSPluginManifest::VSPluginManifest(_In_ CONST String & path) :
+        m_Path(path), m_Dirty(false)
+    { }
+
+    VSPluginManifest::~VSPluginManifest()
+    { }
+
+    bool VSPluginManifest::Load()
+    {
+        m_Entries.clear();
+        m_Dirty = false;
+
+        std::ifstream file(m_Path.GetData(), std::ios::in | std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::vector<char> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+
+        VSONReader reader(buffer.empty() ? nullptr : &buffer[0], (uint32_t)buffer.size());
+
+        PluginManifestEntry entry;
+        bool inModule = false, inClass = false;
+        String value;
+
+        for (;;)
+        {
+            VSONToken token = reader.Next();
+            if (token == VSON_End)
+            {
+                return true;
+            }
+            else if (token == VSON_Error)
+            {
+                m_Entries.clear();
+                return false;
+            }
+            else if (token == VSON_BeginObject)
+            {
+                if (!inModule && SliceIs(reader.GetType(), "Module"))
+                {
+                    entry = PluginManifestEntry();
+                    reader.GetName(&entry.Path);
+                    inModule = true;
+                }
+                else if (inModule && !inClass && SliceIs(reader.GetType(), "Class"))
+                {
+                    Uuid clsid;
+                    ZeroMemory(&clsid, sizeof(Uuid));
+
+                    reader.GetName(&value);
+                    entry.Classes.push_back(std::make_pair(clsid, value));
+                    inClass = true;
+                }
+                else
+                {
+                    reader.Skip();
+                }
+            }
+            else if (token == VSON_EndObject)
+            {
+                if (inClass)
+                {
+                    inClass = false;
+                }
+                else if (inModule)
+                {
+                    m_Entries[entry.Path] = entry;
+                    inModule = false;
+                }
+            }
+            else if (token == VSON_Property && inModule)
+            {
+                VSONSlice name = reader.GetName();
+                reader.GetString(&value);
+
+                if (inClass)
+                {
+                    if (SliceIs(name, "ClsId"))
+                    {
+                        value.ToUuid(&entry.Classes.back().first);
+                    }
+                }
+                else if (SliceIs(name, "Name"))
+                {
+                    entry.Name = value;
+                }
+                else if (SliceIs(name, "LibId"))
+                {
+                    value.ToUuid(&entry.LibId);
+                }
+                else if (SliceIs(name, "Time"))
+                {
+                    entry.Time = _wcstoui64(value.GetData(), nullptr, 10);
+                }
+                else if (SliceIs(name, "Size"))
+                {
+                    entry.Size = _wcstoui64(value.GetData(), nullptr, 10);
+                }
+                else if (SliceIs(name, "Depends"))
+                {
+                    entry.Depends.push_back(value);
+                }
+            }
+        }
+    }
+
+    bool VSPluginManifest::Save()
+    {
+        if (!m_Dirty)
+        {
+            return true;
+        }
+
+        VSONWriter writer;
+
+        std::map<String, PluginManifestEntry>::const_iterator iter = m_Entries.begin();
+        while (iter != m_Entries.end())
+        {
+            CONST PluginManifestEntry & entry = iter->second;
+
+            writer.BeginObject(VSTR("Module"), entry.Path);
+            writer.WriteProperty(VSTR("Name"), entry.Name);
+            writer.WriteProperty(VSTR("LibId"), String(entry.LibId));
+            writer.WriteProperty(VSTR("Time"), (StringFormat(VSTR("%1%")) << (unsigned long long)entry.Time).ToString());
+            writer.WriteProperty(VSTR("Size"), (StringFormat(VSTR("%1%")) << (unsigned long long)entry.Size).ToString());
+
+            StringList::const_iterator depend = entry.Depends.begin();
+            while (depend != entry.Depends.end())
+            {
+                writer.WriteProperty(VSTR("Depends"), *depend);
+                ++depend;
+            }
+
+            PluginClassList::const_iterator classIter = entry.Classes.begin();
+            while (classIter != entry.Classes.end())
+            {
+                writer.BeginObject(VSTR("Class"), classIter->second);
+                writer.WriteProperty(VSTR("ClsId"), String(classIter->first));
+                writer.EndObject();
+                ++classIter;
+            }
+
+            writer.EndObject();
+            ++iter;
+        }
+
+        std::ofstream file(m_Path.GetData(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        file.write(writer.GetData(), writer.GetLength());
+        file.close();
+
+        m_Dirty = false;
+        return true;
+    }
+
+    CONST PluginManifestEntry * VSPluginManifest::Find(_In_ CONST String & path) CONST
+    {
+        std::map<String, PluginManifestEntry>::const_iterator iter = m_Entries.find(path);
+        if (iter == m_Entries.end())
+        {
+            return nullptr;
+        }
+
+        uint64_t time = 0, size = 0;
+        if (!VSPluginManifest::GetFileStamp(path, &time, &size) || time != iter->second.Time || size != iter->second.Size)
+        {
+            return nullptr;
+        }
+
+        return &iter->second;
+    }
+
+    void VSPluginManifest::Update(_In_ CONST PluginManifestEntry & entry)
+    {
+        m_Entries[entry.Path] = entry;
+        m_Dirty = true;
+    }
+
+    bool VSPluginManifest::GetFileStamp(_In_ CONST String & path, _Out_ uint64_t * pTime, _Out_ uint64_t * pSize)
+    {
+        *pTime = 0;
+        *pSize = 0;
+
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesEx(path.GetData(), GetFileExInfoStandard, &data))
+        {
+            return false;
+        }
+
+        *pTime = ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+        *pSize = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+        return true;
+    }
+}
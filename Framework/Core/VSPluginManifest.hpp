@@ -0,0 +1,86 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooInternal.hpp"
+
+namespace VoodooShader
+{
+    typedef std::vector<std::pair<Uuid, String> > PluginClassList;
+
+    /**
+     * A module's entry in the plugin manifest, recorded the last time the module was loaded.
+     */
+    struct PluginManifestEntry
+    {
+        String          Path;
+        uint64_t        Time;       /* !< Last write time of the module, as a FILETIME. */
+        uint64_t        Size;
+        String          Name;       /* !< Module name, as reported by PluginInit. */
+        Uuid            LibId;
+        StringList      Depends;    /* !< Modules named by PluginDepends. */
+        PluginClassList Classes;    /* !< Class ids and names, in ClassInfo order. */
+    };
+
+    /**
+     * Cache of the classes provided by each module, so modules can be loaded the first time one of their classes is
+     * created rather than at startup. Entries are keyed by full path and are only used while the module's write time and
+     * size are unchanged. The manifest is stored as a VSON document.
+     */
+    class VSPluginManifest
+    {
+    public:
+        VSPluginManifest(_In_ CONST String & path);
+        ~VSPluginManifest();
+
+        /**
+         * Reads the manifest file. A missing or malformed file leaves the manifest empty.
+         *
+         * @return True if the file was read.
+         */
+        bool Load();
+        /**
+         * Writes the manifest file, if any entries have changed since it was read or last written.
+         */
+        bool Save();
+
+        /**
+         * Finds the entry for a module, if the module has not changed since it was recorded.
+         */
+        CONST PluginManifestEntry * Find(_In_ CONST String & path) CONST;
+        /**
+         * Records a module, replacing any existing entry for the same path.
+         */
+        void Update(_In_ CONST PluginManifestEntry & entry);
+
+        /**
+         * Retrieves the write time and size of a file, without opening it.
+         */
+        static bool GetFileStamp(_In_ CONST String & path, _Out_ uint64_t * pTime, _Out_ uint64_t * pSize);
+
+    private:
+        VSPluginManifest(CONST VSPluginManifest & other);
+        VSPluginManifest & operator=(CONST VSPluginManifest & other);
+
+        String m_Path;
+        std::map<String, PluginManifestEntry> m_Entries;
+        bool m_Dirty;
+    };
+}
@@ -21,9 +21,12 @@
 #include "VSPluginServer.hpp"
 // Voodoo Core
 #include "VSPlugin.hpp"
+#include "VSProfiler.hpp"
 // System
 #pragma warning(push,3)
 #include <shlwapi.h>
+#include <algorithm>
+#include <vector>
 #pragma warning(pop)
 
 namespace VoodooShader
@@ -31,6 +34,143 @@ namespace VoodooShader
     #define VOODOO_DEBUG_TYPE VSPluginServer
     DeclareDebugCache();
 
+    struct PluginLoadBatch
+    {
+        std::vector<PluginLoadTask> * pTasks;
+        volatile LONG Next;
+    };
+
+    static void MapPlugins(_Inout_ PluginLoadBatch * pBatch)
+    {
+        LONG count = static_cast<LONG>(pBatch->pTasks->size());
+        LONG index = InterlockedIncrement(&pBatch->Next) - 1;
+
+        while (index < count)
+        {
+            PluginLoadTask & task = (*pBatch->pTasks)[index];
+
+            VOODOO_PROFILE_SCOPE(VSTR("Map module"), task.Path.GetData());
+            task.Mapped = VSPlugin::Resolve(task.MapPath, &task.Exports);
+
+            index = InterlockedIncrement(&pBatch->Next) - 1;
+        }
+    }
+
+    static DWORD WINAPI MapPluginsThread(_In_ LPVOID pParam)
+    {
+        MapPlugins(reinterpret_cast<PluginLoadBatch*>(pParam));
+        return 0;
+    }
+
+    /**
+     * Appends the modules in a directory matching the filter, sorted by name.
+     *
+     * @return ERROR_SUCCESS, or the error from searching the directory.
+     */
+    static DWORD FindModules(_In_ CONST String & root, _In_ CONST String & filter, _Inout_ std::vector<String> * pFiles)
+    {
+        String mask = root + VSTR("\\*");
+
+        WIN32_FIND_DATA findFile;
+        HANDLE searchHandle = FindFirstFile(mask.GetData(), &findFile);
+
+        if (searchHandle == INVALID_HANDLE_VALUE)
+        {
+            return GetLastError();
+        }
+
+        Regex compfilter;
+        if (filter.IsEmpty())
+        {
+            compfilter.SetExpr(VSTR(".*\\.dll"));
+        }
+        else
+        {
+            compfilter.SetExpr(filter);
+        }
+
+        size_t first = pFiles->size();
+        do
+        {
+            if ((findFile.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+            {
+                String module = findFile.cFileName;
+
+                if (!compfilter.Match(module).IsEmpty())
+                {
+                    pFiles->push_back(root + VSTR("\\") + module);
+                }
+            }
+        } while (FindNextFile(searchHandle, &findFile) != 0);
+
+        FindClose(searchHandle);
+
+        // The search order depends on the file system, sort so modules are always registered in the same order
+        std::sort(pFiles->begin() + first, pFiles->end());
+
+        return ERROR_SUCCESS;
+    }
+
+    static String GetModuleName(_In_ CONST String & fullname)
+    {
+        String module = PathFindFileName(fullname.GetData());
+
+        uint32_t ext = module.ReverseFind(L'.');
+        if (ext != String::Npos)
+        {
+            module = module.Left(ext);
+        }
+
+        return module;
+    }
+
+    /**
+     * Copies a module next to the original, so the original can be replaced while the copy is in use.
+     *
+     * @param pShadow Receives the path to map, which is the original if the process has already mapped it.
+     * @return False if no copy could be made.
+     */
+    static bool CopyShadowFile(_In_ CONST String & fullname, _Inout_ volatile LONG * pCount, _Out_ String * pShadow)
+    {
+        // Modules the process has already mapped, such as the core, cannot be replaced and are used in place
+        if (GetModuleHandle(fullname.GetData()))
+        {
+            *pShadow = fullname;
+            return true;
+        }
+
+        // Copies are made next to the original, so dependencies are found in the same directory. A copy may still be
+        // held by another process using the same plugins, so try a few names.
+        for (uint32_t attempt = 0; attempt < 8; ++attempt)
+        {
+            String shadow = (StringFormat(VSTR("%1%.%2%.shadow")) << fullname << (InterlockedIncrement(pCount) - 1)).ToString();
+            if (CopyFile(fullname.GetData(), shadow.GetData(), FALSE))
+            {
+                *pShadow = shadow;
+                return true;
+            }
+        }
+
+        *pShadow = fullname;
+        return false;
+    }
+
+    /**
+     * Releases a task's mapping and any copy made for it.
+     */
+    static void ReleaseTask(_In_ CONST PluginLoadTask & task)
+    {
+        if (task.Mapped && task.Exports.Handle)
+        {
+            FreeLibrary(task.Exports.Handle);
+        }
+
+        if (task.MapPath != task.Path)
+        {
+            DeleteFile(task.MapPath.GetData());
+        }
+    }
+
     _Check_return_ IPluginServer * VOODOO_CALLTYPE CreateServer()
     {
         static VSPluginServer * pServer = nullptr;
@@ -52,7 +192,7 @@ namespace VoodooShader
     }
 
     VSPluginServer::VSPluginServer() :
-        m_Refs(0)
+        m_Refs(0), m_Manifest(nullptr), m_ShadowCount(0), m_LastCheck(0)
     {
         m_Parser = CreateParser();
         m_Logger = CreateLogger();
@@ -67,8 +207,39 @@ namespace VoodooShader
         m_Parser = nullptr;
         m_Logger = nullptr;
 
-        m_Classes.clear();
+        if (m_Manifest)
+        {
+            m_Manifest->Save();
+            delete m_Manifest;
+            m_Manifest = nullptr;
+        }
+
+        StringList shadows;
+        PluginShadowMap::const_iterator shadowIter = m_Shadows.begin();
+        while (shadowIter != m_Shadows.end())
+        {
+            shadows.push_back(shadowIter->second.Shadow);
+            ++shadowIter;
+        }
+
+        RetiredPluginList::const_iterator retiredIter = m_Retired.begin();
+        while (retiredIter != m_Retired.end())
+        {
+            shadows.push_back(retiredIter->Shadow);
+            ++retiredIter;
+        }
+
+        m_Registry.Clear();
         m_Plugins.clear();
+        m_Retired.clear();
+
+        // Copies of modules that are still held elsewhere cannot be removed, they are overwritten by later runs
+        StringList::const_iterator fileIter = shadows.begin();
+        while (fileIter != shadows.end())
+        {
+            DeleteFile(fileIter->GetData());
+            ++fileIter;
+        }
     }
 
     uint32_t VOODOO_METHODTYPE VSPluginServer::AddRef() CONST
@@ -94,33 +265,16 @@ namespace VoodooShader
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
 
-        if (!ppOut)
-        {
-            return VSFERR_INVALIDPARAMS;
-        }
-        else
+        static CONST InterfaceMapEntry map[] =
         {
-            if (refid == IID_IObject)
-            {
-                *ppOut = static_cast<IObject*>(this);
-            }
-            else if (refid == IID_IPluginServer)
-            {
-                *ppOut = static_cast<IPluginServer*>(this);
-            }
-            else if (refid == CLSID_VSPluginServer)
-            {
-                *ppOut = static_cast<VSPluginServer*>(this);
-            }
-            else
-            {
-                *ppOut = nullptr;
-                return VSFERR_INVALIDUUID;
-            }
-
-            (*ppOut)->AddRef();
-            return VSF_OK;
-        }
+            VOODOO_INTERFACE_ENTRY(VSPluginServer, IObject),
+            VOODOO_INTERFACE_ENTRY(VSPluginServer, IPluginServer),
+            VOODOO_CLASS_ENTRY(VSPluginServer),
+            VOODOO_INTERFACE_MAP_END
+        };
+        static volatile LONG hint = 0;
+
+        return QueryInterfaceMap(this, map, &hint, refid, ppOut);
     }
 
     String VOODOO_METHODTYPE VSPluginServer::ToString() CONST
@@ -187,80 +341,65 @@ namespace VoodooShader
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
 
-        String mask = m_Parser->Parse(path) + VSTR("\\*");
+        String root = m_Parser->Parse(path);
 
-        WIN32_FIND_DATA findFile;
-        HANDLE searchHandle = FindFirstFile(mask.GetData(), &findFile);
+        std::vector<String> files;
+        DWORD error = FindModules(root, filter, &files);
 
-        if (searchHandle == INVALID_HANDLE_VALUE)
+        if (error == ERROR_FILE_NOT_FOUND)
         {
-            DWORD error = GetLastError();
-
-            if (error == ERROR_FILE_NOT_FOUND)
-            {
-                m_Logger->LogMessage
-                (
-                    VSLog_CoreWarning, VOODOO_CORE_NAME,
-                    StringFormat("No plugins found in directory '%1%'.") << path
-                );
-
-                return VSFERR_FILENOTFOUND;
-            }
-            else
-            {
-                m_Logger->LogMessage 
-                ( 
-                    VSLog_CoreWarning, VOODOO_CORE_NAME,  
-                    StringFormat("Error searching directory '%1%'.") << path 
-                ); 
-                 
-                return VSF_FAIL; 
-            }
-        }
+            m_Logger->LogMessage
+            (
+                VSLog_CoreWarning, VOODOO_CORE_NAME,
+                StringFormat("No plugins found in directory '%1%'.") << path
+            );
 
-        Regex compfilter;
-        if (filter.IsEmpty())
-        {
-            compfilter.SetExpr(VSTR(".*\\.dll"));
+            return VSFERR_FILENOTFOUND;
         }
-        else
+        else if (error != ERROR_SUCCESS)
         {
-            compfilter.SetExpr(filter);
+            m_Logger->LogMessage 
+            ( 
+                VSLog_CoreWarning, VOODOO_CORE_NAME,  
+                StringFormat("Error searching directory '%1%'.") << path 
+            ); 
+             
+            return VSF_FAIL; 
         }
 
-        do
+        if (files.empty())
         {
-            String module = findFile.cFileName;
-
-            this->LoadPlugin(pCore, module);
-        } while (FindNextFile(searchHandle, &findFile) != 0);
+            return VSF_OK;
+        }
 
-        return VSF_OK;
+        return this->LoadPlugins(pCore, static_cast<uint32_t>(files.size()), &files[0]);
     }
 
     VoodooResult VOODOO_METHODTYPE VSPluginServer::LoadPlugin(_In_ ICore * pCore, _In_ CONST String & filename)
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
 
-        String fullname = m_Parser->Parse(filename, VSParse_PathCanon);
-
-        // Check for relative
-        if (PathIsRelative(fullname.GetData()))
-        {
-            fullname = m_Parser->Parse(String(VSTR("$(path)\\")) + fullname, VSParse_PathCanon);
-        }
+        String fullname = this->GetFullPath(filename);
 
         // Check for already loaded
-        if (m_PluginNames.find(fullname) != m_PluginNames.end())
+        if (m_PluginPaths.find(fullname) != m_PluginPaths.end())
         {
             return VSF_OK;
         }
 
+        String mapPath = (this->IsReloadEnabled(pCore)) ? this->CopyShadow(fullname) : fullname;
+
         // Create struct and load functions
-        PluginRef module = VSPlugin::Load(this, fullname);
+        VSPlugin * module = nullptr;
+        {
+            VOODOO_PROFILE_SCOPE(VSTR("Map module"), fullname.GetData());
+            module = VSPlugin::Load(this, mapPath);
+        }
 
         if (module == nullptr)
         {
+            this->TrackShadow(fullname, mapPath, false);
+
             if (m_Logger)
             {
                 m_Logger->LogMessage
@@ -273,158 +412,1051 @@ namespace VoodooShader
             return VSFERR_INVALIDPARAMS;
         }
 
-        // Register classes from module
-        const Version * moduleversion = module->PluginInit(pCore);
+        VoodooResult result = this->InitPlugin(pCore, fullname, module);
+        this->TrackShadow(fullname, mapPath, SUCCEEDED(result));
+        m_Registry.Freeze();
 
-        if (!moduleversion)
+        return result;
+    }
+
+    VoodooResult VOODOO_METHODTYPE VSPluginServer::LoadPlugins(_In_ ICore * pCore, _In_ CONST uint32_t count, _In_reads_(count) CONST String * pNames)
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        if (count > 0 && !pNames)
         {
-            if (m_Logger)
-            {
-                m_Logger->LogMessage(VSLog_CoreError, VOODOO_CORE_NAME, 
-                    StringFormat("Null version returned by module '%1%'.") << fullname);
-            }
             return VSFERR_INVALIDPARAMS;
         }
 
-        m_Plugins[moduleversion->LibId] = module;
-        m_PluginNames[moduleversion->Name] = moduleversion->LibId;
+        this->OpenManifest(pCore);
+        bool reload = this->IsReloadEnabled(pCore);
 
-        if (moduleversion->Debug != VOODOO_DEBUG_BOOL && m_Logger)
-        {
-            m_Logger->LogMessage
-            (
-                VSLog_CoreWarning, VOODOO_CORE_NAME,
-                StringFormat("Debug build mismatch with module '%1%'.") << moduleversion->Name
-            );
-        }
+        // Resolve paths, skipping modules that are already loaded or given twice
+        std::vector<PluginLoadTask> tasks;
+        tasks.reserve(count);
 
-        if (m_Logger)
+        for (uint32_t index = 0; index < count; ++index)
         {
-            m_Logger->LogMessage(VSLog_CoreNotice, VOODOO_CORE_NAME, 
-                StringFormat("Loaded module: %1%") << moduleversion->Name);
-        }
+            String fullname = this->GetFullPath(pNames[index]);
 
-        uint32_t classCount = module->ClassCount();
+            if (m_PluginPaths.find(fullname) != m_PluginPaths.end())
+            {
+                continue;
+            }
 
-        for (uint32_t curClass = 0; curClass < classCount; ++curClass)
-        {
-            Uuid clsid;
-            ZeroMemory(&clsid, sizeof(Uuid));
+            bool duplicate = false;
+            std::vector<PluginLoadTask>::const_iterator taskIter = tasks.begin();
+            while (taskIter != tasks.end() && !duplicate)
+            {
+                duplicate = (taskIter->Path == fullname);
+                ++taskIter;
+            }
 
-            const wchar_t * classname = module->ClassInfo(curClass, &clsid);
+            if (duplicate)
+            {
+                continue;
+            }
 
-            if (classname)
+            // Modules with unchanged manifest entries are not loaded until one of their classes is created. Modules
+            // without classes are always loaded, since their init is the only reason to list them.
+            if (m_Manifest)
             {
-                m_Classes.insert(std::pair<Uuid, ClassSource>(clsid, ClassSource(module, curClass)));
-                m_ClassNames.insert(std::pair<String, Uuid>(classname, clsid));
+                CONST PluginManifestEntry * pEntry = m_Manifest->Find(fullname);
+                if (pEntry && !pEntry->Classes.empty())
+                {
+                    this->RegisterLazy(*pEntry);
+                    continue;
+                }
             }
+
+            PluginLoadTask task;
+            task.Path = fullname;
+            task.MapPath = (reload) ? this->CopyShadow(fullname) : fullname;
+            task.Module = GetModuleName(fullname);
+            task.Mapped = false;
+            ZeroMemory(&task.Exports, sizeof(VSPlugin::Exports));
+
+            tasks.push_back(task);
         }
 
-        return VSF_OK;
-    }
+        if (tasks.empty())
+        {
+            m_Registry.Freeze();
+            return VSF_OK;
+        }
 
+        MapTasks(tasks, this->GetThreadCount(pCore));
 
-    VoodooResult VOODOO_METHODTYPE VSPluginServer::LoadPlugin(_In_ ICore * pCore, _In_ IFile * pFile)
-    {
-        VOODOO_DEBUG_FUNCLOG(m_Logger);
+        return this->InitTasks(pCore, tasks);
+    }
 
-        if (pFile)
+    void VSPluginServer::PrepareSet(_In_ ICore * pCore, _In_ CONST StringPairList & paths, _In_ CONST StringList & files, _Out_ PluginMapSet * pSet)
+    {
+        pSet->Paths.clear();
+        pSet->Files.clear();
+        pSet->Missing.clear();
+        pSet->Tasks.clear();
+        pSet->Shadow = this->IsReloadEnabled(pCore);
+        pSet->pShadowCount = &m_ShadowCount;
+
+        StringPairList::const_iterator pathIter = paths.begin();
+        while (pathIter != paths.end())
         {
-            return this->LoadPlugin(pCore, pFile->GetPath());
+            pSet->Paths.push_back(StringPair(m_Parser->Parse(pathIter->first), pathIter->second));
+            ++pathIter;
         }
-        else
+
+        StringList::const_iterator fileIter = files.begin();
+        while (fileIter != files.end())
         {
-            return VSFERR_INVALIDPARAMS;
+            pSet->Files.push_back(this->GetFullPath(*fileIter));
+            ++fileIter;
         }
     }
 
-    VoodooResult VOODOO_METHODTYPE VSPluginServer::UnloadPlugin(_In_ ICore * pCore, _In_ CONST String & name)
+    void VSPluginServer::MapSet(_Inout_ PluginMapSet * pSet)
     {
-        StrongNameMap::iterator module = m_PluginNames.find(name);
-        if (module != m_PluginNames.end())
+        std::vector<String> files(pSet->Files.begin(), pSet->Files.end());
+
+        StringPairList::const_iterator pathIter = pSet->Paths.begin();
+        while (pathIter != pSet->Paths.end())
         {
-            VoodooResult result = this->UnloadPlugin(pCore, module->second);
-            if (SUCCEEDED(result))
+            if (FindModules(pathIter->first, pathIter->second, &files) != ERROR_SUCCESS)
             {
-                m_PluginNames.erase(module);
+                pSet->Missing.push_back(pathIter->first);
             }
-            return result;
-        }
-        else
-        {
-            return VSFERR_INVALIDPARAMS;
+            ++pathIter;
         }
-    }
 
-    VoodooResult VOODOO_METHODTYPE VSPluginServer::UnloadPlugin(_In_ ICore * pCore, _In_ CONST Uuid libid)
-    {
-        StrongPluginMap::iterator module = m_Plugins.find(libid);
-        if (module != m_Plugins.end())
+        std::vector<String>::const_iterator fileIter = files.begin();
+        while (fileIter != files.end())
         {
-            PluginRef plugin = module->second;
-            plugin->PluginReset(pCore);
+            bool duplicate = false;
+            std::vector<PluginLoadTask>::const_iterator taskIter = pSet->Tasks.begin();
+            while (taskIter != pSet->Tasks.end() && !duplicate)
+            {
+                duplicate = (taskIter->Path == *fileIter);
+                ++taskIter;
+            }
 
-            for (StrongNameMap::iterator iter = m_PluginNames.begin(); iter != m_PluginNames.end(); ++iter)
+            if (!duplicate)
             {
-                if (iter->second == libid)
+                PluginLoadTask task;
+                task.Path = *fileIter;
+                task.MapPath = *fileIter;
+                task.Module = GetModuleName(*fileIter);
+                task.Mapped = false;
+                ZeroMemory(&task.Exports, sizeof(VSPlugin::Exports));
+
+                if (pSet->Shadow)
                 {
-                    m_PluginNames.erase(iter++);
-                }
-                else
-                {
-                    ++iter;
+                    CopyShadowFile(*fileIter, pSet->pShadowCount, &task.MapPath);
                 }
-            }
 
-            m_Plugins.erase(module);
-            plugin.reset();
+                pSet->Tasks.push_back(task);
+            }
 
-            return VSF_OK;
-        }
-        else
-        {
-            return VSFERR_INVALIDPARAMS;
+            ++fileIter;
         }
+
+        // This already runs away from the core, so one thread maps the whole set
+        MapTasks(pSet->Tasks, 1);
     }
 
-    bool VOODOO_METHODTYPE VSPluginServer::ClassExists(_In_ CONST Uuid clsid) CONST
+    VoodooResult VSPluginServer::RegisterSet(_In_ ICore * pCore, _Inout_ PluginMapSet * pSet)
     {
-        VOODOO_DEBUG_FUNCLOG(m_Logger);
+        StringList::const_iterator missingIter = pSet->Missing.begin();
+        while (missingIter != pSet->Missing.end())
+        {
+            m_Logger->LogMessage
+            (
+                VSLog_CoreWarning, VOODOO_CORE_NAME,
+                StringFormat("Error searching directory '%1%'.") << *missingIter
+            );
+            ++missingIter;
+        }
 
-        return (m_Classes.find(clsid) != m_Classes.end());
-    }
+        this->OpenManifest(pCore);
 
-    bool VOODOO_METHODTYPE VSPluginServer::ClassExists(_In_ CONST String & name) CONST
-    {
-        VOODOO_DEBUG_FUNCLOG(m_Logger);
+        // Modules loaded while the set was being mapped were only mapped again, which is released
+        std::vector<PluginLoadTask> tasks;
+        tasks.reserve(pSet->Tasks.size());
 
-        Uuid clsid;
-        if (!name.ToUuid(&clsid))
+        std::vector<PluginLoadTask>::const_iterator taskIter = pSet->Tasks.begin();
+        while (taskIter != pSet->Tasks.end())
         {
-            StrongNameMap::const_iterator classiter = m_ClassNames.find(name);
-            if (classiter != m_ClassNames.end())
+            if (m_PluginPaths.find(taskIter->Path) != m_PluginPaths.end())
             {
-                clsid = classiter->second;
+                ReleaseTask(*taskIter);
             }
             else
             {
-                return false;
+                if (pSet->Shadow && taskIter->MapPath == taskIter->Path && !GetModuleHandle(taskIter->Path.GetData()))
+                {
+                    m_Logger->LogMessage
+                    (
+                        VSLog_CoreWarning, VOODOO_CORE_NAME,
+                        StringFormat("Unable to copy module '%1%' for reloading.") << taskIter->Path
+                    );
+                }
+
+                tasks.push_back(*taskIter);
             }
+            ++taskIter;
+        }
+        pSet->Tasks.clear();
+
+        if (tasks.empty())
+        {
+            m_Registry.Freeze();
+            return VSF_OK;
         }
 
-        return this->ClassExists(clsid);
+        return this->InitTasks(pCore, tasks);
     }
 
-    _Check_return_ IObject * VOODOO_METHODTYPE VSPluginServer::CreateObject(_In_ ICore * pCore, _In_ CONST Uuid clsid) CONST
+    void VSPluginServer::DropSet(_Inout_ PluginMapSet * pSet)
     {
-        VOODOO_DEBUG_FUNCLOG(m_Logger);
+        std::vector<PluginLoadTask>::const_iterator taskIter = pSet->Tasks.begin();
+        while (taskIter != pSet->Tasks.end())
+        {
+            ReleaseTask(*taskIter);
+            ++taskIter;
+        }
+
+        pSet->Tasks.clear();
+    }
+
+    void VSPluginServer::MapTasks(_Inout_ std::vector<PluginLoadTask> & tasks, _In_ CONST uint32_t threadCount)
+    {
+        // Map modules and resolve exports, the calling thread takes tasks along with the workers
+        PluginLoadBatch batch;
+        batch.pTasks = &tasks;
+        batch.Next = 0;
+
+        uint32_t threads = std::min<uint32_t>(threadCount, static_cast<uint32_t>(tasks.size()));
+        std::vector<HANDLE> workers;
+
+        for (uint32_t worker = 1; worker < threads; ++worker)
+        {
+            HANDLE workerThread = CreateThread(nullptr, 0, &MapPluginsThread, &batch, 0, nullptr);
+            if (workerThread)
+            {
+                workers.push_back(workerThread);
+            }
+        }
+
+        MapPlugins(&batch);
+
+        if (!workers.empty())
+        {
+            WaitForMultipleObjects(static_cast<DWORD>(workers.size()), &workers[0], TRUE, INFINITE);
+
+            std::vector<HANDLE>::iterator workerIter = workers.begin();
+            while (workerIter != workers.end())
+            {
+                CloseHandle(*workerIter);
+                ++workerIter;
+            }
+        }
+    }
+
+    VoodooResult VSPluginServer::InitTasks(_In_ ICore * pCore, _Inout_ std::vector<PluginLoadTask> & tasks)
+    {
+        // Find dependencies within the set
+        size_t taskCount = tasks.size();
+        std::vector< std::vector<size_t> > depends(taskCount);
+
+        for (size_t index = 0; index < taskCount; ++index)
+        {
+            CONST VSPlugin::Exports & exports = tasks[index].Exports;
+            if (!tasks[index].Mapped)
+            {
+                continue;
+            }
+
+            CONST wchar_t * CONST * names = nullptr;
+            if (exports.Desc)
+            {
+                names = exports.Desc->Depends;
+            }
+            else if (exports.PluginDepends)
+            {
+                names = exports.PluginDepends();
+            }
+
+            while (names && *names)
+            {
+                bool found = false;
+
+                for (size_t other = 0; other < taskCount; ++other)
+                {
+                    if (other != index && tasks[other].Mapped && tasks[other].Module.Compare(*names, false))
+                    {
+                        depends[index].push_back(other);
+                        found = true;
+                    }
+                }
+
+                if (!found && !this->IsLoaded(String(*names)))
+                {
+                    String lazyPath = this->FindLazyModule(*names);
+                    if (!lazyPath.IsEmpty())
+                    {
+                        this->LoadLazy(pCore, lazyPath);
+                        found = true;
+                    }
+                }
+
+                if (!found && !this->IsLoaded(String(*names)) && m_Logger)
+                {
+                    m_Logger->LogMessage
+                    (
+                        VSLog_CoreWarning, VOODOO_CORE_NAME,
+                        StringFormat("Module '%1%' depends on '%2%', which is not loaded.") << tasks[index].Path << *names
+                    );
+                }
+
+                ++names;
+            }
+        }
+
+        // Order modules, keeping the given order except where a module must wait for one of its dependencies
+        std::vector<size_t> order;
+        std::vector<bool> placed(taskCount, false);
+        order.reserve(taskCount);
+
+        while (order.size() < taskCount)
+        {
+            size_t next = taskCount;
+
+            for (size_t index = 0; index < taskCount && next == taskCount; ++index)
+            {
+                if (placed[index])
+                {
+                    continue;
+                }
+
+                bool ready = true;
+                std::vector<size_t>::const_iterator depIter = depends[index].begin();
+                while (depIter != depends[index].end() && ready)
+                {
+                    ready = placed[*depIter];
+                    ++depIter;
+                }
+
+                if (ready)
+                {
+                    next = index;
+                }
+            }
+
+            if (next == taskCount)
+            {
+                // Circular dependencies, initialize the remaining modules in the given order
+                for (size_t index = 0; index < taskCount; ++index)
+                {
+                    if (!placed[index])
+                    {
+                        if (m_Logger)
+                        {
+                            m_Logger->LogMessage
+                            (
+                                VSLog_CoreError, VOODOO_CORE_NAME,
+                                StringFormat("Circular dependency involving module '%1%'.") << tasks[index].Path
+                            );
+                        }
+
+                        order.push_back(index);
+                        placed[index] = true;
+                    }
+                }
+            }
+            else
+            {
+                order.push_back(next);
+                placed[next] = true;
+            }
+        }
+
+        // Initialize and register, on this thread and in order
+        VoodooResult result = VSF_OK;
+
+        std::vector<size_t>::const_iterator orderIter = order.begin();
+        while (orderIter != order.end())
+        {
+            PluginLoadTask & task = tasks[*orderIter];
+
+            if (task.Mapped)
+            {
+                VoodooResult initResult = this->InitPlugin(pCore, task.Path, VSPlugin::Create(this, task.Exports));
+                this->TrackShadow(task.Path, task.MapPath, SUCCEEDED(initResult));
+
+                if (FAILED(initResult))
+                {
+                    result = VSF_FAIL;
+                }
+            }
+            else
+            {
+                this->TrackShadow(task.Path, task.MapPath, false);
+
+                if (m_Logger)
+                {
+                    m_Logger->LogMessage
+                    (
+                        VSLog_CoreError, VOODOO_CORE_NAME, 
+                        StringFormat("Unable to load module '%1%'.") << task.Path
+                    );
+                }
+
+                result = VSF_FAIL;
+            }
+
+            ++orderIter;
+        }
+
+        if (m_Manifest)
+        {
+            m_Manifest->Save();
+        }
+
+        m_Registry.Freeze();
+
+        return result;
+    }
+
+    String VSPluginServer::GetFullPath(_In_ CONST String & filename) CONST
+    {
+        String fullname = m_Parser->Parse(filename, VSParse_PathCanon);
+
+        // Check for relative
+        if (PathIsRelative(fullname.GetData()))
+        {
+            fullname = m_Parser->Parse(String(VSTR("$(path)\\")) + fullname, VSParse_PathCanon);
+        }
+
+        return fullname;
+    }
+
+    uint32_t VSPluginServer::GetThreadCount(_In_ ICore * pCore) CONST
+    {
+        CONST ConfigDesc * pConfig = (pCore) ? pCore->GetConfigDesc() : nullptr;
+
+        if (!pConfig || pConfig->PluginThreads.IsEmpty())
+        {
+            return 1;
+        }
+
+        uint32_t threads = 1;
+        if (pConfig->PluginThreads.Compare(VSTR("auto"), false))
+        {
+            SYSTEM_INFO sysinfo;
+            GetSystemInfo(&sysinfo);
+            threads = sysinfo.dwNumberOfProcessors;
+        }
+        else
+        {
+            threads = wcstoul(pConfig->PluginThreads.GetData(), nullptr, 10);
+        }
+
+        return std::max<uint32_t>(1, std::min<uint32_t>(threads, MAXIMUM_WAIT_OBJECTS));
+    }
+
+    VoodooResult VSPluginServer::InitPlugin(_In_ ICore * pCore, _In_ CONST String & fullname, _In_ VSPlugin * pModule)
+    {
+        VOODOO_PROFILE_SCOPE(VSTR("Init module"), fullname.GetData());
+
+        PluginRef module = pModule;
+
+        // Register classes from module
+        const Version * moduleversion = module->PluginInit(pCore);
+
+        if (!moduleversion)
+        {
+            if (m_Logger)
+            {
+                m_Logger->LogMessage(VSLog_CoreError, VOODOO_CORE_NAME, 
+                    StringFormat("Null version returned by module '%1%'.") << fullname);
+            }
+            return VSFERR_INVALIDPARAMS;
+        }
+
+        m_Plugins[moduleversion->LibId] = module;
+        m_PluginNames[moduleversion->Name] = moduleversion->LibId;
+        m_PluginPaths[fullname] = moduleversion->LibId;
+
+        if (moduleversion->Debug != VOODOO_DEBUG_BOOL && m_Logger)
+        {
+            m_Logger->LogMessage
+            (
+                VSLog_CoreWarning, VOODOO_CORE_NAME,
+                StringFormat("Debug build mismatch with module '%1%'.") << moduleversion->Name
+            );
+        }
+
+        if (m_Logger)
+        {
+            m_Logger->LogMessage(VSLog_CoreNotice, VOODOO_CORE_NAME, 
+                StringFormat("Loaded module: %1%") << moduleversion->Name);
+        }
+
+        // The module is loaded now, so any classes listed for it in the manifest are replaced by its own
+        this->DropLazy(fullname);
+
+        PluginManifestEntry entry;
+        entry.Path = fullname;
+        entry.Name = moduleversion->Name;
+        entry.LibId = moduleversion->LibId;
+
+        CONST PluginDesc * pDesc = pModule->GetDesc();
+        if (pDesc)
+        {
+            // Classes are listed in the descriptor's static table, so they are registered without calling the module
+            CONST PluginClassDesc * pClass = pDesc->Classes;
+            for (uint32_t curClass = 0; curClass < pDesc->ClassCount; ++curClass, ++pClass)
+            {
+                if (pClass->Name)
+                {
+                    m_Registry.Add(pClass->ClsId, pClass->Name, module, curClass);
+                    entry.Classes.push_back(std::make_pair(pClass->ClsId, String(pClass->Name)));
+                }
+            }
+        }
+
+        uint32_t classCount = (pDesc) ? 0 : module->ClassCount();
+
+        for (uint32_t curClass = 0; curClass < classCount; ++curClass)
+        {
+            Uuid clsid;
+            ZeroMemory(&clsid, sizeof(Uuid));
+
+            const wchar_t * classname = module->ClassInfo(curClass, &clsid);
+
+            if (classname)
+            {
+                m_Registry.Add(clsid, classname, module, curClass);
+                entry.Classes.push_back(std::make_pair(clsid, String(classname)));
+            }
+        }
+
+        if (m_Manifest && VSPluginManifest::GetFileStamp(fullname, &entry.Time, &entry.Size))
+        {
+            CONST wchar_t * CONST * names = pModule->GetDependencies();
+            while (names && *names)
+            {
+                entry.Depends.push_back(*names);
+                ++names;
+            }
+
+            m_Manifest->Update(entry);
+        }
+
+        return VSF_OK;
+    }
+
+    void VSPluginServer::OpenManifest(_In_ ICore * pCore)
+    {
+        if (m_Manifest)
+        {
+            return;
+        }
+
+        CONST ConfigDesc * pConfig = (pCore) ? pCore->GetConfigDesc() : nullptr;
+        if (!pConfig || pConfig->PluginManifest.IsEmpty())
+        {
+            return;
+        }
+
+        m_Manifest = new VSPluginManifest(m_Parser->Parse(pConfig->PluginManifest, VSParse_PathCanon));
+        if (!m_Manifest->Load() && m_Logger)
+        {
+            m_Logger->LogMessage
+            (
+                VSLog_CoreInfo, VOODOO_CORE_NAME,
+                StringFormat("Plugin manifest '%1%' not found or invalid, all plugins will be loaded.") << pConfig->PluginManifest
+            );
+        }
+    }
+
+    void VSPluginServer::RegisterLazy(_In_ CONST PluginManifestEntry & entry)
+    {
+        PluginClassList::const_iterator classIter = entry.Classes.begin();
+        while (classIter != entry.Classes.end())
+        {
+            m_Registry.AddDeferred(classIter->first, classIter->second, entry.Path);
+            ++classIter;
+        }
+    }
+
+    void VSPluginServer::DropLazy(_In_ CONST String & fullname)
+    {
+        m_Registry.RemoveDeferred(fullname);
+    }
+
+    String VSPluginServer::FindLazyModule(_In_ CONST String & name) CONST
+    {
+        uint32_t count = m_Registry.GetCount();
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            CONST ClassRecord * pRecord = m_Registry.GetRecord(index);
+            if (pRecord->Module)
+            {
+                continue;
+            }
+
+            String module = PathFindFileName(pRecord->Path.GetData());
+            uint32_t ext = module.ReverseFind(L'.');
+            if (ext != String::Npos)
+            {
+                module = module.Left(ext);
+            }
+
+            CONST PluginManifestEntry * pEntry = (m_Manifest) ? m_Manifest->Find(pRecord->Path) : nullptr;
+            if (module.Compare(name, false) || (pEntry && pEntry->Name.Compare(name, false)))
+            {
+                return pRecord->Path;
+            }
+        }
+
+        return String();
+    }
+
+    VoodooResult VSPluginServer::LoadLazy(_In_ ICore * pCore, _In_ CONST String & fullname)
+    {
+        // Drop this module's classes first, so a failed load or circular dependency cannot load it again
+        this->DropLazy(fullname);
+
+        // Dependencies listed in the manifest are loaded first, if they were deferred as well
+        CONST PluginManifestEntry * pEntry = (m_Manifest) ? m_Manifest->Find(fullname) : nullptr;
+        if (pEntry)
+        {
+            StringList depends = pEntry->Depends;
+
+            StringList::const_iterator depend = depends.begin();
+            while (depend != depends.end())
+            {
+                String dependPath = this->FindLazyModule(*depend);
+                if (!dependPath.IsEmpty())
+                {
+                    this->LoadLazy(pCore, dependPath);
+                }
+                ++depend;
+            }
+        }
+
+        if (m_Logger)
+        {
+            m_Logger->LogMessage(VSLog_CoreInfo, VOODOO_CORE_NAME, 
+                StringFormat("Loading deferred module '%1%'.") << fullname);
+        }
+
+        VoodooResult result = this->LoadPlugin(pCore, fullname);
+
+        if (m_Manifest)
+        {
+            m_Manifest->Save();
+        }
+
+        m_Registry.Freeze();
+
+        return result;
+    }
+
+    bool VSPluginServer::IsReloadEnabled(_In_ ICore * pCore) CONST
+    {
+        CONST ConfigDesc * pConfig = (pCore) ? pCore->GetConfigDesc() : nullptr;
+        if (!pConfig || pConfig->PluginReload.IsEmpty())
+        {
+            return false;
+        }
+
+        String reload = m_Parser->Parse(pConfig->PluginReload);
+        return (reload.Compare(VSTR("true"), false) || reload.StartsWith("1"));
+    }
+
+    String VSPluginServer::CopyShadow(_In_ CONST String & fullname)
+    {
+        String shadow;
+        if (!CopyShadowFile(fullname, &m_ShadowCount, &shadow) && m_Logger)
+        {
+            m_Logger->LogMessage
+            (
+                VSLog_CoreWarning, VOODOO_CORE_NAME,
+                StringFormat("Unable to copy module '%1%' for reloading.") << fullname
+            );
+        }
+
+        return shadow;
+    }
+
+    void VSPluginServer::TrackShadow(_In_ CONST String & fullname, _In_ CONST String & shadow, _In_ CONST bool loaded)
+    {
+        if (shadow == fullname)
+        {
+            return;
+        }
+
+        if (!loaded)
+        {
+            DeleteFile(shadow.GetData());
+            return;
+        }
+
+        PluginShadow & entry = m_Shadows[fullname];
+        entry.Shadow = shadow;
+        VSPluginManifest::GetFileStamp(fullname, &entry.Time, &entry.Size);
+    }
+
+    VoodooResult VSPluginServer::ReloadModule(_In_ ICore * pCore, _In_ CONST String & fullname)
+    {
+        PluginShadowMap::iterator shadowIter = m_Shadows.find(fullname);
+        StrongNameMap::iterator pathIter = m_PluginPaths.find(fullname);
+        if (shadowIter == m_Shadows.end() || pathIter == m_PluginPaths.end())
+        {
+            return VSFERR_INVALIDCALL;
+        }
+
+        // A file that cannot be copied may still be being written, so it is tried again on the next check
+        uint64_t time = 0, size = 0;
+        VSPluginManifest::GetFileStamp(fullname, &time, &size);
+
+        String shadow = this->CopyShadow(fullname);
+        if (shadow == fullname)
+        {
+            return VSF_FAIL;
+        }
+
+        shadowIter->second.Time = time;
+        shadowIter->second.Size = size;
+
+        VSPlugin * pModule = nullptr;
+        {
+            VOODOO_PROFILE_SCOPE(VSTR("Map module"), fullname.GetData());
+            pModule = VSPlugin::Load(this, shadow);
+        }
+
+        if (!pModule)
+        {
+            DeleteFile(shadow.GetData());
+
+            if (m_Logger)
+            {
+                m_Logger->LogMessage
+                (
+                    VSLog_CoreError, VOODOO_CORE_NAME,
+                    StringFormat("Unable to reload module '%1%', the loaded copy remains in use.") << fullname
+                );
+            }
+
+            return VSF_FAIL;
+        }
+
+        Uuid libid = pathIter->second;
+        PluginRef oldModule = m_Plugins[libid];
+
+        // The old copy is reset as if it were unloaded, but stays mapped for the objects it created
+        oldModule->PluginReset(pCore);
+        m_Registry.RemoveModule(oldModule.get());
+
+        StrongNameMap::iterator nameIter = m_PluginNames.begin();
+        while (nameIter != m_PluginNames.end())
+        {
+            if (nameIter->second == libid)
+            {
+                m_PluginNames.erase(nameIter++);
+            }
+            else
+            {
+                ++nameIter;
+            }
+        }
+
+        m_PluginPaths.erase(pathIter);
+        m_Plugins.erase(libid);
+
+        if (FAILED(this->InitPlugin(pCore, fullname, pModule)))
+        {
+            DeleteFile(shadow.GetData());
+
+            if (m_Logger)
+            {
+                m_Logger->LogMessage
+                (
+                    VSLog_CoreError, VOODOO_CORE_NAME,
+                    StringFormat("Unable to initialize reloaded module '%1%', restoring the previous copy.") << fullname
+                );
+            }
+
+            this->InitPlugin(pCore, fullname, static_cast<VSPlugin*>(oldModule.get()));
+            m_Registry.Freeze();
+
+            return VSF_FAIL;
+        }
+
+        RetiredPlugin retired;
+        retired.Module = oldModule;
+        retired.Shadow = shadowIter->second.Shadow;
+        m_Retired.push_back(retired);
+        oldModule.reset();
+
+        shadowIter->second.Shadow = shadow;
+        m_Registry.Freeze();
+
+        if (m_Logger)
+        {
+            m_Logger->LogMessage(VSLog_CoreNotice, VOODOO_CORE_NAME, 
+                StringFormat("Reloaded module '%1%'.") << fullname);
+        }
+
+        Variant module = CreateVariant(static_cast<IObject*>(pModule));
+        pCore->PostEvent(EventIds::PluginReloaded, 1, &module, VSPost_Default);
+
+        this->ReleaseRetired();
+
+        return VSF_OK;
+    }
+
+    void VSPluginServer::ReleaseRetired()
+    {
+        RetiredPluginList::iterator iter = m_Retired.begin();
+        while (iter != m_Retired.end())
+        {
+            if (static_cast<VSPlugin*>(iter->Module.get())->CanUnload())
+            {
+                String shadow = iter->Shadow;
+                iter = m_Retired.erase(iter);
+                DeleteFile(shadow.GetData());
+
+                if (m_Logger)
+                {
+                    m_Logger->LogMessage(VSLog_CoreInfo, VOODOO_CORE_NAME, 
+                        StringFormat("Freed retired module copy '%1%'.") << shadow);
+                }
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
 
-        ClassMap::const_iterator classiter = m_Classes.find(clsid);
+    VoodooResult VOODOO_METHODTYPE VSPluginServer::LoadPlugin(_In_ ICore * pCore, _In_ IFile * pFile)
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
 
-        if (classiter != m_Classes.end())
+        if (pFile)
+        {
+            return this->LoadPlugin(pCore, pFile->GetPath());
+        }
+        else
         {
-            PluginRef module = classiter->second.first;
-            uint32_t index = classiter->second.second;
+            return VSFERR_INVALIDPARAMS;
+        }
+    }
+
+    VoodooResult VOODOO_METHODTYPE VSPluginServer::UnloadPlugin(_In_ ICore * pCore, _In_ CONST String & name)
+    {
+        StrongNameMap::iterator module = m_PluginNames.find(name);
+        if (module != m_PluginNames.end())
+        {
+            // Unloading by libid removes every name for the module, including this one
+            Uuid libid = module->second;
+            return this->UnloadPlugin(pCore, libid);
+        }
+        else
+        {
+            return VSFERR_INVALIDPARAMS;
+        }
+    }
+
+    VoodooResult VOODOO_METHODTYPE VSPluginServer::UnloadPlugin(_In_ ICore * pCore, _In_ CONST Uuid libid)
+    {
+        StrongPluginMap::iterator module = m_Plugins.find(libid);
+        if (module != m_Plugins.end())
+        {
+            PluginRef plugin = module->second;
+            plugin->PluginReset(pCore);
+
+            m_Registry.RemoveModule(plugin.get());
+            m_Registry.Freeze();
+
+            StrongNameMap::iterator iter = m_PluginNames.begin();
+            while (iter != m_PluginNames.end())
+            {
+                if (iter->second == libid)
+                {
+                    m_PluginNames.erase(iter++);
+                }
+                else
+                {
+                    ++iter;
+                }
+            }
+
+            StringList shadows;
+            iter = m_PluginPaths.begin();
+            while (iter != m_PluginPaths.end())
+            {
+                if (iter->second == libid)
+                {
+                    PluginShadowMap::iterator shadow = m_Shadows.find(iter->first);
+                    if (shadow != m_Shadows.end())
+                    {
+                        shadows.push_back(shadow->second.Shadow);
+                        m_Shadows.erase(shadow);
+                    }
+
+                    m_PluginPaths.erase(iter++);
+                }
+                else
+                {
+                    ++iter;
+                }
+            }
+
+            m_Plugins.erase(module);
+            plugin.reset();
+
+            // Only succeeds if the module was freed, otherwise the copy is overwritten by a later run
+            StringList::const_iterator shadowIter = shadows.begin();
+            while (shadowIter != shadows.end())
+            {
+                DeleteFile(shadowIter->GetData());
+                ++shadowIter;
+            }
+
+            return VSF_OK;
+        }
+        else
+        {
+            return VSFERR_INVALIDPARAMS;
+        }
+    }
+
+    VoodooResult VOODOO_METHODTYPE VSPluginServer::ReloadPlugin(_In_ ICore * pCore, _In_ CONST String & name)
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        StrongNameMap::const_iterator module = m_PluginNames.find(name);
+        if (module == m_PluginNames.end())
+        {
+            return VSFERR_INVALIDPARAMS;
+        }
+
+        StrongNameMap::const_iterator pathIter = m_PluginPaths.begin();
+        while (pathIter != m_PluginPaths.end())
+        {
+            if (pathIter->second == module->second)
+            {
+                String fullname = pathIter->first;
+                VoodooResult result = this->ReloadModule(pCore, fullname);
+
+                if (m_Manifest)
+                {
+                    m_Manifest->Save();
+                }
+
+                return result;
+            }
+            ++pathIter;
+        }
+
+        return VSFERR_INVALIDPARAMS;
+    }
+
+    VoodooResult VOODOO_METHODTYPE VSPluginServer::ReloadChanged(_In_ ICore * pCore)
+    {
+        if (m_Shadows.empty() && m_Retired.empty())
+        {
+            return VSFOK_REDUNDANT;
+        }
+
+        // Called every frame, so only look at the files occasionally
+        DWORD now = GetTickCount();
+        if (now - m_LastCheck < 500)
+        {
+            return VSFOK_REDUNDANT;
+        }
+        m_LastCheck = now;
+
+        this->ReleaseRetired();
+
+        StringList changed;
+        PluginShadowMap::const_iterator shadowIter = m_Shadows.begin();
+        while (shadowIter != m_Shadows.end())
+        {
+            uint64_t time = 0, size = 0;
+            if (VSPluginManifest::GetFileStamp(shadowIter->first, &time, &size) &&
+                (time != shadowIter->second.Time || size != shadowIter->second.Size))
+            {
+                changed.push_back(shadowIter->first);
+            }
+            ++shadowIter;
+        }
+
+        if (changed.empty())
+        {
+            return VSFOK_REDUNDANT;
+        }
+
+        VoodooResult result = VSF_OK;
+        StringList::const_iterator changedIter = changed.begin();
+        while (changedIter != changed.end())
+        {
+            if (FAILED(this->ReloadModule(pCore, *changedIter)))
+            {
+                result = VSF_FAIL;
+            }
+            ++changedIter;
+        }
+
+        if (m_Manifest)
+        {
+            m_Manifest->Save();
+        }
+
+        return result;
+    }
+
+    bool VOODOO_METHODTYPE VSPluginServer::ClassExists(_In_ CONST Uuid clsid) CONST
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        return (m_Registry.Find(clsid) != nullptr);
+    }
+
+    bool VOODOO_METHODTYPE VSPluginServer::ClassExists(_In_ CONST String & name) CONST
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        if (m_Registry.Find(name))
+        {
+            return true;
+        }
+
+        Uuid clsid;
+        return (name.ToUuid(&clsid) && this->ClassExists(clsid));
+    }
+
+    _Check_return_ IObject * VOODOO_METHODTYPE VSPluginServer::CreateObject(_In_ ICore * pCore, _In_ CONST Uuid clsid) CONST
+    {
+        VOODOO_DEBUG_FUNCLOG(m_Logger);
+
+        CONST ClassRecord * pRecord = m_Registry.Find(clsid);
+
+        if (pRecord && !pRecord->Module)
+        {
+            // Load the module providing the class on first use, which changes only what is cached
+            String fullname = pRecord->Path;
+            const_cast<VSPluginServer*>(this)->LoadLazy(pCore, fullname);
+            pRecord = m_Registry.Find(clsid);
+        }
+
+        if (pRecord && pRecord->Module)
+        {
+            PluginRef module = pRecord->Module;
+            uint32_t index = pRecord->Index;
 
             IObject * object = module->CreateClass(index, pCore);
 
@@ -461,20 +1493,21 @@ namespace VoodooShader
     {
         VOODOO_DEBUG_FUNCLOG(m_Logger);
 
-        Uuid clsid;
-        if (!name.ToUuid(&clsid))
+        // Names are far more common than Uuid strings, so try them before parsing
+        CONST ClassRecord * pRecord = m_Registry.Find(name);
+        if (pRecord)
         {
-            StrongNameMap::const_iterator classiter = m_ClassNames.find(name);
-            if (classiter != m_ClassNames.end())
-            {
-                clsid = classiter->second;
-            }
-            else
-            {
-                return nullptr;
-            }
+            return this->CreateObject(pCore, pRecord->ClsId);
         }
 
-        return this->CreateObject(pCore, clsid);
+        Uuid clsid;
+        if (name.ToUuid(&clsid))
+        {
+            return this->CreateObject(pCore, clsid);
+        }
+        else
+        {
+            return nullptr;
+        }
     }
 }
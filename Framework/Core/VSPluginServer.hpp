@@ -20,9 +20,59 @@
 #pragma once
 
 #include "VoodooInternal.hpp"
+#include "VSClassRegistry.hpp"
+#include "VSPlugin.hpp"
+#include "VSPluginManifest.hpp"
 
 namespace VoodooShader
 {
+    /**
+     * A module loaded from a copy, so the original file can be replaced while the module is in use.
+     */
+    struct PluginShadow
+    {
+        String      Shadow;     /* !< Path of the copy that was loaded. */
+        uint64_t    Time;       /* !< Stamp of the original file when it was copied. */
+        uint64_t    Size;
+    };
+
+    /**
+     * A module that has been replaced by a newer copy, but may still have live objects.
+     */
+    struct RetiredPlugin
+    {
+        PluginRef   Module;
+        String      Shadow;
+    };
+
+    /**
+     * A module being loaded as part of a set. Workers only write the exports and mapped flag of their own task.
+     */
+    struct PluginLoadTask
+    {
+        String Path;
+        String MapPath;     /* !< The path actually mapped, a copy of the module if reloading is enabled. */
+        String Module;
+        VSPlugin::Exports Exports;
+        bool Mapped;
+    };
+
+    /**
+     * A set of modules mapped away from the core's thread, then registered on it.
+     */
+    struct PluginMapSet
+    {
+        StringPairList  Paths;      /* !< Directories and filters to search, already parsed. */
+        StringList      Files;      /* !< Modules to load, as full paths. */
+        bool            Shadow;     /* !< Map copies of the modules, so they can be reloaded. */
+        volatile LONG * pShadowCount;
+        StringList      Missing;    /* !< Directories that could not be searched. */
+        std::vector<PluginLoadTask> Tasks;
+    };
+
+    typedef std::map<String, PluginShadow> PluginShadowMap;
+    typedef std::vector<RetiredPlugin> RetiredPluginList;
+
     /**
      * @clsid e6f312a0-05af-11e1-9e05-005056c00008
      */
@@ -44,19 +94,58 @@ namespace VoodooShader
         VOODOO_METHOD(LoadPath)(_In_ ICore * pCore, _In_ CONST String & path, _In_ CONST String & filter);
         VOODOO_METHOD(LoadPlugin)(_In_ ICore * pCore, _In_ IFile * pFile);
         VOODOO_METHOD(LoadPlugin)(_In_ ICore * pCore, _In_ CONST String & name);
+        VOODOO_METHOD(LoadPlugins)(_In_ ICore * pCore, _In_ CONST uint32_t count, _In_reads_(count) CONST String * pNames);
         VOODOO_METHOD(UnloadPlugin)(_In_ ICore * pCore, _In_ CONST String & name);
         VOODOO_METHOD(UnloadPlugin)(_In_ ICore * pCore, _In_ CONST Uuid libid);
+        VOODOO_METHOD(ReloadPlugin)(_In_ ICore * pCore, _In_ CONST String & name);
+        VOODOO_METHOD(ReloadChanged)(_In_ ICore * pCore);
         VOODOO_METHOD_(bool, ClassExists)(_In_ CONST Uuid refid) CONST;
         VOODOO_METHOD_(bool, ClassExists)(_In_ CONST String & name) CONST;
         _Check_return_ VOODOO_METHOD_(IObject *, CreateObject)(_In_ ICore * pCore, _In_ CONST Uuid refid) CONST;
         _Check_return_ VOODOO_METHOD_(IObject *, CreateObject)(_In_ ICore * pCore, _In_ CONST String & name) CONST;
 
+        /**
+         * Starts a set of modules to be mapped by MapSet, resolving paths with the current variables. Called on the
+         * core's thread.
+         */
+        void PrepareSet(_In_ ICore * pCore, _In_ CONST StringPairList & paths, _In_ CONST StringList & files, _Out_ PluginMapSet * pSet);
+        /**
+         * Searches the set's directories, copies modules if reloading is enabled and maps them, resolving their exports.
+         * Nothing is initialized or registered, so this may run on any thread while the core is in use.
+         */
+        static void MapSet(_Inout_ PluginMapSet * pSet);
+        /**
+         * Initializes and registers the modules of a mapped set, in dependency order. Modules loaded since the set was
+         * prepared are released instead. Called on the core's thread.
+         */
+        VoodooResult RegisterSet(_In_ ICore * pCore, _Inout_ PluginMapSet * pSet);
+        /**
+         * Releases the modules of a mapped set without initializing them.
+         */
+        static void DropSet(_Inout_ PluginMapSet * pSet);
+
     private:
         // Private these to prevent copying internally (external libs never will).
         VSPluginServer(CONST VSPluginServer & other);
         VSPluginServer & operator=(CONST VSPluginServer & other);
         ~VSPluginServer();
 
+        String GetFullPath(_In_ CONST String & filename) CONST;
+        uint32_t GetThreadCount(_In_ ICore * pCore) CONST;
+        static void MapTasks(_Inout_ std::vector<PluginLoadTask> & tasks, _In_ CONST uint32_t threads);
+        VoodooResult InitTasks(_In_ ICore * pCore, _Inout_ std::vector<PluginLoadTask> & tasks);
+        VoodooResult InitPlugin(_In_ ICore * pCore, _In_ CONST String & fullname, _In_ VSPlugin * pModule);
+        void OpenManifest(_In_ ICore * pCore);
+        void RegisterLazy(_In_ CONST PluginManifestEntry & entry);
+        void DropLazy(_In_ CONST String & fullname);
+        String FindLazyModule(_In_ CONST String & name) CONST;
+        VoodooResult LoadLazy(_In_ ICore * pCore, _In_ CONST String & fullname);
+        bool IsReloadEnabled(_In_ ICore * pCore) CONST;
+        String CopyShadow(_In_ CONST String & fullname);
+        void TrackShadow(_In_ CONST String & fullname, _In_ CONST String & shadow, _In_ CONST bool loaded);
+        VoodooResult ReloadModule(_In_ ICore * pCore, _In_ CONST String & fullname);
+        void ReleaseRetired();
+
         mutable uint32_t m_Refs;
 
         LoggerRef m_Logger;
@@ -64,7 +153,17 @@ namespace VoodooShader
 
         StrongPluginMap m_Plugins;
         StrongNameMap m_PluginNames;
-        ClassMap m_Classes;
-        StrongNameMap m_ClassNames;
+        StrongNameMap m_PluginPaths;
+        /** Classes from loaded modules, and from the manifest for modules not yet loaded. */
+        VSClassRegistry m_Registry;
+
+        VSPluginManifest * m_Manifest;
+
+        /** Modules loaded from copies, keyed by the original path. */
+        PluginShadowMap m_Shadows;
+        RetiredPluginList m_Retired;
+        /** Numbers the copies of modules, which sets being mapped also take from. */
+        volatile LONG m_ShadowCount;
+        DWORD m_LastCheck;
     };
 }
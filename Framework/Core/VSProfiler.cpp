@@ -0,0 +1,148 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+
+#include "VSProfiler.hpp"
+// System
+#pragma warning(push,3)
+#include <fstream>
+#include <string>
+#pragma warning(pop)
+
+namespace VoodooShader
+{
+    VSProfiler * gProfiler = nullptr;
+
+    static void AppendJson(_Inout_ std::string & buffer, _In_ CONST String & str)
+    {
+        char escape[8];
+
+        buffer += '"';
+        CONST wchar_t * chars = str.GetData();
+        while (chars && *chars)
+        {
+            wchar_t ch = *chars;
+            if (ch == L'"' || ch == L'\\')
+            {
+                buffer += '\\';
+                buffer += (char)ch;
+            }
+            else if (ch < 0x20 || ch > 0x7E)
+            {
+                sprintf_s(escape, "\\u%04x", (uint32_t)ch);
+                buffer += escape;
+            }
+            else
+            {
+                buffer += (char)ch;
+            }
+            ++chars;
+        }
+        buffer += '"';
+    }
+
+    VSProfiler::VSProfiler()
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        m_Frequency = frequency.QuadPart;
+        m_Start = VSProfiler::GetTicks();
+
+        InitializeCriticalSection(&m_Lock);
+        m_Spans.reserve(64);
+    }
+
+    VSProfiler::~VSProfiler()
+    {
+        DeleteCriticalSection(&m_Lock);
+    }
+
+    int64_t VSProfiler::GetTicks()
+    {
+        LARGE_INTEGER ticks;
+        QueryPerformanceCounter(&ticks);
+        return ticks.QuadPart;
+    }
+
+    void VSProfiler::Add(_In_z_ CONST wchar_t * name, _In_opt_z_ CONST wchar_t * detail, _In_ CONST int64_t begin, _In_ CONST int64_t end)
+    {
+        Span span;
+        span.Name = name;
+        span.Detail = (detail) ? detail : VSTR("");
+        span.Begin = begin;
+        span.End = end;
+        span.Thread = GetCurrentThreadId();
+
+        EnterCriticalSection(&m_Lock);
+        m_Spans.push_back(span);
+        LeaveCriticalSection(&m_Lock);
+    }
+
+    bool VSProfiler::Write(_In_ CONST String & path) CONST
+    {
+        std::string buffer = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        char number[96];
+        DWORD process = GetCurrentProcessId();
+
+        EnterCriticalSection(&m_Lock);
+
+        std::vector<Span>::const_iterator iter = m_Spans.begin();
+        while (iter != m_Spans.end())
+        {
+            // Complete events, with times in microseconds since the profiler was created
+            double begin = (double)(iter->Begin - m_Start) * 1000000.0 / (double)m_Frequency;
+            double duration = (double)(iter->End - iter->Begin) * 1000000.0 / (double)m_Frequency;
+
+            buffer += "{\"name\":";
+            AppendJson(buffer, iter->Name);
+            sprintf_s(number, ",\"cat\":\"startup\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lu,\"tid\":%lu", 
+                begin, duration, process, iter->Thread);
+            buffer += number;
+            if (!iter->Detail.IsEmpty())
+            {
+                buffer += ",\"args\":{\"detail\":";
+                AppendJson(buffer, iter->Detail);
+                buffer += '}';
+            }
+            buffer += '}';
+
+            ++iter;
+            if (iter != m_Spans.end())
+            {
+                buffer += ',';
+            }
+            buffer += '\n';
+        }
+
+        LeaveCriticalSection(&m_Lock);
+
+        buffer += "]}\n";
+
+        std::ofstream file(path.GetData(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        file.write(buffer.c_str(), buffer.length());
+        file.close();
+
+        return true;
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooInternal.hpp"
+
+namespace VoodooShader
+{
+    /**
+     * Startup profiler. Records named time spans from any thread and writes them as a Chrome trace, the JSON event format
+     * read by <code>chrome://tracing</code> and Perfetto. Spans on the same thread nest by time.
+     *
+     * The core creates a profiler for the duration of ICore::Init() when the <code>VOODOO_PROFILE</code> environment
+     * variable is set, and writes the trace next to the log. Otherwise no profiler exists and timed scopes only test a
+     * null pointer; defining <code>VOODOO_NO_PROFILE</code> removes them entirely.
+     */
+    class VSProfiler
+    {
+    public:
+        VSProfiler();
+        ~VSProfiler();
+
+        /**
+         * Retrieves the current time, in profiler ticks.
+         */
+        static int64_t GetTicks();
+
+        /**
+         * Records a span. Names and details are copied.
+         *
+         * @param name The span name.
+         * @param detail Optional detail, such as a file name.
+         * @param begin The start of the span, from GetTicks().
+         * @param end The end of the span, from GetTicks().
+         */
+        void Add(_In_z_ CONST wchar_t * name, _In_opt_z_ CONST wchar_t * detail, _In_ CONST int64_t begin, _In_ CONST int64_t end);
+
+        /**
+         * Writes the recorded spans as a Chrome trace.
+         *
+         * @return True if the file was written.
+         */
+        bool Write(_In_ CONST String & path) CONST;
+
+    private:
+        VSProfiler(CONST VSProfiler & other);
+        VSProfiler & operator=(CONST VSProfiler & other);
+
+        struct Span
+        {
+            String Name;
+            String Detail;
+            int64_t Begin;
+            int64_t End;
+            DWORD Thread;
+        };
+
+        mutable CRITICAL_SECTION m_Lock;
+        std::vector<Span> m_Spans;
+        int64_t m_Start;
+        int64_t m_Frequency;
+    };
+
+    /**
+     * The active profiler, or nullptr when profiling is disabled.
+     */
+    extern VSProfiler * gProfiler;
+
+    /**
+     * Times the enclosing scope, if a profiler is given. The name and detail must remain valid until the scope ends.
+     */
+    class VSProfileScope
+    {
+    public:
+        VSProfileScope(_In_opt_ VSProfiler * pProfiler, _In_z_ CONST wchar_t * name, _In_opt_z_ CONST wchar_t * detail = nullptr) :
+            m_Profiler(pProfiler), m_Name(name), m_Detail(detail), m_Begin(0)
+        {
+            if (m_Profiler)
+            {
+                m_Begin = VSProfiler::GetTicks();
+            }
+        }
+
+        ~VSProfileScope()
+        {
+            if (m_Profiler)
+            {
+                m_Profiler->Add(m_Name, m_Detail, m_Begin, VSProfiler::GetTicks());
+            }
+        }
+
+    private:
+        VSProfileScope(CONST VSProfileScope & other);
+        VSProfileScope & operator=(CONST VSProfileScope & other);
+
+        VSProfiler * m_Profiler;
+        CONST wchar_t * m_Name;
+        CONST wchar_t * m_Detail;
+        int64_t m_Begin;
+    };
+
+#define VOODOO_PROFILE_JOIN_(a, b) a ## b
+#define VOODOO_PROFILE_JOIN(a, b) VOODOO_PROFILE_JOIN_(a, b)
+#if defined(VOODOO_NO_PROFILE)
+#   define VOODOO_PROFILE_SCOPE(...)
+#else
+#   define VOODOO_PROFILE_SCOPE(...) VSProfileScope VOODOO_PROFILE_JOIN(profileScope_, __LINE__)(gProfiler, __VA_ARGS__)
+#endif
+}
@@ -0,0 +1,354 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooFramework.hpp"
+#include "VariantCast.hpp"
+
+#if !defined(VOODOO_NO_STDLIB)
+#pragma warning(push,3)
+#include <vector>
+#pragma warning(pop)
+
+namespace VoodooShader
+{
+    /**
+     * @addtogroup voodoo_utility
+     * @{
+     */
+    /**
+     * Retrieves the size of one component of a variant type, in bytes. Pointer types are a single component.
+     *
+     * @return The size, or 0 for types that cannot be packed into an array.
+     */
+    inline uint32_t GetComponentSize(_In_ CONST UnionType type)
+    {
+        switch (type)
+        {
+        case VSUT_Bool:     return sizeof(bool);
+        case VSUT_Int8:
+        case VSUT_UInt8:    return 1;
+        case VSUT_Int16:
+        case VSUT_UInt16:   return 2;
+        case VSUT_Int32:
+        case VSUT_UInt32:
+        case VSUT_Float:    return 4;
+        case VSUT_Double:   return 8;
+        case VSUT_Uuid:
+        case VSUT_String:
+        case VSUT_IObject:
+        case VSUT_PVoid:    return sizeof(void *);
+        default:            return 0;
+        }
+    }
+
+    /**
+     * Creates a VSUT_Array variant referencing packed data. The variant does not copy or own the data.
+     */
+    inline Variant CreateArrayVariant(_In_ CONST UnionType type, _In_ CONST uint32_t components, _In_ CONST uint32_t count, _In_opt_ void * pData)
+    {
+        DECLARE_VARIANT(var);
+        INITIALIZE_VARIANTC(var, Array, components);
+        var.VArray.Data = pData;
+        var.VArray.Count = count;
+        var.VArray.ElementType = type;
+        return var;
+    }
+
+    /**
+     * Retrieves the stride of the elements in a VSUT_Array variant, in bytes.
+     */
+    inline uint32_t GetArrayStride(_In_ CONST Variant & v)
+    {
+        uint32_t components = (v.Components > 0) ? v.Components : 1;
+        return GetComponentSize(v.VArray.ElementType) * components;
+    }
+
+    /**
+     * Retrieves the packed elements of a VSUT_Array variant as @a T, without copying. Matches when the element type is
+     * that of @a T and each element is exactly one @a T, so a Float4 view needs a four-component float array.
+     *
+     * @return The elements, or nullptr if the variant is not an array of @a T.
+     */
+    template<typename T>
+    inline T * GetArrayData(_In_ CONST Variant & v, _Out_opt_ uint32_t * pCount = nullptr)
+    {
+        if (v.Type != VSUT_Array || v.VArray.ElementType != VariantTraits<T>::Type || GetArrayStride(v) != sizeof(T))
+        {
+            return nullptr;
+        }
+
+        if (pCount)
+        {
+            (*pCount) = v.VArray.Count;
+        }
+
+        return reinterpret_cast<T *>(v.VArray.Data);
+    }
+
+    /**
+     * Array of values of a single variant type, stored packed rather than as an array of variants. An array of
+     * four-component floats takes 16 bytes per element, where a Variant takes 40.
+     *
+     * The array can be passed through any function taking variants, either as a single VSUT_Array variant referencing
+     * the packed data (see GetVariant()) or expanded into individual variants (see Expand()). Typed pointers to the data
+     * can be retrieved without copying through GetData<T>().
+     */
+    class VariantArray
+    {
+    public:
+        /**
+         * Creates an empty array. Types with no component size (see GetComponentSize()) are stored as VSUT_Unknown and
+         * hold no elements.
+         *
+         * @param type The type of every element.
+         * @param components The number of components in each element, from 1 to 4 (bool and pointer types always use 1).
+         */
+        VariantArray(_In_ CONST UnionType type = VSUT_Float, _In_ CONST uint32_t components = 4) :
+            m_Type(type), m_Components(components), m_Count(0)
+        {
+            if (m_Components < 1 || m_Components > 4 || type == VSUT_Bool || type >= VSUT_Uuid)
+            {
+                m_Components = 1;
+            }
+
+            m_Stride = GetComponentSize(type) * m_Components;
+            if (m_Stride == 0)
+            {
+                m_Type = VSUT_Unknown;
+            }
+        }
+
+        UnionType GetType() CONST
+        {
+            return m_Type;
+        }
+
+        uint32_t GetComponents() CONST
+        {
+            return m_Components;
+        }
+
+        /**
+         * Retrieves the size of each element, in bytes.
+         */
+        uint32_t GetStride() CONST
+        {
+            return m_Stride;
+        }
+
+        uint32_t GetCount() CONST
+        {
+            return m_Count;
+        }
+
+        /**
+         * Resizes the array. New elements are zeroed.
+         */
+        void Resize(_In_ CONST uint32_t count)
+        {
+            if (m_Stride == 0) return;
+
+            m_Data.resize(count * m_Stride, 0);
+            m_Count = count;
+        }
+
+        void Reserve(_In_ CONST uint32_t count)
+        {
+            m_Data.reserve(count * m_Stride);
+        }
+
+        void Clear()
+        {
+            m_Data.clear();
+            m_Count = 0;
+        }
+
+        /**
+         * Retrieves the packed data. The pointer is invalidated when the array is resized.
+         */
+        void * GetData()
+        {
+            return (m_Count > 0) ? &m_Data[0] : nullptr;
+        }
+
+        CONST void * GetData() CONST
+        {
+            return (m_Count > 0) ? &m_Data[0] : nullptr;
+        }
+
+        /**
+         * Retrieves the packed data as @a T, without copying.
+         *
+         * @return The data, or nullptr if the elements are not exactly one @a T each or the array is empty.
+         */
+        template<typename T>
+        T * GetData()
+        {
+            if (VariantTraits<T>::Type != m_Type || sizeof(T) != m_Stride) return nullptr;
+
+            return reinterpret_cast<T *>(this->GetData());
+        }
+
+        template<typename T>
+        CONST T * GetData() CONST
+        {
+            if (VariantTraits<T>::Type != m_Type || sizeof(T) != m_Stride) return nullptr;
+
+            return reinterpret_cast<CONST T *>(this->GetData());
+        }
+
+        /**
+         * Creates a VSUT_Array variant referencing the array. The variant is invalidated when the array is resized or
+         * destroyed.
+         */
+        Variant GetVariant()
+        {
+            return CreateArrayVariant(m_Type, m_Components, m_Count, this->GetData());
+        }
+
+        /**
+         * Appends an element from a variant of the array's type. Variants with fewer components are zero-extended.
+         *
+         * @return False if the variant is of another type or has more components than the array.
+         */
+        bool Append(_In_ CONST Variant & value)
+        {
+            if (!this->Accepts(value)) return false;
+
+            this->Resize(m_Count + 1);
+            this->Store(m_Count - 1, value);
+            return true;
+        }
+
+        /**
+         * Retrieves an element as a variant.
+         */
+        bool Get(_In_ CONST uint32_t index, _Out_ Variant * pValue) CONST
+        {
+            if (!pValue || index >= m_Count) return false;
+
+            (*pValue) = CreateVariant(m_Type);
+            pValue->Components = this->GetVariantComponents();
+            memcpy(&pValue->VBool, &m_Data[index * m_Stride], m_Stride);
+            return true;
+        }
+
+        /**
+         * Sets an element from a variant of the array's type. Variants with fewer components are zero-extended.
+         */
+        bool Set(_In_ CONST uint32_t index, _In_ CONST Variant & value)
+        {
+            if (index >= m_Count || !this->Accepts(value)) return false;
+
+            this->Store(index, value);
+            return true;
+        }
+
+        /**
+         * Replaces the contents of the array with packed copies of the given variants.
+         *
+         * @return The number of variants copied, stopping at the first that is not of the array's type.
+         */
+        uint32_t Assign(_In_reads_(count) CONST Variant * pSrc, _In_ CONST uint32_t count)
+        {
+            this->Clear();
+            if (!pSrc || m_Stride == 0) return 0;
+
+            this->Resize(count);
+
+            uint32_t index = 0;
+            while (index < count && this->Accepts(pSrc[index]))
+            {
+                this->Store(index, pSrc[index]);
+                ++index;
+            }
+
+            this->Resize(index);
+            return index;
+        }
+
+        /**
+         * Expands the array into individual variants, for functions that do not take VSUT_Array variants.
+         *
+         * @return The number of variants filled, at most @a count.
+         */
+        uint32_t Expand(_Out_writes_(count) Variant * pDst, _In_ CONST uint32_t count) CONST
+        {
+            if (!pDst) return 0;
+
+            uint32_t filled = (count < m_Count) ? count : m_Count;
+            if (m_Type == VSUT_Float && m_Components == 4)
+            {
+                Float4ToVariants(this->GetData<Float4>(), filled, 4, pDst);
+            }
+            else if (m_Type == VSUT_Int32 && m_Components == 4)
+            {
+                Int4ToVariants(this->GetData<Int4>(), filled, 4, pDst);
+            }
+            else
+            {
+                for (uint32_t index = 0; index < filled; ++index)
+                {
+                    this->Get(index, &pDst[index]);
+                }
+            }
+
+            return filled;
+        }
+
+    private:
+        bool Accepts(_In_ CONST Variant & value) CONST
+        {
+            return m_Stride > 0 && value.Type == m_Type && value.Components <= this->GetVariantComponents();
+        }
+
+        void Store(_In_ CONST uint32_t index, _In_ CONST Variant & value)
+        {
+            uint8_t * pElement = &m_Data[index * m_Stride];
+            uint32_t size = m_Stride;
+            if (value.Components > 0 && value.Components < m_Components)
+            {
+                size = value.Components * (m_Stride / m_Components);
+            }
+
+            memcpy(pElement, &value.VBool, size);
+            memset(pElement + size, 0, m_Stride - size);
+        }
+
+        /**
+         * Variants of bool and pointer types have no components.
+         */
+        uint32_t GetVariantComponents() CONST
+        {
+            return (m_Type == VSUT_Bool || m_Type >= VSUT_Uuid) ? 0 : m_Components;
+        }
+
+        UnionType m_Type;
+        uint32_t m_Components;
+        uint32_t m_Stride;
+        uint32_t m_Count;
+        std::vector<uint8_t> m_Data;
+    };
+    /**
+     * @}
+     */
+}
+#endif
@@ -0,0 +1,410 @@
+/*
+ * This file is part of the Voodoo Shader Framework.
+ *
+ * Copyright (c) 2010-2013 by Sean Sube
+ *
+ * The Voodoo Shader Framework is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser
+ * General Public License as published by the Free Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, write to
+ * the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 US
+ *
+ * Support and more information may be found at
+ *   http://www.voodooshader.com
+ * or by contacting the lead developer at
+ *   peachykeen@voodooshader.com
+ */
+#pragma once
+
+#include "VoodooFramework.hpp"
+
+#pragma warning(push,3)
+#include <emmintrin.h>
+#pragma warning(pop)
+
+namespace VoodooShader
+{
+    /**
+     * @addtogroup voodoo_utility
+     * @{
+     */
+    /**
+     * Maps a value type to the variant type, component count and union member holding it. Only the specializations below
+     * are defined, so using an unsupported type fails to compile.
+     */
+    template<typename T>
+    struct VariantTraits;
+
+#define VOODOO_VARIANT_TRAITS(vtype, utype, field, comp) \
+    template<> \
+    struct VariantTraits<vtype> \
+    { \
+        typedef vtype ValueType; \
+        static CONST UnionType Type = utype; \
+        static CONST uint32_t Components = comp; \
+        static ValueType & Get(Variant & v) { return *reinterpret_cast<ValueType *>(&v.field); } \
+        static CONST ValueType & Get(CONST Variant & v) { return *reinterpret_cast<CONST ValueType *>(&v.field); } \
+    }
+
+    VOODOO_VARIANT_TRAITS(bool,         VSUT_Bool,      VBool,      0);
+    VOODOO_VARIANT_TRAITS(int8_t,       VSUT_Int8,      VInt8,      1);
+    VOODOO_VARIANT_TRAITS(Byte1,        VSUT_Int8,      VInt8,      1);
+    VOODOO_VARIANT_TRAITS(Byte2,        VSUT_Int8,      VInt8,      2);
+    VOODOO_VARIANT_TRAITS(Byte3,        VSUT_Int8,      VInt8,      3);
+    VOODOO_VARIANT_TRAITS(Byte4,        VSUT_Int8,      VInt8,      4);
+    VOODOO_VARIANT_TRAITS(uint8_t,      VSUT_UInt8,     VUInt8,     1);
+    VOODOO_VARIANT_TRAITS(UByte1,       VSUT_UInt8,     VUInt8,     1);
+    VOODOO_VARIANT_TRAITS(UByte2,       VSUT_UInt8,     VUInt8,     2);
+    VOODOO_VARIANT_TRAITS(UByte3,       VSUT_UInt8,     VUInt8,     3);
+    VOODOO_VARIANT_TRAITS(UByte4,       VSUT_UInt8,     VUInt8,     4);
+    VOODOO_VARIANT_TRAITS(int16_t,      VSUT_Int16,     VInt16,     1);
+    VOODOO_VARIANT_TRAITS(Short1,       VSUT_Int16,     VInt16,     1);
+    VOODOO_VARIANT_TRAITS(Short2,       VSUT_Int16,     VInt16,     2);
+    VOODOO_VARIANT_TRAITS(Short3,       VSUT_Int16,     VInt16,     3);
+    VOODOO_VARIANT_TRAITS(Short4,       VSUT_Int16,     VInt16,     4);
+    VOODOO_VARIANT_TRAITS(uint16_t,     VSUT_UInt16,    VUInt16,    1);
+    VOODOO_VARIANT_TRAITS(UShort1,      VSUT_UInt16,    VUInt16,    1);
+    VOODOO_VARIANT_TRAITS(UShort2,      VSUT_UInt16,    VUInt16,    2);
+    VOODOO_VARIANT_TRAITS(UShort3,      VSUT_UInt16,    VUInt16,    3);
+    VOODOO_VARIANT_TRAITS(UShort4,      VSUT_UInt16,    VUInt16,    4);
+    VOODOO_VARIANT_TRAITS(int32_t,      VSUT_Int32,     VInt32,     1);
+    VOODOO_VARIANT_TRAITS(Int1,         VSUT_Int32,     VInt32,     1);
+    VOODOO_VARIANT_TRAITS(Int2,         VSUT_Int32,     VInt32,     2);
+    VOODOO_VARIANT_TRAITS(Int3,         VSUT_Int32,     VInt32,     3);
+    VOODOO_VARIANT_TRAITS(Int4,         VSUT_Int32,     VInt32,     4);
+    VOODOO_VARIANT_TRAITS(uint32_t,     VSUT_UInt32,    VUInt32,    1);
+    VOODOO_VARIANT_TRAITS(UInt1,        VSUT_UInt32,    VUInt32,    1);
+    VOODOO_VARIANT_TRAITS(UInt2,        VSUT_UInt32,    VUInt32,    2);
+    VOODOO_VARIANT_TRAITS(UInt3,        VSUT_UInt32,    VUInt32,    3);
+    VOODOO_VARIANT_TRAITS(UInt4,        VSUT_UInt32,    VUInt32,    4);
+    VOODOO_VARIANT_TRAITS(float,        VSUT_Float,     VFloat,     1);
+    VOODOO_VARIANT_TRAITS(Float1,       VSUT_Float,     VFloat,     1);
+    VOODOO_VARIANT_TRAITS(Float2,       VSUT_Float,     VFloat,     2);
+    VOODOO_VARIANT_TRAITS(Float3,       VSUT_Float,     VFloat,     3);
+    VOODOO_VARIANT_TRAITS(Float4,       VSUT_Float,     VFloat,     4);
+    VOODOO_VARIANT_TRAITS(double,       VSUT_Double,    VDouble,    1);
+    VOODOO_VARIANT_TRAITS(Double1,      VSUT_Double,    VDouble,    1);
+    VOODOO_VARIANT_TRAITS(Double2,      VSUT_Double,    VDouble,    2);
+    VOODOO_VARIANT_TRAITS(Double3,      VSUT_Double,    VDouble,    3);
+    VOODOO_VARIANT_TRAITS(Double4,      VSUT_Double,    VDouble,    4);
+    VOODOO_VARIANT_TRAITS(Uuid *,       VSUT_Uuid,      VPUuid,     0);
+    VOODOO_VARIANT_TRAITS(String *,     VSUT_String,    VPString,   0);
+    VOODOO_VARIANT_TRAITS(IObject *,    VSUT_IObject,   VPIObject,  0);
+    VOODOO_VARIANT_TRAITS(void *,       VSUT_PVoid,     VPVoid,     0);
+    VOODOO_VARIANT_TRAITS(ArrayView,    VSUT_Array,     VArray,     0);
+
+    /**
+     * Checks whether a variant holds a @a T. Vector types match variants of the same type with at least as many
+     * components.
+     */
+    template<typename T>
+    inline bool VariantIs(_In_ CONST Variant & v)
+    {
+        return v.Type == VariantTraits<T>::Type && v.Components >= VariantTraits<T>::Components;
+    }
+
+    /**
+     * Retrieves the @a T held by a variant, without checking the type. Use where the type is already known, such as
+     * after VariantIs().
+     */
+    template<typename T>
+    inline CONST T & VariantGet(_In_ CONST Variant & v)
+    {
+        return VariantTraits<T>::Get(v);
+    }
+
+    template<typename T>
+    inline T & VariantGet(_In_ Variant & v)
+    {
+        return VariantTraits<T>::Get(v);
+    }
+
+    /**
+     * Retrieves the @a T held by a variant.
+     *
+     * @return False, leaving @a pOut untouched, if the variant does not hold a @a T.
+     */
+    template<typename T>
+    inline bool VariantCast(_In_ CONST Variant & v, _Out_ T * pOut)
+    {
+        if (!VariantIs<T>(v)) return false;
+
+        (*pOut) = VariantTraits<T>::Get(v);
+        return true;
+    }
+
+    /**
+     * Retrieves the @a T held by a variant, or @a fallback if the variant holds anything else.
+     */
+    template<typename T>
+    inline T VariantCast(_In_ CONST Variant & v, _In_ CONST T & fallback)
+    {
+        return VariantIs<T>(v) ? VariantTraits<T>::Get(v) : fallback;
+    }
+
+    /**
+     * Calls @a visitor with the union member holding the variant's value (for example, a Float4 for VSUT_Float) and the
+     * number of components. This is the only place a consumer needs to switch on the type; the visitor's overloads (or a
+     * template call operator) are resolved at compile time.
+     *
+     * @return False, without calling the visitor, if the variant is empty or of an unknown type.
+     */
+    template<typename Visitor>
+    inline bool VisitVariant(_In_ CONST Variant & v, _Inout_ Visitor & visitor)
+    {
+        switch (v.Type)
+        {
+        case VSUT_Bool:     visitor(v.VBool, v.Components);     return true;
+        case VSUT_Int8:     visitor(v.VInt8, v.Components);     return true;
+        case VSUT_UInt8:    visitor(v.VUInt8, v.Components);    return true;
+        case VSUT_Int16:    visitor(v.VInt16, v.Components);    return true;
+        case VSUT_UInt16:   visitor(v.VUInt16, v.Components);   return true;
+        case VSUT_Int32:    visitor(v.VInt32, v.Components);    return true;
+        case VSUT_UInt32:   visitor(v.VUInt32, v.Components);   return true;
+        case VSUT_Float:    visitor(v.VFloat, v.Components);    return true;
+        case VSUT_Double:   visitor(v.VDouble, v.Components);   return true;
+        case VSUT_Uuid:     visitor(v.VPUuid, v.Components);    return true;
+        case VSUT_String:   visitor(v.VPString, v.Components);  return true;
+        case VSUT_IObject:  visitor(v.VPIObject, v.Components); return true;
+        case VSUT_PVoid:    visitor(v.VPVoid, v.Components);    return true;
+        case VSUT_Array:    visitor(v.VArray, v.Components);    return true;
+        default:            return false;
+        }
+    }
+
+    /**
+     * Finds the end of the run of variants starting at @a index which share its type.
+     */
+    inline uint32_t VariantRunEnd(_In_reads_(count) CONST Variant * pSrc, _In_ CONST uint32_t count, _In_ CONST uint32_t index)
+    {
+        UnionType type = pSrc[index].Type;
+        uint32_t end = index + 1;
+        while (end < count && pSrc[end].Type == type)
+        {
+            ++end;
+        }
+        return end;
+    }
+
+    /**
+     * Converts unsigned 32-bit integers to floats. SSE2 only converts signed values, so the halves are converted apart.
+     */
+    inline __m128 VariantConvertUInt(_In_ __m128i value)
+    {
+        __m128 high = _mm_cvtepi32_ps(_mm_srli_epi32(value, 16));
+        __m128 low  = _mm_cvtepi32_ps(_mm_and_si128(value, _mm_set1_epi32(0xFFFF)));
+        return _mm_add_ps(_mm_mul_ps(high, _mm_set1_ps(65536.0f)), low);
+    }
+
+    /**
+     * Converts numeric variants to packed Float4 values, as when filling shader constants. Variants are processed in runs
+     * of the same type, so each run is one branch-free SSE2 loop. All four components are converted; components beyond
+     * a variant's count hold whatever the variant held (zero for variants made by CreateVariant()).
+     *
+     * @return The number of variants converted, stopping at the first that is not numeric.
+     */
+    inline uint32_t VariantsToFloat4(_In_reads_(count) CONST Variant * pSrc, _In_ CONST uint32_t count, _Out_writes_(count) Float4 * pDst)
+    {
+        if (!pSrc || !pDst) return 0;
+
+        uint32_t index = 0;
+        while (index < count)
+        {
+            uint32_t end = VariantRunEnd(pSrc, count, index);
+
+            switch (pSrc[index].Type)
+            {
+            case VSUT_Float:
+                for (; index < end; ++index)
+                {
+                    _mm_storeu_ps(&pDst[index].X, _mm_loadu_ps(&pSrc[index].VFloat.X));
+                }
+                break;
+            case VSUT_Int32:
+                for (; index < end; ++index)
+                {
+                    __m128i value = _mm_loadu_si128(reinterpret_cast<CONST __m128i *>(&pSrc[index].VInt32));
+                    _mm_storeu_ps(&pDst[index].X, _mm_cvtepi32_ps(value));
+                }
+                break;
+            case VSUT_UInt32:
+                for (; index < end; ++index)
+                {
+                    __m128i value = _mm_loadu_si128(reinterpret_cast<CONST __m128i *>(&pSrc[index].VUInt32));
+                    _mm_storeu_ps(&pDst[index].X, VariantConvertUInt(value));
+                }
+                break;
+            case VSUT_Double:
+                for (; index < end; ++index)
+                {
+                    __m128 low  = _mm_cvtpd_ps(_mm_loadu_pd(&pSrc[index].VDouble.X));
+                    __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(&pSrc[index].VDouble.Z));
+                    _mm_storeu_ps(&pDst[index].X, _mm_movelh_ps(low, high));
+                }
+                break;
+            case VSUT_Bool:
+                for (; index < end; ++index)
+                {
+                    _mm_storeu_ps(&pDst[index].X, _mm_set_ss(pSrc[index].VBool ? 1.0f : 0.0f));
+                }
+                break;
+            case VSUT_Int8:
+                for (; index < end; ++index)
+                {
+                    CONST Byte4 & v = pSrc[index].VInt8;
+                    _mm_storeu_ps(&pDst[index].X, _mm_setr_ps(v.X, v.Y, v.Z, v.W));
+                }
+                break;
+            case VSUT_UInt8:
+                for (; index < end; ++index)
+                {
+                    CONST UByte4 & v = pSrc[index].VUInt8;
+                    _mm_storeu_ps(&pDst[index].X, _mm_setr_ps(v.X, v.Y, v.Z, v.W));
+                }
+                break;
+            case VSUT_Int16:
+                for (; index < end; ++index)
+                {
+                    CONST Short4 & v = pSrc[index].VInt16;
+                    _mm_storeu_ps(&pDst[index].X, _mm_setr_ps(v.X, v.Y, v.Z, v.W));
+                }
+                break;
+            case VSUT_UInt16:
+                for (; index < end; ++index)
+                {
+                    CONST UShort4 & v = pSrc[index].VUInt16;
+                    _mm_storeu_ps(&pDst[index].X, _mm_setr_ps(v.X, v.Y, v.Z, v.W));
+                }
+                break;
+            default:
+                return index;
+            }
+        }
+
+        return index;
+    }
+
+    /**
+     * Converts numeric variants to packed Int4 values, truncating floating-point values toward zero.
+     *
+     * @return The number of variants converted, stopping at the first that is not numeric.
+     */
+    inline uint32_t VariantsToInt4(_In_reads_(count) CONST Variant * pSrc, _In_ CONST uint32_t count, _Out_writes_(count) Int4 * pDst)
+    {
+        if (!pSrc || !pDst) return 0;
+
+        uint32_t index = 0;
+        while (index < count)
+        {
+            uint32_t end = VariantRunEnd(pSrc, count, index);
+
+            switch (pSrc[index].Type)
+            {
+            case VSUT_Int32:
+            case VSUT_UInt32:
+                for (; index < end; ++index)
+                {
+                    __m128i value = _mm_loadu_si128(reinterpret_cast<CONST __m128i *>(&pSrc[index].VInt32));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(&pDst[index]), value);
+                }
+                break;
+            case VSUT_Float:
+                for (; index < end; ++index)
+                {
+                    __m128i value = _mm_cvttps_epi32(_mm_loadu_ps(&pSrc[index].VFloat.X));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(&pDst[index]), value);
+                }
+                break;
+            case VSUT_Double:
+                for (; index < end; ++index)
+                {
+                    __m128i low  = _mm_cvttpd_epi32(_mm_loadu_pd(&pSrc[index].VDouble.X));
+                    __m128i high = _mm_cvttpd_epi32(_mm_loadu_pd(&pSrc[index].VDouble.Z));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(&pDst[index]), _mm_unpacklo_epi64(low, high));
+                }
+                break;
+            case VSUT_Bool:
+                for (; index < end; ++index)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(&pDst[index]), _mm_cvtsi32_si128(pSrc[index].VBool ? 1 : 0));
+                }
+                break;
+            case VSUT_Int8:
+                for (; index < end; ++index)
+                {
+                    CONST Byte4 & v = pSrc[index].VInt8;
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(&pDst[index]), _mm_setr_epi32(v.X, v.Y, v.Z, v.W));
+                }
+                break;
+            case VSUT_UInt8:
+                for (; index < end; ++index)
+                {
+                    CONST UByte4 & v = pSrc[index].VUInt8;
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(&pDst[index]), _mm_setr_epi32(v.X, v.Y, v.Z, v.W));
+                }
+                break;
+            case VSUT_Int16:
+                for (; index < end; ++index)
+                {
+                    CONST Short4 & v = pSrc[index].VInt16;
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(&pDst[index]), _mm_setr_epi32(v.X, v.Y, v.Z, v.W));
+                }
+                break;
+            case VSUT_UInt16:
+                for (; index < end; ++index)
+                {
+                    CONST UShort4 & v = pSrc[index].VUInt16;
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(&pDst[index]), _mm_setr_epi32(v.X, v.Y, v.Z, v.W));
+                }
+                break;
+            default:
+                return index;
+            }
+        }
+
+        return index;
+    }
+
+    /**
+     * Fills variants from packed Float4 values. Every variant becomes a VSUT_Float with @a components components, with
+     * the rest of the union cleared as CreateVariant() would.
+     */
+    inline void Float4ToVariants(_In_reads_(count) CONST Float4 * pSrc, _In_ CONST uint32_t count, _In_ CONST uint32_t components, _Out_writes_(count) Variant * pDst)
+    {
+        if (!pSrc || !pDst) return;
+
+        __m128 zero = _mm_setzero_ps();
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            float * pValue = &pDst[index].VFloat.X;
+            pDst[index].Type = VSUT_Float;
+            pDst[index].Components = components;
+            _mm_storeu_ps(pValue, _mm_loadu_ps(&pSrc[index].X));
+            _mm_storeu_ps(pValue + 4, zero);
+        }
+    }
+
+    /**
+     * Fills variants from packed Int4 values. Every variant becomes a VSUT_Int32 with @a components components.
+     */
+    inline void Int4ToVariants(_In_reads_(count) CONST Int4 * pSrc, _In_ CONST uint32_t count, _In_ CONST uint32_t components, _Out_writes_(count) Variant * pDst)
+    {
+        if (!pSrc || !pDst) return;
+
+        __m128i zero = _mm_setzero_si128();
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            __m128i * pValue = reinterpret_cast<__m128i *>(&pDst[index].VInt32);
+            pDst[index].Type = VSUT_Int32;
+            pDst[index].Components = components;
+            _mm_storeu_si128(pValue, _mm_loadu_si128(reinterpret_cast<CONST __m128i *>(&pSrc[index])));
+            _mm_storeu_si128(pValue + 1, zero);
+        }
+    }
+    /**
+     * @}
+     */
+}
@@ -33,15 +33,20 @@
 #if defined(VOODOO_DEBUG)
 #   define VOODOO_DEBUG_BREAK   DebugBreak()
 #   define VOODOO_CHECK_IMPL    if (!m_Impl) { Throw(VSTR("Extended Debug"), VSTR("Object has no implementation instance."), nullptr); }
-#   define SAFE_INCREMENT(x)    InterlockedIncrement(&x)
-#   define SAFE_DECREMENT(x)    InterlockedDecrement(&x)
 #else
 #   define VOODOO_DEBUG_BREAK
 #   define VOODOO_CHECK_IMPL
-#   define SAFE_INCREMENT(x)    ++x
-#   define SAFE_DECREMENT(x)    --x
 #endif
 
+/**
+ * Atomic reference count operations, for <code>uint32_t</code> counts. These are used in every build, since objects may
+ * be referenced from several threads. The interlocked operations are full barriers, so the thread dropping the last
+ * reference sees every write made through the others before it deletes the object. Release() must use the returned count
+ * and not read the member again, since another thread may already have deleted the object.
+ */
+#define SAFE_INCREMENT(x)   static_cast<uint32_t>(InterlockedIncrement(reinterpret_cast<volatile LONG *>(&(x))))
+#define SAFE_DECREMENT(x)   static_cast<uint32_t>(InterlockedDecrement(reinterpret_cast<volatile LONG *>(&(x))))
+
 /**
  * @defgroup voodoo_macros_debug_log Extended Logging
  * @{
@@ -68,15 +73,20 @@
 #   include <stdlib.h>
 #   include <crtdbg.h>
 #   include <set>
-#   define DeclareDebugCache() std::set<VOODOO_DEBUG_TYPE *> DebugCache_##VOODOO_DEBUG_TYPE
-#   define AddThisToDebugCache() DebugCache_##VOODOO_DEBUG_TYPE.insert(this)
-#   define RemoveThisFromDebugCache() DebugCache_##VOODOO_DEBUG_TYPE.erase(this)
+#   define DeclareDebugCache() std::set<VOODOO_DEBUG_TYPE *> DebugCache_##VOODOO_DEBUG_TYPE; \
+        static ObjectTypeRecord DebugRecord(VOODOO_TOSTRING(VOODOO_DEBUG_TYPE), sizeof(VOODOO_DEBUG_TYPE))
+#   define AddThisToDebugCache() DebugCache_##VOODOO_DEBUG_TYPE.insert(this); DebugRecord.Add(this)
+#   define RemoveThisFromDebugCache() DebugCache_##VOODOO_DEBUG_TYPE.erase(this); DebugRecord.Remove(this)
 #   define vnew new(_NORMAL_BLOCK, __FILE__, __LINE__)
 #   define vdelete delete
 #else
-#   define DeclareDebugCache()
-#   define AddThisToDebugCache()
-#   define RemoveThisFromDebugCache()
+/**
+ * Live object tracking, used in every build. Each type gets an ObjectTypeRecord named for @p VOODOO_DEBUG_TYPE, which
+ * costs three interlocked operations per object created or destroyed.
+ */
+#   define DeclareDebugCache() static ObjectTypeRecord DebugRecord(VOODOO_TOSTRING(VOODOO_DEBUG_TYPE), sizeof(VOODOO_DEBUG_TYPE))
+#   define AddThisToDebugCache() DebugRecord.Add(this)
+#   define RemoveThisFromDebugCache() DebugRecord.Remove(this)
 #   define vnew new
 #   define vdelete delete
 #endif
@@ -124,10 +124,17 @@
 
 #include "Converter.hpp"
 #include "Exception.hpp"
+#include "Math.hpp"
+#include "ObjectPool.hpp"
+#include "ObjectTracker.hpp"
+#include "PropertyStore.hpp"
 #include "Regex.hpp"
 #include "Stream.hpp"
 #include "String.hpp"
 #include "StringFormat.hpp"
+#include "VariantArray.hpp"
+#include "VariantCast.hpp"
+#include "VSON.hpp"
 
 #include "IObject.hpp"
 #include "IBinding.hpp"
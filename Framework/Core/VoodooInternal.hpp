@@ -40,4 +40,5 @@ namespace VoodooShader
     CONST uint32_t  VOODOO_CALLTYPE API_ClassCount();
     CONST wchar_t * VOODOO_CALLTYPE API_ClassInfo(_In_ CONST uint32_t index, _Out_ Uuid * pUuid);
     IObject *       VOODOO_CALLTYPE API_ClassCreate(_In_ CONST uint32_t index, _In_ ICore * pCore);
+    CONST PluginDesc * VOODOO_CALLTYPE API_PluginDesc();
 }
@@ -304,6 +304,30 @@ namespace VoodooShader
         VSVar_System        = 0x10,
     };
 
+    /**
+     * Parts of the config changed by a reload, passed with @ref EventIds::ConfigChanged.
+     */
+    enum ConfigChange : uint32_t
+    {
+        VSConfig_None       = 0x00,
+        VSConfig_Variables  = 0x01,     /* !< Variables were added, changed or removed. */
+        VSConfig_Log        = 0x02,     /* !< The log file or level changed. */
+        VSConfig_Plugins    = 0x04,     /* !< Plugin paths or files were added or removed. */
+        VSConfig_Classes    = 0x08,     /* !< One or more class config sections changed. */
+        VSConfig_Core       = 0x10,     /* !< The core classes changed; these cannot be applied until restarted. */
+        VSConfig_Expressions = 0x20,    /* !< Parameter expressions were added, changed or removed. */
+    };
+
+    /**
+     * Delivery of events posted with ICore::PostEvent().
+     */
+    enum EventPostFlags : uint32_t
+    {
+        VSPost_Default      = 0x00,     /* !< Delivered by the next ICore::Update(), on the thread calling it. */
+        VSPost_Coalesce     = 0x01,     /* !< Replaces the arguments of an undelivered post of the same event, if it was also coalesced. */
+        VSPost_Worker       = 0x02,     /* !< Delivered on the core's event thread, as soon as possible. */
+    };
+
     enum UnionType : uint32_t
     {
         VSUT_Unknown        = 0x00,
@@ -320,6 +344,7 @@ namespace VoodooShader
         VSUT_Uuid           = 0x0B,
         VSUT_String         = 0x0C,
         VSUT_IObject        = 0x0D,
+        VSUT_Array          = 0x0E,     /* !< Packed array of another type, see ArrayView. */
         VSUT_PVoid          = 0x0F,
     };
 #pragma warning(pop)
@@ -360,6 +385,17 @@ namespace VoodooShader
         DEFINE_UUID(D3DX9Effect)   = {0xb5, 0x8d, 0xc7, 0xf0, 0xde, 0x72, 0x4e, 0xcd, 0xa0, 0x0c, 0x01, 0x8e, 0xae, 0xf5, 0x63, 0x4b};
         DEFINE_UUID(D3DX9Handle)   = {0xdf, 0x34, 0x48, 0x55, 0xc1, 0x1e, 0x4f, 0xf6, 0x8c, 0x0a, 0x1e, 0x1f, 0xba, 0xea, 0xb6, 0xa8};
         DEFINE_UUID(D3DX9PassId)   = {0x3b, 0xfe, 0x94, 0x9c, 0x11, 0x5e, 0x48, 0x12, 0xb1, 0xa2, 0x77, 0xc0, 0x41, 0xbb, 0xcd, 0x69};
+        /**
+         * Read-only effect property, a VSUT_UInt32 variant holding the number of parameter sets (X) and the number of
+         * values actually uploaded to the device (Y) since the effect was created.
+         */
+        DEFINE_UUID(ParameterStats) = {0x35, 0xa5, 0x60, 0x71, 0x6c, 0x92, 0x4a, 0x38, 0x88, 0x5f, 0xf6, 0xde, 0x83, 0x56, 0xc6, 0x28};
+        /**
+         * Write-only parameter property, setting the value from a VSUT_Array variant of floats. Arrays with four
+         * components per element are set as by IParameter::SetVectorArray() and single-component arrays as by
+         * IParameter::SetFloatArray(); the array data is only read during the call.
+         */
+        DEFINE_UUID(ParameterValue) = {0xbe, 0x10, 0x1e, 0x9b, 0x6e, 0x7f, 0x4c, 0x76, 0xa8, 0x6c, 0x00, 0xa3, 0x12, 0x88, 0x1a, 0xcf};
         DEFINE_UUID(D3DSdkVersion) = {0xf7, 0xc8, 0xec, 0x01, 0x95, 0x7f, 0x48, 0xf1, 0x91, 0xbc, 0x1a, 0x9b, 0xa0, 0x84, 0xec, 0xc4};
         DEFINE_UUID(OpenGLTexture) = {0x98, 0x9f, 0x58, 0x94, 0x19, 0xb9, 0x47, 0x8f, 0xb0, 0xb7, 0x0f, 0x40, 0xbc, 0x76, 0xeb, 0xd5};
         DEFINE_UUID(OpenGLContext) = {0x1e, 0x88, 0xc6, 0x7a, 0x49, 0xa6, 0x42, 0x2b, 0xb7, 0x95, 0xb1, 0x54, 0x26, 0x90, 0xf7, 0x19};
@@ -372,6 +408,16 @@ namespace VoodooShader
     namespace EventIds
     {
         DEFINE_UUID(Finalize)       = {0xc3, 0x15, 0xac, 0xc2, 0x76, 0x82, 0x3d, 0x4e, 0xb4, 0x43, 0x6e, 0xa6, 0xcc, 0x56, 0xb7, 0x31};
+        /**
+         * Posted after a changed config has been applied, and delivered at the end of the same ICore::Update(). The single
+         * argument is a VSUT_UInt32 variant holding the @ref ConfigChange flags for the parts of the config that changed.
+         */
+        DEFINE_UUID(ConfigChanged)  = {0x41, 0x04, 0x74, 0x1a, 0xc9, 0xa6, 0x46, 0x7d, 0xb0, 0x2b, 0x01, 0xb5, 0x67, 0xa3, 0x80, 0xe5};
+        /**
+         * Posted after a module has been reloaded and its classes registered again, and delivered by ICore::Update(). The
+         * single argument is a VSUT_IObject variant holding the new IPlugin. Objects created before the reload still use the old module.
+         */
+        DEFINE_UUID(PluginReloaded) = {0x9e, 0x5b, 0x3d, 0x62, 0x17, 0xc4, 0x4a, 0x0f, 0x8d, 0x21, 0x6c, 0xe3, 0x52, 0x90, 0xab, 0x47};
     }
     /**
      * @}
@@ -440,6 +486,15 @@ namespace VoodooShader
         ValType X, Y, Z, W;
     };
 
+    /**
+     * Row-major 4x4 matrix, used with row vectors (<code>v * M</code>) as in Direct3D.
+     */
+    template <typename ValType>
+    struct Matrix4
+    {
+        ValType M[4][4];
+    };
+
     template <typename ValType>
     struct Rectangle
     {
@@ -484,13 +539,24 @@ namespace VoodooShader
     typedef Vector2<double>     Double2;
     typedef Vector3<double>     Double3;
     typedef Vector4<double>     Double4;
+    typedef Matrix4<float>      Float4x4;
     typedef Rectangle<uint32_t> Rect;
     typedef Volume<uint32_t>    Box;
+    /**
+     * Handles to global parameters and textures, resolved by the core without a name lookup. Handles pack a slot index
+     * and a generation, so a handle outliving its object resolves to nothing; 0 is never a valid handle.
+     */
+    typedef uint32_t            ParameterHandle;
+    typedef uint32_t            TextureHandle;
     /**
      * @}
      */
+    struct ArrayView;
+    struct ConfigDesc;
     struct Light;
+    struct ObjectStats;
     struct ParameterDesc;
+    struct PluginDesc;
     struct TextureDesc;
     struct TextureRegion;
     struct Variant;
@@ -539,17 +605,27 @@ namespace VoodooShader
         typedef const uint32_t  (VOODOO_CALLTYPE * ClassCountFunc)();
         typedef const wchar_t * (VOODOO_CALLTYPE * ClassInfoFunc)(const uint32_t, Uuid *);
         typedef IObject *       (VOODOO_CALLTYPE * ClassCreateFunc)(const uint32_t, ICore *);
+        typedef const wchar_t * const * (VOODOO_CALLTYPE * PluginDependsFunc)();
+        typedef const PluginDesc *      (VOODOO_CALLTYPE * PluginDescFunc)();
+        typedef bool                    (VOODOO_CALLTYPE * PluginCanUnloadFunc)();
         typedef VoodooResult    (VOODOO_CALLTYPE * CallbackFunc)(ICore *, uint32_t, Variant *);
+        typedef VoodooResult    (VOODOO_CALLTYPE * EventFunc)(ICore *, void *, uint32_t, Variant *);
     }
     /**
      * @}
      * @defgroup voodoo_references Reference Typedefs
-     * @note To provide smart intrusive pointers, Boost is required.
+     * @note To provide smart intrusive pointers, Boost is required. Boost's intrusive_ptr is moved rather than copied
+     *      where the compiler supports rvalue references, so returning or transferring a reference costs no AddRef.
      * @{
      */
 #if !defined(VOODOO_NO_BOOST)
+#   if defined(VOODOO_DEBUG_MEMORY)
     VOODOO_FUNCTION(void, intrusive_ptr_add_ref)(IObject * obj);
     VOODOO_FUNCTION(void, intrusive_ptr_release)(IObject * obj);
+#   else
+    inline void intrusive_ptr_add_ref(IObject * obj);
+    inline void intrusive_ptr_release(IObject * obj);
+#   endif
     typedef boost::intrusive_ptr<IBinding>       BindingRef;
     typedef boost::intrusive_ptr<ICore>          CoreRef;
     typedef boost::intrusive_ptr<IEffect>        EffectRef;
@@ -602,6 +678,9 @@ namespace VoodooShader
     typedef std::map<Uuid, PluginRef>           StrongPluginMap;
     typedef std::pair<PluginRef, uint32_t>      ClassSource;
     typedef std::map<Uuid, ClassSource>         ClassMap;
+    typedef std::list<StringPair>               StringPairList;
+    typedef std::multimap<String, String>       ConfigValues;
+    typedef std::map<String, ConfigValues>      ConfigClassMap;
 #endif
 #endif
     /**
@@ -623,6 +702,44 @@ namespace VoodooShader
         int32_t         Build;
         bool            Debug;
     };
+    /**
+     * Plugin ABI version, checked against PluginDesc::AbiVersion.
+     */
+#define VOODOO_PLUGIN_ABI 1
+    /**
+     * Class entry in a plugin descriptor.
+     */
+    struct PluginClassDesc
+    {
+        Uuid            ClsId;
+        const wchar_t * Name;
+    };
+    /**
+     * Static table describing a plugin, returned by the @p PluginDesc export in place of the separate entry points. See
+     * @ref voodoo_spec_plugin_exports_desc.
+     */
+    struct PluginDesc
+    {
+        uint32_t                    AbiVersion;     /* !< Must be VOODOO_PLUGIN_ABI. */
+        uint32_t                    Size;           /* !< Size of the descriptor, sizeof(PluginDesc). */
+        Functions::PluginInitFunc   PluginInit;
+        Functions::PluginResetFunc  PluginReset;    /* !< May be nullptr. */
+        Functions::ClassCreateFunc  ClassCreate;    /* !< May be nullptr if no classes are listed. */
+        const wchar_t * const *     Depends;        /* !< Null-terminated list of dependencies, or nullptr. */
+        uint32_t                    ClassCount;
+        const PluginClassDesc *     Classes;
+        Functions::PluginCanUnloadFunc CanUnload;   /* !< May be nullptr, if the module is never unloaded early. */
+    };
+    /**
+     * Packed array held by a VSUT_Array variant: Count elements of ElementType, each with the variant's component count,
+     * stored back to back. The variant does not own the data.
+     */
+    struct ArrayView
+    {
+        void *      Data;
+        uint32_t    Count;
+        UnionType   ElementType;
+    };
     /**
      * Property variant type. Consists of the value type (filled union field), components in the value (for vector
      * fields), and the value union capable of containing all common basic, vector and pointer types used in the
@@ -647,6 +764,7 @@ namespace VoodooShader
             String *    VPString;
             IObject *   VPIObject;
             void *      VPVoid;
+            ArrayView   VArray;
         };
     };
     /**
@@ -704,6 +822,17 @@ namespace VoodooShader
         uint32_t      Columns;
         uint32_t      Elements;
     };
+    /**
+     * Live object counts for one tracked type, see ICore::GetObjectStats().
+     */
+    struct ObjectStats
+    {
+        const wchar_t * Name;
+        uint32_t        Size;       /* !< Size of one object, in bytes. */
+        uint32_t        Live;
+        uint32_t        Created;    /* !< Objects created since the type was first used. */
+        uint64_t        Bytes;      /* !< Bytes held by live objects. */
+    };
     /**
      * @defgroup voodoo_variant_decl Variant Declaration & Init
      * @{
@@ -758,10 +887,10 @@ namespace VoodooShader
     inline Variant CreateVariant(const Double2 & v)     { DECLARE_VARIANT(var); INITIALIZE_VARIANT2(var, Double, v.X, v.Y); return var; }
     inline Variant CreateVariant(const Double3 & v)     { DECLARE_VARIANT(var); INITIALIZE_VARIANT3(var, Double, v.X, v.Y, v.Z); return var; }
     inline Variant CreateVariant(const Double4 & v)     { DECLARE_VARIANT(var); INITIALIZE_VARIANT4(var, Double, v.X, v.Y, v.Z, v.W); return var; }
-    inline Variant CreateVariant(Uuid * pV)             { DECLARE_VARIANT(var); INITIALIZE_VARIANTC(var, Uuid, 0); var.VPUuid = pV; }
-    inline Variant CreateVariant(String * pV)           { DECLARE_VARIANT(var); INITIALIZE_VARIANTC(var, String, 0); var.VPString = pV; }
-    inline Variant CreateVariant(IObject * pV)          { DECLARE_VARIANT(var); INITIALIZE_VARIANTC(var, IObject, 0); var.VPIObject = pV; }
-    inline Variant CreateVariant(void * pV)             { DECLARE_VARIANT(var); INITIALIZE_VARIANTC(var, PVoid, 0); var.VPVoid = pV; }
+    inline Variant CreateVariant(Uuid * pV)             { DECLARE_VARIANT(var); INITIALIZE_VARIANTC(var, Uuid, 0); var.VPUuid = pV; return var; }
+    inline Variant CreateVariant(String * pV)           { DECLARE_VARIANT(var); INITIALIZE_VARIANTC(var, String, 0); var.VPString = pV; return var; }
+    inline Variant CreateVariant(IObject * pV)          { DECLARE_VARIANT(var); INITIALIZE_VARIANTC(var, IObject, 0); var.VPIObject = pV; return var; }
+    inline Variant CreateVariant(void * pV)             { DECLARE_VARIANT(var); INITIALIZE_VARIANTC(var, PVoid, 0); var.VPVoid = pV; return var; }
     template<typename T>
     inline Variant CreateVariant(T * pV)                { DECLARE_VARIANT(var); INITIALIZE_VARIANTC(var, PVoid, 0); var.VPVoid = reinterpret_cast<void*>(pV); return var; }
     template<typename T>
@@ -769,6 +898,16 @@ namespace VoodooShader
     /**
      * @}
      */
+    /**
+     * Compares two UUIDs as a pair of 64-bit words.
+     */
+    inline bool IsSameUuid(const Uuid & a, const Uuid & b)
+    {
+        uint64_t wa[2], wb[2];
+        memcpy(wa, &a, sizeof(wa));
+        memcpy(wb, &b, sizeof(wb));
+        return ((wa[0] ^ wb[0]) | (wa[1] ^ wb[1])) == 0;
+    }
     /**
      * @}
      */
@@ -51,9 +51,11 @@ namespace VoodooShader
 
         const Version * VOODOO_CALLTYPE API_PluginInit(_In_ ICore * pCore);
         void            VOODOO_CALLTYPE API_PluginReset(_In_ ICore * pCore);
+        bool            VOODOO_CALLTYPE API_PluginCanUnload();
         const uint32_t  VOODOO_CALLTYPE API_ClassCount();
         const wchar_t * VOODOO_CALLTYPE API_ClassInfo(_In_ const uint32_t index, _Out_ Uuid * pUuid);
         IObject *       VOODOO_CALLTYPE API_ClassCreate(_In_ const uint32_t index, _In_ ICore * pCore);
+        const PluginDesc * VOODOO_CALLTYPE API_PluginDesc();
 
         /**
          * class VSWFileSystem
@@ -38,12 +38,19 @@ namespace VoodooShader
 {
     namespace VoodooWFS
     {
+        #define VOODOO_DEBUG_TYPE VSWFile
+        DeclareDebugCache();
+
         VSWFile::VSWFile(_In_ ICore * pCore, _In_ CONST String & path) :
             m_Path(path), m_Core(pCore)
-        { };
+        {
+            AddThisToDebugCache();
+        };
 
         VSWFile::~VSWFile()
         {
+            RemoveThisFromDebugCache();
+
             this->Close();
         }
 
@@ -54,46 +61,26 @@ namespace VoodooShader
 
         uint32_t VSWFile::Release() const
         {
-            if (SAFE_DECREMENT(m_Refs) == 0)
+            uint32_t count = SAFE_DECREMENT(m_Refs);
+            if (count == 0)
             {
                 delete this;
-                return 0;
-            }
-            else
-            {
-                return m_Refs;
             }
+            return count;
         }
 
         VoodooResult VSWFile::QueryInterface(_In_ CONST Uuid clsid, _Outptr_result_maybenull_ IObject ** ppOut)
         {
-            if (!ppOut)
+            static CONST InterfaceMapEntry map[] =
             {
-                return VSFERR_INVALIDPARAMS;
-            }
-            else
-            {
-                if (clsid == IID_IObject)
-                {
-                    *ppOut = static_cast<IObject*>(this);
-                }
-                else if (clsid == IID_IFile)
-                {
-                    *ppOut = static_cast<IFile*>(this);
-                }
-                else if (clsid == CLSID_VSWFile)
-                {
-                    *ppOut = static_cast<VSWFile*>(this);
-                }
-                else
-                {
-                    *ppOut = nullptr;
-                    return false;
-                }
-
-                (*ppOut)->AddRef();
-                return true;
-            }
+                VOODOO_INTERFACE_ENTRY(VSWFile, IObject),
+                VOODOO_INTERFACE_ENTRY(VSWFile, IFile),
+                VOODOO_CLASS_ENTRY(VSWFile),
+                VOODOO_INTERFACE_MAP_END
+            };
+            static volatile LONG hint = 0;
+
+            return QueryInterfaceMap(this, map, &hint, clsid, ppOut);
         }
 
         String VSWFile::ToString() const
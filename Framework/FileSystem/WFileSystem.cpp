@@ -36,11 +36,21 @@
 
 namespace VoodooShader
 {
+    volatile LONG gModuleObjects = 0;
+
     namespace VoodooWFS
     {
+        #define VOODOO_DEBUG_TYPE VSWFileSystem
+        DeclareDebugCache();
+
         static const Version version = VOODOO_VERSION_STRUCT(FILESYSTEM);
-        static const wchar_t * name_VSWFileSystem = VSTR("VSWFileSystem");
-        static const Uuid clsid_VSWFileSystem = CLSID_VSWFileSystem;
+
+        static const PluginClassDesc moduleClasses[] =
+        {
+            { CLSID_VSWFileSystem, VSTR("VSWFileSystem") },
+        };
+
+        static const uint32_t moduleClassCount = sizeof(moduleClasses) / sizeof(moduleClasses[0]);
 
         CONST Version * VOODOO_CALLTYPE API_PluginInit(_In_ ICore * pCore)
         {
@@ -54,9 +64,14 @@ namespace VoodooShader
             UNREFERENCED_PARAMETER(pCore);
         }
 
+        bool VOODOO_CALLTYPE API_PluginCanUnload()
+        {
+            return (gModuleObjects == 0);
+        }
+
         CONST uint32_t VOODOO_CALLTYPE API_ClassCount()
         {
-            return 1;
+            return moduleClassCount;
         }
 
         CONST wchar_t * VOODOO_CALLTYPE API_ClassInfo(_In_ CONST uint32_t index, _Out_ Uuid * pUuid)
@@ -66,10 +81,10 @@ namespace VoodooShader
                 return nullptr;
             }
 
-            if (index == 0)
+            if (index < moduleClassCount)
             {
-                *pUuid = clsid_VSWFileSystem;
-                return name_VSWFileSystem;
+                *pUuid = moduleClasses[index].ClsId;
+                return moduleClasses[index].Name;
             }
 
 			*pUuid = NilUuid;
@@ -88,10 +103,27 @@ namespace VoodooShader
             }
         }
 
+        CONST PluginDesc * VOODOO_CALLTYPE API_PluginDesc()
+        {
+            static CONST PluginDesc moduleDesc =
+            {
+                VOODOO_PLUGIN_ABI,
+                sizeof(PluginDesc),
+                &API_PluginInit,
+                &API_PluginReset,
+                &API_ClassCreate,
+                nullptr,
+                moduleClassCount,
+                moduleClasses,
+                &API_PluginCanUnload
+            };
+
+            return &moduleDesc;
+        }
+
         VSWFileSystem::VSWFileSystem(_In_ ICore * pCore) :
             m_Core(pCore)
         {
-            using namespace pugi;
             // Create builtin vars
             IParser* parser = m_Core->GetParser();
             wchar_t cvar[MAX_PATH];
@@ -113,24 +145,29 @@ namespace VoodooShader
             ilInit();
 
             // Load paths from the config
-            xml_document *config = (xml_document *) m_Core->GetConfig();
-            xpath_query pathsQuery(L"/VoodooConfig/Classes/Class[@Name = \"VSWFileSystem\"]/SearchPaths/Path");
-            xpath_query pathValueQuery(L"./text()");
-            xpath_node_set pathNodes = pathsQuery.evaluate_node_set(*config);
-            xpath_node_set::const_iterator pathIter = pathNodes.begin();
-
-            while (pathIter != pathNodes.end())
+            CONST ConfigDesc * pConfig = m_Core->GetConfigDesc();
+            ConfigClassMap::const_iterator classIter;
+            if (pConfig && (classIter = pConfig->Classes.find(VSTR("VSWFileSystem"))) != pConfig->Classes.end())
             {
-                String path = pathValueQuery.evaluate_string(*pathIter).c_str();
+                typedef ConfigValues::const_iterator PathIter;
+                std::pair<PathIter, PathIter> paths = classIter->second.equal_range(VSTR("SearchPaths/Path"));
+                PathIter pathIter = paths.first;
 
-                this->AddPath(path);
+                while (pathIter != paths.second)
+                {
+                    this->AddPath(pathIter->second);
 
-                ++pathIter;
+                    ++pathIter;
+                }
             }
+
+            AddThisToDebugCache();
         }
 
         VSWFileSystem::~VSWFileSystem()
         {
+            RemoveThisFromDebugCache();
+
             m_Directories.clear();
         }
 
@@ -141,46 +178,26 @@ namespace VoodooShader
 
         uint32_t VSWFileSystem::Release() CONST
         {
-            if (SAFE_DECREMENT(m_Refs) == 0)
+            uint32_t count = SAFE_DECREMENT(m_Refs);
+            if (count == 0)
             {
                 delete this;
-                return 0;
-            }
-            else
-            {
-                return m_Refs;
             }
+            return count;
         }
 
         VoodooResult VSWFileSystem::QueryInterface(_In_ CONST Uuid clsid, _Outptr_result_maybenull_ IObject ** ppOut)
         {
-            if (!ppOut)
+            static CONST InterfaceMapEntry map[] =
             {
-                return VSFERR_INVALIDPARAMS;
-            }
-            else
-            {
-                if (clsid == IID_IObject)
-                {
-                    *ppOut = static_cast<IObject*>(this);
-                }
-                else if (clsid == IID_IFileSystem)
-                {
-                    *ppOut = static_cast<IFileSystem*>(this);
-                }
-                else if (clsid == CLSID_VSWFileSystem)
-                {
-                    *ppOut = static_cast<VSWFileSystem*>(this);
-                }
-                else
-                {
-                    *ppOut = nullptr;
-                    return VSFERR_INVALIDUUID;
-                }
-
-                (*ppOut)->AddRef();
-                return VSF_OK;
-            }
+                VOODOO_INTERFACE_ENTRY(VSWFileSystem, IObject),
+                VOODOO_INTERFACE_ENTRY(VSWFileSystem, IFileSystem),
+                VOODOO_CLASS_ENTRY(VSWFileSystem),
+                VOODOO_INTERFACE_MAP_END
+            };
+            static volatile LONG hint = 0;
+
+            return QueryInterfaceMap(this, map, &hint, clsid, ppOut);
         }
 
         String VSWFileSystem::ToString() CONST
@@ -29,12 +29,19 @@
 
 namespace VoodooShader
 {
+    volatile LONG gModuleObjects = 0;
+
     #define VOODOO_DEBUG_TYPE VSHookManager
     DeclareDebugCache();
 
     static const Version version = VOODOO_VERSION_STRUCT(HOOKMANAGER);
-    static const wchar_t * name_VSEHHookManager = VSTR("VSEHHookManager");
-    static const Uuid clsid_VSEHHookManager = CLSID_VSHookManager;
+
+    static const PluginClassDesc moduleClasses[] =
+    {
+        { CLSID_VSHookManager, VSTR("VSEHHookManager") },
+    };
+
+    static const uint32_t moduleClassCount = sizeof(moduleClasses) / sizeof(moduleClasses[0]);
 
     CONST Version * VOODOO_CALLTYPE API_PluginInit(_In_ ICore * pCore)
     {
@@ -48,9 +55,14 @@ namespace VoodooShader
         UNREFERENCED_PARAMETER(pCore);
     }
 
+    bool VOODOO_CALLTYPE API_PluginCanUnload()
+    {
+        return (gModuleObjects == 0);
+    }
+
     CONST uint32_t VOODOO_CALLTYPE API_ClassCount()
     {
-        return 1;
+        return moduleClassCount;
     }
 
     CONST wchar_t * VOODOO_CALLTYPE API_ClassInfo(_In_ CONST uint32_t index, _Out_ Uuid * pUuid)
@@ -60,10 +72,10 @@ namespace VoodooShader
             return nullptr;
         }
 
-        if (index == 0)
+        if (index < moduleClassCount)
         {
-            *pUuid = clsid_VSEHHookManager;
-            return name_VSEHHookManager;
+            *pUuid = moduleClasses[index].ClsId;
+            return moduleClasses[index].Name;
         }
 
 		*pUuid = NilUuid;
@@ -82,6 +94,24 @@ namespace VoodooShader
         }
     }
 
+    CONST PluginDesc * VOODOO_CALLTYPE API_PluginDesc()
+    {
+        static CONST PluginDesc moduleDesc =
+        {
+            VOODOO_PLUGIN_ABI,
+            sizeof(PluginDesc),
+            &API_PluginInit,
+            &API_PluginReset,
+            &API_ClassCreate,
+            nullptr,
+            moduleClassCount,
+            moduleClasses,
+            &API_PluginCanUnload
+        };
+
+        return &moduleDesc;
+    }
+
     VSHookManager::VSHookManager(_In_ ICore * pCore) :
         m_Refs(0), m_Core(pCore)
     { 
@@ -120,48 +150,28 @@ namespace VoodooShader
     {
         VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
-        if (SAFE_DECREMENT(m_Refs) == 0)
+        uint32_t count = SAFE_DECREMENT(m_Refs);
+        if (count == 0)
         {
             delete this;
-            return 0;
-        }
-        else
-        {
-            return m_Refs;
         }
+        return count;
     }
 
     VoodooResult VOODOO_METHODTYPE VSHookManager::QueryInterface(_In_ Uuid refid, _Outptr_result_maybenull_ IObject ** ppOut)
     {
         VOODOO_DEBUG_FUNCLOG(m_Core->GetLogger());
 
-        if (!ppOut)
+        static CONST InterfaceMapEntry map[] =
         {
-            return VSFERR_INVALIDPARAMS;
-        }
-        else
-        {
-            if (refid == IID_IObject)
-            {
-                *ppOut = static_cast<IObject*>(this);
-            }
-            else if (refid == IID_IHookManager)
-            {
-                *ppOut = static_cast<IHookManager*>(this);
-            }
-            else if (refid == CLSID_VSHookManager)
-            {
-                *ppOut = static_cast<VSHookManager*>(this);
-            }
-            else
-            {
-                *ppOut = nullptr;
-                return VSFERR_INVALIDUUID;
-            }
-
-            (*ppOut)->AddRef();
-            return VSF_OK;
-        }
+            VOODOO_INTERFACE_ENTRY(VSHookManager, IObject),
+            VOODOO_INTERFACE_ENTRY(VSHookManager, IHookManager),
+            VOODOO_CLASS_ENTRY(VSHookManager),
+            VOODOO_INTERFACE_MAP_END
+        };
+        static volatile LONG hint = 0;
+
+        return QueryInterfaceMap(this, map, &hint, refid, ppOut);
     }
 
     String VOODOO_METHODTYPE VSHookManager::ToString() CONST
@@ -31,9 +31,11 @@ namespace VoodooShader
 {
     CONST Version * VOODOO_CALLTYPE API_PluginInit(_In_ ICore * pCore);
     void            VOODOO_CALLTYPE API_PluginReset(_In_ ICore * pCore);
+    bool            VOODOO_CALLTYPE API_PluginCanUnload();
     CONST uint32_t  VOODOO_CALLTYPE API_ClassCount();
 	CONST wchar_t * VOODOO_CALLTYPE API_ClassInfo(_In_ CONST uint32_t index, _Out_ Uuid * pUuid);
     IObject *       VOODOO_CALLTYPE API_ClassCreate(_In_ CONST uint32_t index, _In_ ICore * pCore);
+    CONST PluginDesc * VOODOO_CALLTYPE API_PluginDesc();
 
     /**
      * Voodoo Shader null hook manager implementation. Returns true or nullptr for methods as necessary, does not install